@@ -15,7 +15,24 @@
 
 #include "OMNI.h"
 #include "omni_job_config.h"
+#include "omni_lambda.h"
+#include "pipeline.h"
+#include "catalog.h"
+#include "codec.h"
+#include "sha256.h"
+#include "merkle.h"
+#include "partition.h"
+#include "stats.h"
+#include "stream.h"
+#ifdef USE_SHM_ARENA
+#include "shm_arena.h"
+#endif
 #include "format/format_factory.h"
+#include "format/csv_format_client.h"
+#ifdef USE_ARROW
+#include "format/arrow_format_client.h"
+#endif
+#include "format/record_splitter.h"
 #include "repo/filesystem_repo_omni.h"
 #include "repo/repo_factory.h"
 #include "format/dataset_config.h"
@@ -34,6 +51,7 @@
 #include <pwd.h>
 #include <unistd.h>
 #include <glob.h>
+#include <dlfcn.h>
 #else
 // Windows-specific includes
 #include <windows.h>
@@ -49,6 +67,11 @@
 #include <thread>
 #include <algorithm>
 #include <mutex>
+#include <map>
+#include <memory>
+#include <iterator>
+#include <chrono>
+#include <iomanip>
 #include <fstream>
 #include <cctype>  // For isspace
 #include <cstdio>  // For std::remove
@@ -161,12 +184,47 @@ namespace fs = std::filesystem;
 
 namespace cae {
 
+#ifdef USE_SHM_ARENA
+// Node-local arena shared by all puts and gets of this process. The object
+// name, region size and index size can be set with OMNI_ARENA,
+// OMNI_ARENA_REGION_MB and OMNI_ARENA_ENTRIES before the arena is created.
+static ShmArena* Arena() {
+  static std::mutex arena_mutex;
+  static std::unique_ptr<ShmArena> arena;
+  static bool opened = false;
+  std::lock_guard<std::mutex> lock(arena_mutex);
+  if (!opened) {
+    opened = true;
+    ShmArena::Options options;
+    if (const char* name = std::getenv("OMNI_ARENA")) {
+      options.name = name;
+    }
+    if (const char* mb = std::getenv("OMNI_ARENA_REGION_MB")) {
+      options.region_size = std::strtoull(mb, nullptr, 10) << 20;
+    }
+    if (const char* entries = std::getenv("OMNI_ARENA_ENTRIES")) {
+      options.index_capacity = std::strtoull(entries, nullptr, 10);
+    }
+    std::string error;
+    arena = ShmArena::Open(options, error);
+    if (!arena) {
+      std::cerr << "Error: shared-memory arena - " << error << std::endl;
+    }
+  }
+  return arena.get();
+}
+#endif
+
 // Public API implementations
 int OMNI::Put(const std::string& input_file) {
+  return Put(std::vector<std::string>{input_file});
+}
+
+int OMNI::Put(const std::vector<std::string>& input_files) {
   if (SetBlackhole() != 0) {
     return 1;
   }
-  return ReadOmni(input_file);
+  return ReadOmni(input_files);
 }
 
 int OMNI::Get(const std::string& buffer) {
@@ -220,35 +278,231 @@ int OMNI::List() {
   return 0;
 }
 
-// Private method implementations
+std::vector<std::string> OMNI::Backends() {
+  std::vector<std::string> backends;
+#ifdef USE_HERMES
+  backends.push_back("hermes");
+#endif
+#ifdef USE_SHM_ARENA
+  backends.push_back("arena");
+#endif
 #ifdef USE_POCO
-std::string OMNI::Sha256File(const std::string& file_path) {
-  try {
-    Poco::FileInputStream fis(file_path);
-    Poco::SHA2Engine sha256(Poco::SHA2Engine::SHA_256);
-    const size_t buffer_size = 8192;
-    char buffer[buffer_size];
+#ifdef USE_MEMCACHED
+  backends.push_back("memcached");
+#endif
+#ifdef USE_REDIS
+  backends.push_back("redis");
+#endif
+  backends.push_back("shm");
+#else
+  backends.push_back("file");
+#endif
+  return backends;
+}
+
+int OMNI::SetBackend(const std::string& backend) {
+  std::vector<std::string> backends = Backends();
+  if (!backend.empty() &&
+      std::find(backends.begin(), backends.end(), backend) == backends.end()) {
+    std::cerr << "Error: backend '" << backend
+              << "' is not available in this build" << std::endl;
+    return 1;
+  }
+  backend_ = backend;
+  return 0;
+}
+
+int OMNI::SetPartition(int rank, int nranks) {
+#ifndef USE_MPI
+  if (nranks > 1) {
+    std::cerr << "Error: partitioned put requires MPI support" << std::endl;
+    return 1;
+  }
+#endif
+  if (nranks < 1 || rank < 0 || rank >= nranks) {
+    std::cerr << "Error: invalid partition - rank " << rank << " of "
+              << nranks << std::endl;
+    return 1;
+  }
+  rank_ = rank;
+  nranks_ = nranks;
+  return 0;
+}
+
+int OMNI::GetData(const std::string& name, std::vector<unsigned char>& data) {
+  BufferMeta meta;
+  int rc = ReadBufferMeta(name, meta);
+  if (rc == 1) {
+    std::cerr << "Error: buffer '" << name << "' is not in the catalog"
+              << std::endl;
+    return -1;
+  }
+  if (rc != 0) {
+    return -1;
+  }
+
+  std::vector<unsigned char> stored;
+  if (ReadStored(meta, stored) != 0) {
+    return -1;
+  }
+  if (meta.frames.codec == Codec::kNone) {
+    data.swap(stored);
+    return 0;
+  }
+  data.resize(meta.size);
+  if (DecompressFrames(meta.frames, stored.data(), stored.size(), data.data(),
+                       0) != 0) {
+    std::cerr << "Error: decompressing buffer '" << name << "' failed"
+              << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+int OMNI::StreamData(const std::string& name, const std::string& out_path,
+                     uint64_t offset, uint64_t nbyte) {
+  BufferMeta meta;
+  int rc = ReadBufferMeta(name, meta);
+  if (rc == 1) {
+    std::cerr << "Error: buffer '" << name << "' is not in the catalog"
+              << std::endl;
+    return 1;
+  }
+  if (rc != 0) {
+    return 1;
+  }
+  if (offset > meta.size) {
+    std::cerr << "Error: offset " << offset << " is past the end of '" << name
+              << "' (" << meta.size << " bytes)" << std::endl;
+    return 1;
+  }
+  nbyte = std::min<uint64_t>(nbyte, meta.size - offset);
+  StatSpan span("get");
+  span.SetBackend(meta.backend);
+  span.AddBytes(nbyte);
 
-    while (!fis.eof()) {
-      fis.read(buffer, buffer_size);
-      std::streamsize bytes_read = fis.gcount();
-      if (bytes_read > 0) {
-        sha256.update(buffer, static_cast<unsigned>(bytes_read));
+  bool to_stdout = out_path == "-";
+#ifdef _WIN32
+  // The bytes go out untranslated, to a file or to stdout
+  const int binary = O_BINARY;
+  if (to_stdout) {
+    std::cout.flush();
+    _setmode(1, _O_BINARY);
+  }
+#else
+  const int binary = 0;
+#endif
+  int out_fd = to_stdout ? 1
+                         : open(out_path.c_str(),
+                                O_WRONLY | O_CREAT | O_TRUNC | binary, 0644);
+  if (out_fd < 0) {
+    std::cerr << "Error: cannot open '" << out_path
+              << "': " << strerror(errno) << std::endl;
+    return 1;
+  }
+  if (to_stdout) {
+    std::cout.flush();
+  }
+
+  std::string method;
+  rc = 0;
+#ifdef USE_SHM_ARENA
+  ShmArena* arena = meta.backend == "arena" ? Arena() : nullptr;
+  const unsigned char* mapped = nullptr;
+  size_t mapped_nbyte = 0;
+  if (arena != nullptr && meta.frames.codec == Codec::kNone &&
+      arena->Find(name, mapped, mapped_nbyte)) {
+    // Already mapped: write straight out of the arena
+    method = "arena";
+    if (WriteFully(out_fd, mapped + offset,
+                   std::min<uint64_t>(nbyte, mapped_nbyte - offset)) != 0) {
+      std::cerr << "Error: writing '" << out_path
+                << "' failed: " << strerror(errno) << std::endl;
+      rc = 1;
+    }
+  } else
+#endif
+  if ((meta.backend == "file" || meta.backend == "shm") &&
+      meta.frames.codec == Codec::kNone) {
+    // Raw bytes on disk: let the kernel move them
+    int in_fd = open(name.c_str(), O_RDONLY | binary);
+    if (in_fd < 0) {
+      std::cerr << "Error: cannot open buffer '" << name
+                << "': " << strerror(errno) << std::endl;
+      rc = 1;
+    } else {
+      if (CopyFileRange(in_fd, offset, nbyte, out_fd, method) != 0) {
+        std::cerr << "Error: streaming '" << name
+                  << "' failed: " << strerror(errno) << std::endl;
+        rc = 1;
       }
+      close(in_fd);
+    }
+  } else {
+    std::vector<unsigned char> stored;
+    std::vector<unsigned char> range;
+    if (ReadStored(meta, stored) != 0) {
+      rc = 1;
+    } else if (meta.frames.codec == Codec::kNone) {
+      method = "copy";
+      range.assign(stored.begin() + offset,
+                   stored.begin() + offset + nbyte);
+    } else if (DecompressRange(meta.frames, stored.data(), stored.size(),
+                               offset, nbyte, range) != 0) {
+      // Only the frames overlapping the range are decoded
+      std::cerr << "Error: decompressing buffer '" << name << "' failed"
+                << std::endl;
+      rc = 1;
+    } else {
+      method = CodecName(meta.frames.codec);
+    }
+    if (rc == 0 && WriteFully(out_fd, range.data(), range.size()) != 0) {
+      std::cerr << "Error: writing '" << out_path
+                << "' failed: " << strerror(errno) << std::endl;
+      rc = 1;
     }
+  }
 
-    const Poco::DigestEngine::Digest& digest = sha256.digest();
-    std::stringstream ss;
-    for (unsigned char b : digest) {
-      ss << std::hex << std::setfill('0') << std::setw(2)
-         << static_cast<int>(b);
+  if (!to_stdout) {
+    close(out_fd);
+    if (rc == 0 && !quiet_) {
+      std::cout << "streamed " << nbyte << " bytes of '" << name << "' to "
+                << out_path << " (" << method << ")" << std::endl;
     }
-    return ss.str();
-  } catch (const Poco::Exception& ex) {
-    throw std::runtime_error("Error: calculating SHA256 - " + ex.displayText());
   }
+  return rc;
+}
+
+// Private method implementations
+std::string OMNI::Sha256File(const std::string& file_path) {
+  StatSpan span("hash");
+  std::error_code ec;
+  uintmax_t size = fs::file_size(file_path, ec);
+  span.AddBytes(ec ? 0 : size);
+  return Sha256HexFile(file_path);
+}
+
+std::string OMNI::MerkleHash(const std::string& file_path) {
+  StatSpan span("hash");
+  span.SetBackend("merkle");
+  std::error_code ec;
+  uintmax_t size = fs::file_size(file_path, ec);
+  if (ec) {
+    throw std::runtime_error("Error: calculating Merkle root - cannot open " +
+                             file_path);
+  }
+  span.AddBytes(size);
+  return MerkleRootFile(file_path, 0, size);
+}
+
+int OMNI::ListBuffer(const std::string& name, const std::string& tags,
+                     const BufferMeta* meta) {
+  // A stripe is listed once, as its striped buffer, by rank 0
+  if (meta != nullptr && !meta->stripe_of.empty()) {
+    return 0;
+  }
+  return WriteMeta(name, tags);
 }
-#endif
 
 int OMNI::WriteMeta(const std::string& name, const std::string& tags) {
   std::string file_path = ".blackhole/ls";
@@ -1447,20 +1701,181 @@ public:
 };
 #endif
 
+int OMNI::ReadStored(const BufferMeta& meta,
+                     std::vector<unsigned char>& stored) {
+  const std::string& name = meta.name;
+  if (meta.backend == "striped") {
+    // Stripes are stored (and compressed) independently; join them in order
+    stored.clear();
+    stored.reserve(meta.size);
+    for (uint32_t i = 0; i < meta.stripes; ++i) {
+      std::vector<unsigned char> stripe;
+      if (GetData(StripeName(name, static_cast<int>(i)), stripe) != 0) {
+        return -1;
+      }
+      stored.insert(stored.end(), stripe.begin(), stripe.end());
+    }
+    return 0;
+  }
+#ifdef USE_SHM_ARENA
+  if (meta.backend == "arena") {
+    ShmArena* arena = Arena();
+    const unsigned char* data = nullptr;
+    size_t nbyte = 0;
+    if (arena == nullptr || !arena->Find(name, data, nbyte)) {
+      std::cerr << "Error: buffer '" << name << "' is not in the arena"
+                << std::endl;
+      return -1;
+    }
+    stored.assign(data, data + nbyte);
+    return 0;
+  }
+#endif
+  if (meta.backend == "file" || meta.backend == "shm") {
+    // The shared-memory backend is also backed by a file of the same name
+    stored.resize(meta.stored_size);
+    if (meta.stored_size > 0 &&
+        ReadExactBytesFromOffset(name.c_str(), 0, meta.stored_size,
+                                 stored.data()) != 0) {
+      return -1;
+    }
+    return 0;
+  }
+#ifdef USE_MEMCACHED
+  if (meta.backend == "memcached") {
+    MemcachedClient memcached_client("localhost", 11211);
+    std::string value;
+    if (!memcached_client.connect() || !memcached_client.get(name, value)) {
+      std::cerr << "Error: could not read '" << name << "' from Memcached"
+                << std::endl;
+      return -1;
+    }
+    stored.assign(value.begin(), value.end());
+    return 0;
+  }
+#endif
+#ifdef USE_REDIS
+  if (meta.backend == "redis") {
+    try {
+      Poco::Redis::Client redis_client("localhost", 6379);
+      Poco::Redis::Command get_cmd("GET");
+      get_cmd << name;
+      Poco::Redis::BulkString result =
+          redis_client.execute<Poco::Redis::BulkString>(get_cmd);
+      if (result.isNull()) {
+        std::cerr << "Error: Redis key '" << name << "' not found"
+                  << std::endl;
+        return -1;
+      }
+      const std::string& value = result.value();
+      stored.assign(value.begin(), value.end());
+      return 0;
+    } catch (const Poco::Exception& e) {
+      std::cerr << "Error: Redis - " << e.displayText() << std::endl;
+      return -1;
+    }
+  }
+#endif
+  std::cerr << "Error: cannot read buffer '" << name << "' from backend '"
+            << meta.backend << "'" << std::endl;
+  return -1;
+}
+
+int OMNI::CommitPut(const std::string& name, const std::string& tags,
+                    const std::string& backend, const unsigned char* buffer,
+                    size_t nbyte, BufferMeta* meta) {
+  if (meta != nullptr) {
+    meta->name = name;
+    meta->tags = tags;
+    meta->backend = backend;
+    meta->stored_size = nbyte;
+    // Digest the buffer file once now so 'get' never has to re-read it
+    StatSpan span("hash");
+    if (backend == "arena") {
+      // No file to stat; arena contents only change through put
+      span.AddBytes(nbyte);
+      Sha256 sha;
+      sha.Update(buffer, nbyte);
+      sha.Update("", 1);
+      meta->digest = Sha256::ToHex(sha.Final());
+    } else if (StatBufferFile(name, meta->file_size, meta->mtime)) {
+      if ((backend == "file" || backend == "shm") &&
+          meta->file_size == nbyte + 1) {
+        // The file holds exactly the stored bytes plus a NUL
+        span.AddBytes(nbyte);
+        Sha256 sha;
+        sha.Update(buffer, nbyte);
+        sha.Update("", 1);
+        meta->digest = Sha256::ToHex(sha.Final());
+      } else {
+        meta->digest = Sha256File(name);
+      }
+    }
+    if (WriteBufferMeta(*meta) != 0) {
+      return -1;
+    }
+  }
+  return ListBuffer(name, tags, meta);
+}
+
 int OMNI::PutData(const std::string& name, const std::string& tags,
                   const std::string& path, unsigned char* buffer,
-                  size_t nbyte) {
+                  size_t nbyte, BufferMeta* meta) {
 #ifdef USE_HERMES
   // Try to use Hermes if available, but don't fail if it's not running
-  try {
-    if (chi::chiClient != nullptr) {
-      PutHermes(name, tags, path, buffer, nbyte);
+  if (UseBackend("hermes")) {
+    try {
+      if (chi::chiClient != nullptr) {
+        PutHermes(name, tags, path, buffer, nbyte);
+        if (backend_ == "hermes") {
+          return CommitPut(name, tags, "hermes", buffer, nbyte, meta);
+        }
+      }
+    } catch (...) {
+      // Hermes not available, fall through to other storage backends
+      if (!quiet_) {
+        std::cout << "Hermes not available, using alternative storage" << std::endl;
+      }
     }
-  } catch (...) {
-    // Hermes not available, fall through to other storage backends
-    if (!quiet_) {
-      std::cout << "Hermes not available, using alternative storage" << std::endl;
+    if (backend_ == "hermes") {
+      std::cerr << "Error: Hermes did not store '" << name << "'" << std::endl;
+      return -1;
+    }
+  }
+#endif
+#ifdef USE_SHM_ARENA
+  // Buffers that fit in an arena region skip the per-buffer file and mmap
+  ShmArena* arena = UseBackend("arena") ? Arena() : nullptr;
+  if (arena != nullptr) {
+    const unsigned char* existing = nullptr;
+    size_t existing_nbyte = 0;
+    if (arena->Find(name, existing, existing_nbyte)) {
+      if (!quiet_) {
+        std::cout << "checking existing buffer '" << name << "'...yes"
+                  << std::endl;
+      }
+      // The arena outlives this directory's catalog; record the buffer
+      // here if the catalog does not already have it
+      BufferMeta recorded;
+      if (meta != nullptr && ReadBufferMeta(name, recorded) != 0) {
+        return CommitPut(name, tags, "arena", existing, existing_nbyte, meta);
+      }
+      return ListBuffer(name, tags, meta);
+    }
+    if (arena->Put(name, buffer, nbyte) == 0) {
+      if (!quiet_) {
+        std::cout << "checking existing buffer '" << name << "'...no"
+                  << std::endl;
+        std::cout << "putting " << nbyte << " bytes into '" << name
+                  << "' buffer...done (arena)" << std::endl;
+      }
+      return CommitPut(name, tags, "arena", buffer, nbyte, meta);
     }
+    // Too large or arena full: fall through to the per-buffer backends
+  }
+  if (backend_ == "arena") {
+    std::cerr << "Error: arena did not store '" << name << "'" << std::endl;
+    return -1;
   }
 #endif
 #ifdef USE_POCO
@@ -1476,7 +1891,7 @@ int OMNI::PutData(const std::string& name, const std::string& tags,
         std::cout << "yes" << std::endl;
       }
       // Still write metadata even if buffer exists
-      return WriteMeta(name, tags);
+      return ListBuffer(name, tags, meta);
     }
     if (!quiet_) {
       std::cout << "no" << std::endl;
@@ -1501,70 +1916,88 @@ int OMNI::PutData(const std::string& name, const std::string& tags,
     }
 
 #ifdef USE_MEMCACHED
-    // Try Memcached first if available
-    try {
-      MemcachedClient memcached_client("localhost", 11211);
-      if (memcached_client.connect()) {
-        std::string data_str((const char*)buffer, nbyte);
-        if (memcached_client.set(name, data_str)) {
-          if (!quiet_) {
-            std::cout << "done (Memcached)" << std::endl;
-          }
+    if (UseBackend("memcached")) {
+      // Try Memcached first if available
+      try {
+        MemcachedClient memcached_client("localhost", 11211);
+        if (memcached_client.connect()) {
+          std::string data_str((const char*)buffer, nbyte);
+          if (memcached_client.set(name, data_str)) {
+            if (!quiet_) {
+              std::cout << "done (Memcached)" << std::endl;
+            }
 #ifndef NDEBUG
-          if (!quiet_) {
-            std::cout << "wrote data to Memcached key '" << name << "'" << std::endl;
-          }
+            if (!quiet_) {
+              std::cout << "wrote data to Memcached key '" << name << "'" << std::endl;
+            }
 #endif
-          return WriteMeta(name, tags);
+            return CommitPut(name, tags, "memcached", buffer, nbyte, meta);
+          } else {
+            throw std::runtime_error("Memcached SET command failed");
+          }
         } else {
-          throw std::runtime_error("Memcached SET command failed");
+          throw std::runtime_error("Failed to connect to Memcached server");
         }
-      } else {
-        throw std::runtime_error("Failed to connect to Memcached server");
-      }
-    } catch (const std::exception& e) {
-      if (!quiet_) {
-        std::cout << "Memcached error: " << e.what() << ", falling back to other storage..." << std::endl;
+      } catch (const std::exception& e) {
+        if (!quiet_) {
+          std::cout << "Memcached error: " << e.what() << ", falling back to other storage..." << std::endl;
+        }
+        if (!backend_.empty()) {
+          return -1;
+        }
+        // Fall through to other storage backends
       }
-      // Fall through to other storage backends
     }
 #endif
 
 #ifdef USE_REDIS
-    // Try Redis if available
-    try {
-      Poco::Redis::Client redis_client("localhost", 6379);
-      Poco::Redis::Command set_cmd("SET");
-      set_cmd << name << std::string((const char*)buffer, nbyte);
+    if (UseBackend("redis")) {
+      // Try Redis if available
+      try {
+        Poco::Redis::Client redis_client("localhost", 6379);
+        Poco::Redis::Command set_cmd("SET");
+        set_cmd << name << std::string((const char*)buffer, nbyte);
       
-      std::string result = redis_client.execute<std::string>(set_cmd);
-      if (result == "OK") {
+        std::string result = redis_client.execute<std::string>(set_cmd);
+        if (result == "OK") {
+          if (!quiet_) {
+            std::cout << "done (Redis)" << std::endl;
+          }
+#ifndef NDEBUG
+          if (!quiet_) {
+            std::cout << "wrote data to Redis key '" << name << "'" << std::endl;
+          }
+#endif
+          return CommitPut(name, tags, "redis", buffer, nbyte, meta);
+        } else {
+          throw Poco::Exception("Redis SET command failed");
+        }
+      } catch (const Poco::Exception& e) {
         if (!quiet_) {
-          std::cout << "done (Redis)" << std::endl;
+          std::cout << "Redis error: " << e.displayText() << ", falling back to SharedMemory..." << std::endl;
         }
-#ifndef NDEBUG
+        if (!backend_.empty()) {
+          return -1;
+        }
+        // Fall through to SharedMemory
+      } catch (const std::exception& e) {
         if (!quiet_) {
-          std::cout << "wrote data to Redis key '" << name << "'" << std::endl;
+          std::cout << "Redis error: " << e.what() << ", falling back to SharedMemory..." << std::endl;
         }
-#endif
-        return WriteMeta(name, tags);
-      } else {
-        throw Poco::Exception("Redis SET command failed");
-      }
-    } catch (const Poco::Exception& e) {
-      if (!quiet_) {
-        std::cout << "Redis error: " << e.displayText() << ", falling back to SharedMemory..." << std::endl;
-      }
-      // Fall through to SharedMemory
-    } catch (const std::exception& e) {
-      if (!quiet_) {
-        std::cout << "Redis error: " << e.what() << ", falling back to SharedMemory..." << std::endl;
+        if (!backend_.empty()) {
+          return -1;
+        }
+        // Fall through to SharedMemory
       }
-      // Fall through to SharedMemory
     }
 #endif
 
     // Fallback to SharedMemory (original implementation)
+    if (!UseBackend("shm")) {
+      std::cerr << "Error: backend '" << backend_ << "' did not store '"
+                << name << "'" << std::endl;
+      return -1;
+    }
     Poco::SharedMemory shm(file, Poco::SharedMemory::AM_WRITE);
 
     char* data = static_cast<char*>(shm.begin());
@@ -1586,8 +2019,43 @@ int OMNI::PutData(const std::string& name, const std::string& tags,
     std::cerr << "Standard Exception: " << e.what() << std::endl;
     return -1;
   }
+  return CommitPut(name, tags, "shm", buffer, nbyte, meta);
+#else
+  // Without POCO the buffer is a plain file named after it, laid out like
+  // the shared-memory file (data followed by a NUL byte).
+  if (!UseBackend("file")) {
+    std::cerr << "Error: backend '" << backend_ << "' did not store '"
+              << name << "'" << std::endl;
+    return -1;
+  }
+  if (!quiet_) {
+    std::cout << "checking existing buffer '" << name << "'...";
+  }
+  if (fs::exists(name)) {
+    if (!quiet_) {
+      std::cout << "yes" << std::endl;
+    }
+    return ListBuffer(name, tags, meta);
+  }
+  if (!quiet_) {
+    std::cout << "no" << std::endl;
+    std::cout << "putting " << nbyte << " bytes into '" << name
+              << "' buffer...";
+  }
+  std::ofstream ofs(name, std::ios::binary | std::ios::trunc);
+  ofs.write(reinterpret_cast<const char*>(buffer),
+            static_cast<std::streamsize>(nbyte));
+  ofs.put('\0');
+  ofs.close();
+  if (!ofs) {
+    std::cerr << "Error: could not write buffer '" << name << "'" << std::endl;
+    return -1;
+  }
+  if (!quiet_) {
+    std::cout << "done (file)" << std::endl;
+  }
+  return CommitPut(name, tags, "file", buffer, nbyte, meta);
 #endif
-  return WriteMeta(name, tags);
 }
 
 #ifdef _WIN32
@@ -1670,43 +2138,174 @@ int OMNI::RunLambda(const std::string& lambda, const std::string& name,
   return 0;
 }
 
-std::string OMNI::GetFileName(const std::string& uri) {
-  size_t last_slash_pos = uri.find_last_of('/');
-  if (last_slash_pos == std::string::npos) {
-    size_t protocol_end = uri.find("://");
-    if (protocol_end != std::string::npos) {
-      return "";
-    }
-    std::string filename = uri;
-    size_t query_pos = filename.find('?');
-    if (query_pos != std::string::npos) {
-      filename = filename.substr(0, query_pos);
-    }
-    size_t fragment_pos = filename.find('#');
-    if (fragment_pos != std::string::npos) {
-      filename = filename.substr(0, fragment_pos);
-    }
-    return filename;
+// Loaded lambda entry points, keyed by "library:symbol". Libraries stay
+// loaded for the life of the process so repeated puts skip dlopen.
+static std::mutex lambda_mutex;
+static std::map<std::string, omni_lambda_fn> lambda_cache;
+
+static omni_lambda_fn LoadLambda(const std::string& library,
+                                 const std::string& symbol) {
+  std::lock_guard<std::mutex> lock(lambda_mutex);
+  const std::string key = library + ":" + symbol;
+  auto it = lambda_cache.find(key);
+  if (it != lambda_cache.end()) {
+    return it->second;
   }
 
-  std::string filename_with_params = uri.substr(last_slash_pos + 1);
-  size_t query_pos = filename_with_params.find('?');
-  if (query_pos != std::string::npos) {
-    filename_with_params = filename_with_params.substr(0, query_pos);
+#ifdef _WIN32
+  HMODULE handle = LoadLibraryA(library.c_str());
+  if (handle == NULL) {
+    std::cerr << "Error: could not load lambda library '" << library << "'"
+              << std::endl;
+    return nullptr;
   }
-  size_t fragment_pos = filename_with_params.find('#');
-  if (fragment_pos != std::string::npos) {
-    filename_with_params = filename_with_params.substr(0, fragment_pos);
+  omni_lambda_fn fn = reinterpret_cast<omni_lambda_fn>(
+      GetProcAddress(handle, symbol.c_str()));
+#else
+  void* handle = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (handle == nullptr) {
+    std::cerr << "Error: could not load lambda library - " << dlerror()
+              << std::endl;
+    return nullptr;
   }
-  return filename_with_params;
+  omni_lambda_fn fn =
+      reinterpret_cast<omni_lambda_fn>(dlsym(handle, symbol.c_str()));
+#endif
+  if (fn == nullptr) {
+    std::cerr << "Error: symbol '" << symbol << "' not found in '" << library
+              << "'" << std::endl;
+    return nullptr;
+  }
+  lambda_cache[key] = fn;
+  return fn;
 }
 
-#ifdef USE_AWS
-int OMNI::WriteS3(const std::string& dest, char* ptr) {
-  // Note: AWS SDK InitAPI/ShutdownAPI are now managed globally in wrp.cc main()
-  // to avoid multiple init/shutdown cycles that can cause segfaults
-
-  const Aws::String prefix = "s3://";
+static int AppendLambdaOutput(void* ctx, const void* data, size_t nbyte) {
+  if (ctx == nullptr || (data == nullptr && nbyte > 0)) {
+    return -1;
+  }
+  static_cast<std::string*>(ctx)->append(static_cast<const char*>(data),
+                                         nbyte);
+  return 0;
+}
+
+bool OMNI::IsPluginLambda(const std::string& lambda) {
+  size_t colon = lambda.rfind(':');
+  if (colon == std::string::npos || colon == 0 ||
+      colon + 1 == lambda.size()) {
+    return false;
+  }
+  // Reject 'C:\lambda.bat' style paths: a symbol never contains separators.
+  std::string symbol = lambda.substr(colon + 1);
+  if (symbol.find_first_of("/\\") != std::string::npos) {
+    return false;
+  }
+  std::string library = lambda.substr(0, colon);
+  std::string ext = fs::path(library).extension().string();
+  return ext == ".so" || ext == ".dylib" || ext == ".dll" ||
+         library.find(".so.") != std::string::npos;
+}
+
+int OMNI::RunPlugin(const std::string& lambda, const std::string& name,
+                    const std::string& tags, const unsigned char* buffer,
+                    size_t nbyte, const std::string& dest,
+                    std::string& output) {
+  size_t colon = lambda.rfind(':');
+  std::string library = lambda.substr(0, colon);
+  std::string symbol = lambda.substr(colon + 1);
+
+  omni_lambda_fn fn = LoadLambda(library, symbol);
+  if (fn == nullptr) {
+    return -1;
+  }
+
+  output.clear();
+  omni_lambda_input in = {OMNI_LAMBDA_ABI_VERSION, name.c_str(), tags.c_str(),
+                          dest.c_str(), buffer, nbyte};
+  omni_lambda_output out = {&output, AppendLambdaOutput};
+  int rc = fn(&in, &out);
+  if (rc != 0) {
+    std::cerr << "Error: lambda '" << symbol << "' returned " << rc
+              << std::endl;
+    return rc;
+  }
+  if (!quiet_) {
+    std::cout << "lambda '" << symbol << "' produced " << output.size()
+              << " bytes from " << nbyte << " input bytes" << std::endl;
+  }
+  return 0;
+}
+
+int OMNI::WriteLambdaOutput(const std::string& dest,
+                            const std::string& output) {
+  std::string target = dest;
+  if (dest.find("s3://") == 0) {
+#if defined(USE_AWS) || defined(USE_POCO)
+    return WriteS3(dest, output.c_str(), output.size());
+#else
+    // No S3 client in this build; leave the object where a script lambda
+    // would have written it.
+    target = GetFileName(dest);
+#endif
+  } else if (dest.find("file://") == 0) {
+    target = dest.substr(7);
+  }
+
+  std::ofstream ofs(target, std::ios::binary | std::ios::trunc);
+  if (!ofs.is_open()) {
+    std::cerr << "Error: could not open '" << target << "' for writing"
+              << std::endl;
+    return -1;
+  }
+  ofs.write(output.data(), static_cast<std::streamsize>(output.size()));
+  if (!ofs) {
+    std::cerr << "Error: could not write '" << target << "'" << std::endl;
+    return -1;
+  }
+  if (!quiet_) {
+    std::cout << "wrote " << output.size() << " bytes to '" << target << "'"
+              << std::endl;
+  }
+  return 0;
+}
+
+std::string OMNI::GetFileName(const std::string& uri) {
+  size_t last_slash_pos = uri.find_last_of('/');
+  if (last_slash_pos == std::string::npos) {
+    size_t protocol_end = uri.find("://");
+    if (protocol_end != std::string::npos) {
+      return "";
+    }
+    std::string filename = uri;
+    size_t query_pos = filename.find('?');
+    if (query_pos != std::string::npos) {
+      filename = filename.substr(0, query_pos);
+    }
+    size_t fragment_pos = filename.find('#');
+    if (fragment_pos != std::string::npos) {
+      filename = filename.substr(0, fragment_pos);
+    }
+    return filename;
+  }
+
+  std::string filename_with_params = uri.substr(last_slash_pos + 1);
+  size_t query_pos = filename_with_params.find('?');
+  if (query_pos != std::string::npos) {
+    filename_with_params = filename_with_params.substr(0, query_pos);
+  }
+  size_t fragment_pos = filename_with_params.find('#');
+  if (fragment_pos != std::string::npos) {
+    filename_with_params = filename_with_params.substr(0, fragment_pos);
+  }
+  return filename_with_params;
+}
+
+#ifdef USE_AWS
+int OMNI::WriteS3(const std::string& dest, const char* ptr, size_t nbyte) {
+  // Note: AWS SDK InitAPI/ShutdownAPI are now managed globally in wrp.cc main()
+  // to avoid multiple init/shutdown cycles that can cause segfaults
+
+  const Aws::String prefix = "s3://";
   if (dest.find(prefix) != 0) {
     std::cerr << "Error: not a valid S3 URL (missing 's3://' prefix)"
               << std::endl;
@@ -1882,7 +2481,7 @@ int OMNI::WriteS3(const std::string& dest, char* ptr) {
     input_data->write(reinterpret_cast<const char*>(buffer->data()), content_length);
     input_data->seekg(0);
   } else {
-    content_length = std::strlen(ptr);
+    content_length = nbyte > 0 ? nbyte : std::strlen(ptr);
     input_data = Aws::MakeShared<Aws::StringStream>("PutObjectInputStream");
     input_data->write(ptr, content_length);
     input_data->seekg(0);
@@ -1921,7 +2520,7 @@ int OMNI::WriteS3(const std::string& dest, char* ptr) {
 #elif defined(USE_POCO)
 // POCO-based S3 upload with manual AWS SigV4 signing
 // This is used when AWS SDK is not available (e.g., on Linux to avoid chunked encoding issues)
-int OMNI::WriteS3(const std::string& dest, char* ptr) {
+int OMNI::WriteS3(const std::string& dest, const char* ptr, size_t nbyte) {
   const std::string prefix = "s3://";
   if (dest.find(prefix) != 0) {
     std::cerr << "Error: not a valid S3 URL (missing 's3://' prefix)" << std::endl;
@@ -2003,7 +2602,7 @@ int OMNI::WriteS3(const std::string& dest, char* ptr) {
     file.close();
     content_length = content.length();
   } else {
-    content = std::string(ptr);
+    content = nbyte > 0 ? std::string(ptr, nbyte) : std::string(ptr);
     content_length = content.length();
   }
 
@@ -2464,23 +3063,59 @@ int OMNI::Download(const std::string& url, const std::string& output_file_name,
 }
 #endif
 
-int OMNI::ReadOmni(const std::string& input_file) {
-  std::string name;
-  std::string tags;
-  std::string path;
-#ifdef USE_POCO
-  std::string hash;
+// State carried by one descriptor through the put pipeline.
+struct OmniJob {
+  OmniPlan plan;
+  WaitConfig wait_config;
+  int status = 0;     // first non-zero stage result
+  bool done = false;  // nothing left to do (e.g. Globus transfer started)
+  // Ingested bytes stay alive until the lambda stage has consumed them.
+  bool ingested = false;
+  std::vector<char> data;
+  std::unique_ptr<unsigned char[]> h5_data;
+  unsigned char* input = nullptr;
+  size_t input_nbyte = 0;
+  std::string put_name;  // buffer name (the dataset name for HDF5 sources)
+  std::string put_path;
+  std::vector<unsigned char> stored;  // compressed frames, if any
+  std::vector<unsigned char> columnar;  // decoded columns ('format')
+  BufferMeta meta;
+  bool stripe = false;  // this rank reads and stores one slice of the range
+  // Merkle leaves of the stripe, hashed from the bytes read while later
+  // stages run
+  std::future<std::vector<Sha256::Digest>> leaves;
+  int lambda_result = 0;
+  std::string lambda_output;  // output of a plugin lambda
+  std::future<std::string> digest;  // source hash computed while later stages run
+};
+
+// A source that is read from the local filesystem.
+static bool IsLocalSource(const std::string& path) {
+  return !path.empty() && path.find("https://") == path.npos &&
+         path.find("hdf5://") == path.npos
+#ifdef USE_GLOBUS
+         && path.find("globus://") == path.npos
 #endif
-  size_t offset = 0;
-  size_t nbyte = 0;
-  bool run = false;
-  bool f = true;
-  int res = -1;
-  std::string lambda;
-  std::string dest;
+      ;
+}
 
-  // Read wait timeout configuration
-  WaitConfig wait_config = ReadWaitConfig();
+// Slice of a striped put read by one rank. It holds whole Merkle leaves of
+// the range, so each rank hashes its leaves from the bytes it read.
+static Slice StripeSlice(const OmniPlan& plan, int rank, int nranks) {
+  Slice slice = PartitionAligned(0, plan.nbyte, kMerkleLeafSize, rank, nranks);
+  slice.offset += plan.offset;
+  return slice;
+}
+
+// Formats read whole files through Apache Arrow rather than a byte range.
+static bool IsArrowFormat(const std::string& format) {
+  return format == "parquet" || format == "feather";
+}
+
+int OMNI::CompilePlan(const std::string& input_file, OmniPlan& plan) {
+  StatSpan span("parse");
+  plan = OmniPlan();
+  plan.input_file = input_file;
 
   std::ifstream ifs(input_file);
   if (!ifs.is_open()) {
@@ -2496,192 +3131,31 @@ int OMNI::ReadOmni(const std::string& input_file) {
         std::string key = it->first.as<std::string>();
 
         if (key == "name") {
-          name = it->second.as<std::string>();
-        }
-        if (key == "src") {
+          plan.name = it->second.as<std::string>();
+        } else if (key == "src") {
           std::string original_path = it->second.as<std::string>();
-          bool wait_for_file = false;
-
-          // Check if src starts with '>' indicating we should wait for the file
+          // A leading '>' means wait for the file to appear
           if (!original_path.empty() && original_path[0] == '>') {
-            wait_for_file = true;
-            path = original_path.substr(1);  // Remove the '>' prefix
-            if (!quiet_) {
-              std::cout << "Will wait for file: " << path.c_str() << std::endl;
-            }
+            plan.wait_for_file = true;
+            plan.path = original_path.substr(1);
           } else {
-            path = original_path;
-          }
-
-#ifndef NDEBUG
-          if (!quiet_) {
-            std::cout << "Path=" << path.c_str() << std::endl;
-          }
-#endif
-          if (path.find("https://") == path.npos &&
-              path.find("hdf5://") == path.npos
-#ifdef USE_GLOBUS
-              && path.find("globus://") == path.npos
-#endif
-          ) {
-#ifdef USE_POCO
-            Poco::File file(path);
-            if (wait_for_file) {
-              // Wait for the file to become available with timeout
-              if (!quiet_) {
-                std::cout << "Waiting for file '" << path
-                          << "' to become available";
-                if (wait_config.timeout_seconds > 0) {
-                  std::cout << " (timeout: " << wait_config.timeout_seconds << " seconds)";
-                }
-                std::cout << "..." << std::endl;
-              }
-
-              auto start_time = std::chrono::steady_clock::now();
-              while (!file.exists()) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                file = Poco::File(path);  // Refresh the file object
-
-                // Check timeout if configured
-                if (wait_config.timeout_seconds > 0) {
-                  auto elapsed = std::chrono::steady_clock::now() - start_time;
-                  auto elapsed_seconds = std::chrono::duration_cast<std::chrono::seconds>(elapsed).count();
-                  if (elapsed_seconds >= wait_config.timeout_seconds) {
-                    std::cerr << "Error: Timeout waiting for file '" << path
-                              << "' after " << elapsed_seconds << " seconds" << std::endl;
-                    return -1;
-                  }
-                }
-              }
-              if (!quiet_) {
-                std::cout << "File '" << path
-                          << "' is now available, continuing..." << std::endl;
-              }
-            } else if (!file.exists()) {
-              std::cerr << "Error: '" << path << "' does not exist" << std::endl;
-              return -1;
-            }
-#else
-            if (wait_for_file) {
-              // Wait for the file to become available with timeout (non-POCO version)
-              if (!quiet_) {
-                std::cout << "Waiting for file '" << path
-                          << "' to become available";
-                if (wait_config.timeout_seconds > 0) {
-                  std::cout << " (timeout: " << wait_config.timeout_seconds << " seconds)";
-                }
-                std::cout << "..." << std::endl;
-              }
-
-              auto start_time = std::chrono::steady_clock::now();
-              while (!std::filesystem::exists(path)) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-
-                // Check timeout if configured
-                if (wait_config.timeout_seconds > 0) {
-                  auto elapsed = std::chrono::steady_clock::now() - start_time;
-                  auto elapsed_seconds = std::chrono::duration_cast<std::chrono::seconds>(elapsed).count();
-                  if (elapsed_seconds >= wait_config.timeout_seconds) {
-                    std::cerr << "Error: Timeout waiting for file '" << path
-                              << "' after " << elapsed_seconds << " seconds" << std::endl;
-                    return -1;
-                  }
-                }
-              }
-              if (!quiet_) {
-                std::cout << "File '" << path
-                          << "' is now available, continuing..." << std::endl;
-              }
-            } else if (!std::filesystem::exists(path)) {
-              std::cerr << "Error: '" << path << "' does not exist" << std::endl;
-              return -1;
-            }
-#endif
-          } else {
-            f = false;
-          }
-        }
-#ifdef USE_POCO
-        if (key == "hash") {
-          hash = it->second.as<std::string>();
-        }
-#endif
-
-#ifdef USE_GLOBUS
-        // Handle Globus transfer if source is a globus:// URL
-        if (path.find("globus://") != path.npos && key == "dst") {
-          std::string dest_uri = it->second.as<std::string>();
-          if (dest_uri.find("globus://") == 0) {
-            // Try environment variable first, then config file
-            std::string transfer_token =
-                std::getenv("GLOBUS_TRANSFER_TOKEN")
-                    ? std::getenv("GLOBUS_TRANSFER_TOKEN")
-                    : "";
-            if (transfer_token.empty()) {
-              transfer_token = ReadConfigValue("GLOBUS_TRANSFER_TOKEN");
-            }
-            if (transfer_token.empty()) {
-              std::cerr
-                  << "Error: GLOBUS_TRANSFER_TOKEN not found in environment or ~/.wrp/config"
-                  << std::endl;
-              return -1;
-            }
-
-            if (transfer_globus_file(path, dest_uri, transfer_token,
-                                     "OMNI Transfer")) {
-              if (!quiet_) {
-                std::cout << "Globus transfer initiated successfully from " << path
-                          << " to " << dest_uri << std::endl;
-              }
-              return 0;
-            } else {
-              std::cerr << "Error: Failed to initiate Globus transfer"
-                        << std::endl;
-              return -1;
-            }
+            plan.path = original_path;
           }
-        }
-#endif  // USE_GLOBUS
-        if (key == "offset") {
-          offset = it->second.as<size_t>();
-        }
-        if (key == "nbyte") {
-          nbyte = it->second.as<size_t>();
-          std::vector<char> buffer(nbyte);
-          unsigned char* ptr = reinterpret_cast<unsigned char*>(buffer.data());
-          if (!path.empty() && f == true) {
-#ifndef NDEBUG
-            if (!quiet_) {
-              std::cout << "path=" << path << std::endl;
-            }
-#endif
-            if (ReadExactBytesFromOffset(path.c_str(), offset, nbyte, ptr) ==
-                0) {
-#ifndef NDEBUG
-              if (!quiet_) {
-                std::cout << "buffer=" << ptr << std::endl;
-              }
-#endif
-              PutData(name, tags, path, ptr, nbyte);
-            } else {
-              return -1;
-            }
-          }
-        }
-        if (key == "run") {
-          run = true;
-          lambda = it->second.as<std::string>();
-        }
-        if (key == "dst") {
-          dest = it->second.as<std::string>();
-#ifndef _WIN32
-#ifdef USE_HERMES
-          // Only call GetHermes if Hermes client is initialized
-          if (chi::chiClient != nullptr) {
-            GetHermes(name, path);
-          }
-#endif
-#endif
+        } else if (key == "hash") {
+          plan.hash = it->second.as<std::string>();
+        } else if (key == "offset") {
+          plan.offset = it->second.as<size_t>();
+        } else if (key == "nbyte") {
+          plan.nbyte = it->second.as<size_t>();
+          plan.has_nbyte = true;
+        } else if (key == "run") {
+          plan.lambda = it->second.as<std::string>();
+        } else if (key == "dst") {
+          plan.dest = it->second.as<std::string>();
+        } else if (key == "compress") {
+          plan.compress = it->second.as<std::string>();
+        } else if (key == "format") {
+          plan.format = it->second.as<std::string>();
         }
 
         if (it->second.IsScalar()) {
@@ -2705,10 +3179,14 @@ int OMNI::ReadOmni(const std::string& input_file) {
               }
 #endif
               if (key == "tags") {
-                tags += it->second[i].as<std::string>();
+                plan.tags += it->second[i].as<std::string>();
                 if (i < it->second.size() - 1) {
-                  tags += ",";
+                  plan.tags += ",";
                 }
+              } else if (key == "columns") {
+                plan.columns.push_back(it->second[i].as<std::string>());
+              } else if (key == "row_groups") {
+                plan.row_groups.push_back(it->second[i].as<int>());
               }
             }
           }
@@ -2745,200 +3223,869 @@ int OMNI::ReadOmni(const std::string& input_file) {
         std::cout << root.as<std::string>() << std::endl;
       }
     }
-  } catch (YAML::ParserException& e) {
+  } catch (YAML::Exception& e) {
     std::cerr << "Error: parsing YAML - " << e.what() << std::endl;
     return 1;
   }
 
   // Validate required fields
-  if (name.empty()) {
+  if (plan.name.empty()) {
     std::cerr << "Error: 'name' field is required in OMNI YAML file" << std::endl;
     return 1;
   }
-  if (tags.empty()) {
+  if (plan.tags.empty()) {
     std::cerr << "Error: 'tags' field is required in OMNI YAML file" << std::endl;
     return 1;
   }
+  Codec codec;
+  if (!ParseCodec(plan.compress, codec)) {
+    std::cerr << "Error: unknown codec '" << plan.compress << "'" << std::endl;
+    return 1;
+  }
+  if (!CodecAvailable(codec)) {
+    std::cerr << "Error: codec '" << plan.compress
+              << "' is not available in this build" << std::endl;
+    return 1;
+  }
+  if (plan.format == "auto") {
+    // Resolve to the format-aware reader for the file's content; files
+    // without one in this build take the byte-range path
+    Format format;
+    if (plan.wait_for_file || !IsLocalSource(plan.path) ||
+        !FormatFactory::DetectFormat(plan.path, format)) {
+      std::cerr << "Error: 'format: auto' needs an existing local 'src'"
+                << std::endl;
+      return 1;
+    }
+    plan.format.clear();
+    if (format == Format::kCsv ||
+        ((format == Format::kParquet || format == Format::kFeather) &&
+         FormatFactory::Available(format))) {
+      plan.format = FormatFactory::Name(format);
+    }
+    if (plan.format == "csv" && !plan.has_nbyte) {
+      // Convert from 'offset' to the end of the file
+      uintmax_t size = fs::file_size(plan.path);
+      plan.nbyte = size > plan.offset ? size - plan.offset : 0;
+      plan.has_nbyte = true;
+    }
+    if (!quiet_) {
+      std::cout << "format: " << FormatFactory::Name(format) << " ("
+                << (plan.format.empty() ? "bytes" : plan.format) << ")"
+                << std::endl;
+    }
+  }
+  if (!plan.format.empty() && plan.format != "csv" &&
+      !IsArrowFormat(plan.format)) {
+    std::cerr << "Error: unknown format '" << plan.format << "'" << std::endl;
+    return 1;
+  }
+#ifndef USE_ARROW
+  if (IsArrowFormat(plan.format)) {
+    std::cerr << "Error: format '" << plan.format
+              << "' is not available in this build" << std::endl;
+    return 1;
+  }
+#endif
+  if (!plan.columns.empty() && plan.format.empty()) {
+    std::cerr << "Error: 'columns' needs a 'format'" << std::endl;
+    return 1;
+  }
+  if (!plan.row_groups.empty() && !IsArrowFormat(plan.format)) {
+    std::cerr << "Error: 'row_groups' needs format parquet or feather"
+              << std::endl;
+    return 1;
+  }
+  if (plan.format == "csv" && !plan.has_nbyte) {
+    std::cerr << "Error: 'format' needs the 'nbyte' range to convert"
+              << std::endl;
+    return 1;
+  }
+  return 0;
+}
 
-#ifdef USE_DATAHUB
-  // Check DataHub configuration and register if enabled
-  if (CheckDataHubConfig()) {
-    int datahub_result = RegisterWithDataHub(name, tags);
-    if (datahub_result != 0) {
-      std::cerr << "Warning: DataHub registration failed, continuing..." << std::endl;
-      // Don't return error - just warn and continue
+int OMNI::ReadOmni(const std::vector<std::string>& input_files) {
+  // Read wait timeout configuration
+  WaitConfig wait_config = ReadWaitConfig();
+
+  // Compile and validate every descriptor before any stage runs.
+  std::vector<std::unique_ptr<OmniJob>> jobs;
+  std::vector<OmniJob*> queue;
+  int rc = 0;
+  for (const std::string& input_file : input_files) {
+    auto job = std::make_unique<OmniJob>();
+    rc = CompilePlan(input_file, job->plan);
+    if (rc != 0) {
+      break;
+    }
+    job->wait_config = wait_config;
+    if (nranks_ > 1) {
+      // Local ranges are split across the ranks; anything else is put
+      // whole, once, by rank 0
+      const OmniPlan& plan = job->plan;
+      if (plan.has_nbyte && IsLocalSource(plan.path) && plan.lambda.empty() &&
+          plan.dest.empty() && plan.format.empty()) {
+        job->stripe = true;
+      } else if (rank_ != 0) {
+        job->done = true;
+      }
+    }
+    queue.push_back(job.get());
+    jobs.push_back(std::move(job));
+  }
+#ifdef USE_MPI
+  // The ranks meet in the collectives of CommitStripes, so they give up
+  // together if a descriptor failed to compile on any of them
+  if (nranks_ > 1) {
+    int failed = rc != 0 ? 1 : 0;
+    int any_failed = 0;
+    MPI_Allreduce(&failed, &any_failed, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    if (any_failed && rc == 0) {
+      rc = 1;
     }
   }
 #endif
+  if (rc != 0) {
+    return rc;
+  }
 
-#if USE_HDF5
-  if (path.find("hdf5://") != path.npos) {
-    cae::DatasetConfig dc = cae::ParseDatasetConfig(input_file);
-    cae::Hdf5DatasetClient client;
+  // fetch -> read -> convert -> compress -> put -> lambda -> upload. While
+  // one descriptor uploads the next one is already being fetched and put,
+  // and a source hash is computed in the background while it is read and
+  // compressed; the put stage waits for it before storing anything.
+  auto stage = [this](int (OMNI::*fn)(OmniJob&)) {
+    return [this, fn](OmniJob*& job) {
+      if (job->status != 0 || job->done) {
+        return;
+      }
+      try {
+        job->status = (this->*fn)(*job);
+      } catch (std::exception& e) {
+        std::cerr << "Error: standard exception - " << e.what() << std::endl;
+        job->status = 1;
+      }
+    };
+  };
+  Pipeline<OmniJob*> pipeline;
+  pipeline.AddStage("fetch", stage(&OMNI::FetchStage));
+  pipeline.AddStage("read", stage(&OMNI::ReadStage));
+  pipeline.AddStage("convert", stage(&OMNI::ConvertStage));
+  pipeline.AddStage("compress", stage(&OMNI::CompressStage));
+  pipeline.AddStage("put", stage(&OMNI::PutStage));
+  pipeline.AddStage("lambda", stage(&OMNI::LambdaStage));
+  pipeline.AddStage("upload", stage(&OMNI::UploadStage));
+  std::vector<StageStats> stats = pipeline.Run(queue);
 
-    // Read dataset and get the buffer
-    size_t buffer_size = 0;
-    unsigned char* buffer = client.ReadDataset(dc, buffer_size);
+  if (!quiet_) {
+    for (const StageStats& st : stats) {
+      std::ostringstream line;
+      line << std::fixed << std::setprecision(3) << "stage '" << st.name
+           << "': " << st.items << " jobs, " << st.busy_seconds * 1e3
+           << " ms busy, " << st.idle_seconds * 1e3 << " ms idle";
+      std::cout << line.str() << std::endl;
+    }
+  }
 
-    if (buffer && buffer_size > 0) {
-      // Use PutData to write the buffer
-      int result =
-          PutData(dc.name,      // name
-                  tags,         // tags
-                  "",           // path (empty for now)
-                  buffer,       // buffer
-                  buffer_size   // buffer size in bytes
-          );
-
-      if (result != 0) {
-        std::cerr << "Error: Failed to write buffer using PutData()"
-                  << std::endl;
+  int striped = CommitStripes(jobs);
+  for (const auto& job : jobs) {
+    if (job->status != 0) {
+      return job->status;
+    }
+  }
+  return striped;
+}
+
+int OMNI::CommitStripes(const std::vector<std::unique_ptr<OmniJob>>& jobs) {
+  int result = 0;
+#ifdef USE_MPI
+  // Every rank walks the jobs in the same order, so the collectives match
+  for (const auto& job : jobs) {
+    if (!job->stripe) {
+      continue;
+    }
+    const OmniPlan& plan = job->plan;
+    // Each rank hashed the leaves of the stripe it read; the Merkle root
+    // of the range is the digest of the striped buffer
+    std::string digest;
+    std::string source;  // hash of the whole source, if one is to be checked
+    {
+      StatSpan span("hash");
+      span.SetBackend("merkle");
+      std::vector<Sha256::Digest> leaves;
+      bool failed = !job->leaves.valid();
+      if (!failed) {
+        leaves = job->leaves.get();
+      }
+      digest = MerkleRootGather(leaves, failed, MPI_COMM_WORLD);
+    }
+    if (IsMerkleHash(plan.hash)) {
+      // Rank 0's view of the source size decides the range for everyone
+      long long size = -1;
+      if (rank_ == 0) {
+        std::error_code ec;
+        uintmax_t n = fs::file_size(plan.path, ec);
+        size = ec ? -1 : static_cast<long long>(n);
+      }
+      MPI_Bcast(&size, 1, MPI_LONG_LONG, 0, MPI_COMM_WORLD);
+      if (size >= 0 && plan.offset == 0 &&
+          static_cast<uint64_t>(size) == plan.nbyte) {
+        source = digest;  // the range is the whole source
+      } else if (size >= 0) {
+        StatSpan span("hash");
+        span.SetBackend("merkle");
+        source = MerkleRootMpi(plan.path, 0, static_cast<uint64_t>(size),
+                               MPI_COMM_WORLD);
+      }
+    } else if (!plan.hash.empty() && rank_ == 0) {
+      try {
+        source = Sha256File(plan.path);
+      } catch (std::exception& e) {
+        std::cerr << e.what() << std::endl;
+      }
+    }
+
+    // Rank 0 decides whether the range matches the expected hash; only
+    // then does any rank store its stripe
+    int verified = 1;
+    if (!plan.hash.empty()) {
+      if (rank_ == 0) {
+        if (digest.empty()) {
+          std::cerr << "Error: hashing '" << plan.path << "' failed"
+                    << std::endl;
+          verified = 0;
+        } else if (plan.hash != source) {
+          std::cerr << "Error: hash '" << plan.hash
+                    << "' is not same as actual '" << source << "'"
+                    << std::endl;
+          verified = 0;
+        }
+      }
+      MPI_Bcast(&verified, 1, MPI_INT, 0, MPI_COMM_WORLD);
+      if (!verified) {
+        result = -1;
+        continue;
+      }
+      if (job->status == 0 && StoreJob(*job) != 0) {
+        job->status = -1;
+      }
+    }
+
+    // Stored size of this rank's stripe, or -1 if it was not stored
+    long long stored = -1;
+    BufferMeta stripe;
+    std::string stripe_name = StripeName(plan.name, rank_);
+    if (job->status == 0 && ReadBufferMeta(stripe_name, stripe) == 0) {
+      Slice slice = StripeSlice(plan, rank_, nranks_);
+      if (stripe.size == slice.nbyte) {
+        stored = static_cast<long long>(stripe.stored_size);
       } else {
-        if (!quiet_) {
-          std::cout << "Successfully wrote buffer using PutData()" << std::endl;
+        // An existing buffer is never overwritten by put
+        std::cerr << "Error: stripe '" << stripe_name << "' holds "
+                  << stripe.size << " bytes, expected " << slice.nbyte
+                  << " (left from a put with another rank count?)"
+                  << std::endl;
+      }
+    }
+    std::vector<long long> sizes(rank_ == 0 ? nranks_ : 1);
+    MPI_Gather(&stored, 1, MPI_LONG_LONG, sizes.data(), 1, MPI_LONG_LONG, 0,
+               MPI_COMM_WORLD);
+
+    int ok = 1;
+    if (rank_ == 0) {
+      BufferMeta meta;
+      meta.name = plan.name;
+      meta.tags = plan.tags;
+      meta.backend = "striped";
+      meta.size = plan.nbyte;
+      meta.stripes = static_cast<uint32_t>(nranks_);
+      meta.digest = digest;
+      for (long long n : sizes) {
+        if (n < 0) {
+          ok = 0;
+        } else {
+          meta.stored_size += static_cast<size_t>(n);
+        }
+      }
+      if (!ok) {
+        std::cerr << "Error: not every rank stored its stripe of '"
+                  << plan.name << "'" << std::endl;
+      } else if (digest.empty()) {
+        std::cerr << "Error: hashing '" << plan.path << "' failed"
+                  << std::endl;
+        ok = 0;
+      } else if (WriteBufferMeta(meta) != 0 ||
+                 WriteMeta(plan.name, plan.tags) != 0) {
+        ok = 0;
+      } else if (!quiet_) {
+        std::cout << "striped '" << plan.name << "' over " << nranks_
+                  << " ranks" << std::endl;
+      }
+    }
+    MPI_Bcast(&ok, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (!ok) {
+      result = -1;
+    }
+  }
+#else
+  (void)jobs;
+#endif
+  return result;
+}
+
+int OMNI::FetchStage(OmniJob& job) {
+  const OmniPlan& plan = job.plan;
+  const std::string& path = plan.path;
+  if (path.empty()) {
+    return 0;
+  }
+  if (plan.wait_for_file && !quiet_) {
+    std::cout << "Will wait for file: " << path.c_str() << std::endl;
+  }
+#ifndef NDEBUG
+  if (!quiet_) {
+    std::cout << "Path=" << path.c_str() << std::endl;
+  }
+#endif
+
+  if (IsLocalSource(path)) {
+    const WaitConfig& wait_config = job.wait_config;
+    if (plan.wait_for_file) {
+      // Wait for the file to become available with timeout
+      StatSpan span("wait");
+      if (!quiet_) {
+        std::cout << "Waiting for file '" << path
+                  << "' to become available";
+        if (wait_config.timeout_seconds > 0) {
+          std::cout << " (timeout: " << wait_config.timeout_seconds << " seconds)";
         }
+        std::cout << "..." << std::endl;
       }
 
-      // Free the allocated buffer
-      delete[] buffer;
+      auto start_time = std::chrono::steady_clock::now();
+      while (!std::filesystem::exists(path)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        // Check timeout if configured
+        if (wait_config.timeout_seconds > 0) {
+          auto elapsed = std::chrono::steady_clock::now() - start_time;
+          auto elapsed_seconds = std::chrono::duration_cast<std::chrono::seconds>(elapsed).count();
+          if (elapsed_seconds >= wait_config.timeout_seconds) {
+            std::cerr << "Error: Timeout waiting for file '" << path
+                      << "' after " << elapsed_seconds << " seconds" << std::endl;
+            return -1;
+          }
+        }
+      }
+      if (!quiet_) {
+        std::cout << "File '" << path
+                  << "' is now available, continuing..." << std::endl;
+      }
+    } else if (!std::filesystem::exists(path)) {
+      std::cerr << "Error: '" << path << "' does not exist" << std::endl;
+      return -1;
+    }
+  }
+
+#ifdef USE_GLOBUS
+  // Handle Globus transfer if source is a globus:// URL
+  if (path.find("globus://") != path.npos &&
+      plan.dest.find("globus://") == 0) {
+    // Try environment variable first, then config file
+    std::string transfer_token =
+        std::getenv("GLOBUS_TRANSFER_TOKEN")
+            ? std::getenv("GLOBUS_TRANSFER_TOKEN")
+            : "";
+    if (transfer_token.empty()) {
+      transfer_token = ReadConfigValue("GLOBUS_TRANSFER_TOKEN");
+    }
+    if (transfer_token.empty()) {
+      std::cerr
+          << "Error: GLOBUS_TRANSFER_TOKEN not found in environment or ~/.wrp/config"
+          << std::endl;
+      return -1;
+    }
+
+    StatSpan span("download");
+    span.SetBackend("globus");
+    if (transfer_globus_file(path, plan.dest, transfer_token,
+                             "OMNI Transfer")) {
+      if (!quiet_) {
+        std::cout << "Globus transfer initiated successfully from " << path
+                  << " to " << plan.dest << std::endl;
+      }
+      job.done = true;
+      return 0;
     } else {
-      std::cerr << "Error: Failed to read dataset or empty dataset"
+      std::cerr << "Error: Failed to initiate Globus transfer"
                 << std::endl;
+      return -1;
     }
   }
-#endif
+#endif  // USE_GLOBUS
 
-#if USE_POCO
-  if (!path.empty() && (path.find("https://") != path.npos)) {
+#ifdef USE_POCO
+  if (path.find("https://") != path.npos) {
     long long start = -1;
     long long end = -1;
-    if (offset > 0) {
-      start = (long long)offset;
+    if (plan.offset > 0) {
+      start = (long long)plan.offset;
     }
-    if (nbyte > 0) {
-      end = (long long)(offset + nbyte);
+    if (plan.nbyte > 0) {
+      end = (long long)(plan.offset + plan.nbyte);
     }
-    if (Download(path, name, start, end) != 0)
+    StatSpan span("download");
+    span.SetBackend("https");
+    if (Download(path, plan.name, start, end) != 0) {
       std::cerr << "Error: downloading '" << path << "' failed " << std::endl;
+    } else {
+      std::error_code ec;
+      uintmax_t size = fs::file_size(plan.name, ec);
+      span.AddBytes(ec ? 0 : size);
+    }
   }
+#endif
 
-  if (!hash.empty()) {
-    std::string h;
-    if (!path.empty() && path.find("https://") != 0 &&
-        path.find("hdf5://") != 0) {
-      h = Sha256File(path);
-    }
+  // Stripes of a partitioned put are verified together in CommitStripes
+  if (!plan.hash.empty() && !job.stripe) {
+    std::string file;
     if (path.find("https://") == 0) {
-      h = Sha256File(name);
+#ifdef USE_POCO
+      file = plan.name;
+#endif
+    } else if (path.find("hdf5://") != 0) {
+      file = path;
     }
+    bool merkle = IsMerkleHash(plan.hash);
+    job.digest = std::async(std::launch::async, [this, file, merkle]() {
+      if (file.empty()) {
+        return std::string();
+      }
+      return merkle ? MerkleHash(file) : Sha256File(file);
+    });
+  }
+  return 0;
+}
+
+int OMNI::ReadStage(OmniJob& job) {
+  const OmniPlan& plan = job.plan;
+  const std::string& path = plan.path;
+  StatSpan span("read");
 
-    if (hash != h) {
-      std::cerr << "Error: hash '" << hash << "' is not same as actual '" << h
-                << "'" << std::endl;
+  if (plan.has_nbyte && IsLocalSource(path) && !IsArrowFormat(plan.format)) {
+    // A partitioned put reads only this rank's slice of the range
+    Slice slice{plan.offset, plan.nbyte};
+    if (job.stripe) {
+      slice = StripeSlice(plan, rank_, nranks_);
+    }
+    if (plan.format == "csv") {
+      // Parse whole records only: both ends move to the next record start
+      RecordOptions options;
+      options.quote = '"';
+      RecordRange records;
+      if (AlignToRecords(path, plan.offset, plan.nbyte, options, records) !=
+          0) {
+        return -1;
+      }
+      slice = Slice{records.offset, records.nbyte};
+    }
+    job.data.resize(slice.nbyte);
+    unsigned char* ptr = reinterpret_cast<unsigned char*>(job.data.data());
+#ifndef NDEBUG
+    if (!quiet_) {
+      std::cout << "path=" << path << std::endl;
+    }
+#endif
+    if (ReadExactBytesFromOffset(path.c_str(), slice.offset, slice.nbyte,
+                                 ptr) != 0) {
       return -1;
     }
+#ifndef NDEBUG
+    if (!quiet_) {
+      std::cout << "buffer=" << std::string(job.data.data(), job.data.size())
+                << std::endl;
+    }
+#endif
+    job.ingested = true;
+    job.input = ptr;
+    job.input_nbyte = slice.nbyte;
+    job.put_name = plan.name;
+    job.put_path = path;
+    if (job.stripe) {
+      job.put_name = StripeName(plan.name, rank_);
+      job.meta.stripe_of = plan.name;
+      // The bytes stay with the job until CommitStripes takes the leaves
+      size_t nbyte = static_cast<size_t>(slice.nbyte);
+      job.leaves = std::async(std::launch::async, [ptr, nbyte]() {
+        return MerkleLeaves(ptr, nbyte);
+      });
+    }
   }
 
-  if (!dest.empty()) {
-#ifndef NDEBUG
+#if USE_HDF5
+  if (path.find("hdf5://") != path.npos) {
+    cae::DatasetConfig dc = cae::ParseDatasetConfig(plan.input_file);
+    cae::Hdf5DatasetClient client;
+
+    // Read dataset and get the buffer
+    size_t buffer_size = 0;
+    unsigned char* buffer = client.ReadDataset(dc, buffer_size);
+
+    if (buffer && buffer_size > 0) {
+      // Keep the buffer for the put and lambda stages; freed with the job
+      job.h5_data.reset(buffer);
+      job.ingested = true;
+      job.input = buffer;
+      job.input_nbyte = buffer_size;
+      job.put_name = dc.name;
+    } else {
+      std::cerr << "Error: Failed to read dataset or empty dataset"
+                << std::endl;
+    }
+  }
+#endif
+  if (job.ingested) {
+    span.AddBytes(job.input_nbyte);
+  }
+  return 0;
+}
+
+int OMNI::ConvertStage(OmniJob& job) {
+  const OmniPlan& plan = job.plan;
+  if (IsArrowFormat(plan.format) && IsLocalSource(plan.path)) {
+    return ReadColumnsStage(job);
+  }
+  if (!job.ingested || plan.format != "csv") {
+    return 0;
+  }
+  StatSpan span("convert");
+  span.SetBackend(plan.format);
+  span.AddBytes(job.input_nbyte);
+
+  // The header, if any, is the first record of the file
+  CsvFormatClient csv;
+  ColumnTable table;
+  std::string error;
+  bool header = plan.offset == 0;
+  if (csv.Parse(reinterpret_cast<const char*>(job.input), job.input_nbyte,
+                header, table, error) != 0 ||
+      !SelectColumns(plan.columns, table, error)) {
+    std::cerr << "Error: converting '" << job.put_name << "' - " << error
+              << std::endl;
+    return -1;
+  }
+  PackColumns(table, job.columnar);
+  job.input = job.columnar.data();
+  job.input_nbyte = job.columnar.size();
+  job.meta.columns = table.names;
+  job.meta.dtype = kColumnDtype;
+  job.meta.rows = table.rows;
+  if (!quiet_) {
+    std::cout << "converted '" << job.put_name << "' to " << table.rows
+              << " rows x " << table.names.size() << " " << job.meta.dtype
+              << " columns" << std::endl;
+  }
+  return 0;
+}
+
+// Parquet and Feather sources: the footer locates the projected column
+// chunks, so only those are read and decoded (no byte range is staged).
+int OMNI::ReadColumnsStage(OmniJob& job) {
+  const OmniPlan& plan = job.plan;
+#ifdef USE_ARROW
+  StatSpan span("convert");
+  span.SetBackend(plan.format);
+  ArrowFormatClient client(plan.format == "parquet"
+                               ? ArrowFormatClient::Kind::kParquet
+                               : ArrowFormatClient::Kind::kFeather,
+                           ColumnProjection{plan.columns, plan.row_groups});
+  ColumnTable table;
+  std::string error;
+  if (client.Read(plan.path, table, error) != 0) {
+    std::cerr << "Error: reading '" << plan.path << "' - " << error
+              << std::endl;
+    return -1;
+  }
+  PackColumns(table, job.columnar);
+  span.AddBytes(job.columnar.size());
+  job.ingested = true;
+  job.input = job.columnar.data();
+  job.input_nbyte = job.columnar.size();
+  job.put_name = plan.name;
+  job.put_path = plan.path;
+  job.meta.columns = table.names;
+  job.meta.dtype = kColumnDtype;
+  job.meta.rows = table.rows;
+  if (!quiet_) {
+    std::cout << "read '" << job.put_name << "': " << table.rows << " rows x "
+              << table.names.size() << " " << job.meta.dtype << " columns"
+              << std::endl;
+  }
+  return 0;
+#else
+  // CompilePlan rejects these formats when Arrow is not built in
+  std::cerr << "Error: format '" << plan.format
+            << "' is not available in this build" << std::endl;
+  return -1;
+#endif
+}
+
+int OMNI::CompressStage(OmniJob& job) {
+  Codec codec;
+  if (!job.ingested || !ParseCodec(job.plan.compress, codec) ||
+      codec == Codec::kNone) {
+    return 0;
+  }
+  StatSpan span("compress");
+  span.SetBackend(CodecName(codec));
+  span.AddBytes(job.input_nbyte);
+
+  // Independent frames, compressed on all cores
+  FrameIndex index;
+  if (CompressFrames(codec, job.input, job.input_nbyte, kDefaultFrameSize, 0,
+                     job.stored, index) != 0) {
+    std::cerr << "Error: compressing '" << job.put_name << "' failed"
+              << std::endl;
+    return -1;
+  }
+  if (job.stored.size() >= job.input_nbyte) {
+    // Incompressible; keep the raw bytes
+    std::vector<unsigned char>().swap(job.stored);
     if (!quiet_) {
-      std::cerr << "dst=" << dest << std::endl;
+      std::cout << "'" << job.put_name << "' does not compress with "
+                << CodecName(codec) << ", storing raw bytes" << std::endl;
+    }
+    return 0;
+  }
+  job.meta.frames = index;
+  if (!quiet_) {
+    std::cout << "compressed '" << job.put_name << "' with "
+              << CodecName(codec) << ": " << job.input_nbyte << " -> "
+              << job.stored.size() << " bytes in " << index.Frames()
+              << " frames" << std::endl;
+  }
+  return 0;
+}
+
+int OMNI::PutStage(OmniJob& job) {
+  const OmniPlan& plan = job.plan;
+
+  // Nothing is stored, run or uploaded before the source hash is verified.
+  if (job.digest.valid()) {
+    std::string h = job.digest.get();
+    if (plan.hash != h) {
+      std::cerr << "Error: hash '" << plan.hash << "' is not same as actual '"
+                << h << "'" << std::endl;
+      return -1;
+    }
+  }
+
+  // A checked stripe waits for CommitStripes, where the ranks agree on the
+  // hash of the whole range before any of them stores its stripe
+  if (!(job.stripe && !plan.hash.empty()) && StoreJob(job) != 0) {
+    return -1;
+  }
+
+#ifdef USE_DATAHUB
+  // Check DataHub configuration and register if enabled
+  if (CheckDataHubConfig()) {
+    int datahub_result = RegisterWithDataHub(plan.name, plan.tags);
+    if (datahub_result != 0) {
+      std::cerr << "Warning: DataHub registration failed, continuing..." << std::endl;
+      // Don't return error - just warn and continue
     }
+  }
+#endif
+
+#ifndef _WIN32
+#ifdef USE_HERMES
+  // Only call GetHermes if Hermes client is initialized
+  if (!plan.dest.empty() && chi::chiClient != nullptr) {
+    GetHermes(plan.name, plan.path);
+  }
+#endif
 #endif
+  return 0;
+}
+
+// Store the ingested (and possibly compressed) bytes of a job
+int OMNI::StoreJob(OmniJob& job) {
+  const OmniPlan& plan = job.plan;
+  if (!job.ingested) {
+    return 0;
+  }
+  job.meta.size = job.input_nbyte;
+  bool compressed = job.meta.frames.codec != Codec::kNone;
+  unsigned char* bytes = compressed ? job.stored.data() : job.input;
+  size_t nbyte = compressed ? job.stored.size() : job.input_nbyte;
+  StatSpan span("put");
+  span.AddBytes(nbyte);
+  int result = PutData(job.put_name, plan.tags, job.put_path, bytes, nbyte,
+                       &job.meta);
+  span.SetBackend(job.meta.backend);
+  if (result != 0) {
+    std::cerr << "Error: Failed to write buffer '" << job.put_name
+              << "' using PutData()" << std::endl;
+    return -1;
+  }
+  if (plan.path.find("hdf5://") != plan.path.npos && !quiet_) {
+    std::cout << "Successfully wrote buffer using PutData()" << std::endl;
+  }
+  return 0;
+}
+
+int OMNI::LambdaStage(OmniJob& job) {
+  const OmniPlan& plan = job.plan;
+  if (plan.dest.empty() || plan.lambda.empty()) {
+    return 0;
+  }
+  StatSpan span("lambda");
+
+  if (IsPluginLambda(plan.lambda)) {
+    span.SetBackend("plugin");
 #ifdef USE_POCO
-    try {
-      if (run) {
-        res = RunLambda(lambda, name, dest);
+    // A downloaded source lives in the local file named after the buffer.
+    if (job.input == nullptr && plan.path.find("https://") == 0) {
+      std::ifstream dl(plan.name, std::ios::binary);
+      job.data.assign(std::istreambuf_iterator<char>(dl),
+                      std::istreambuf_iterator<char>());
+      job.input = reinterpret_cast<unsigned char*>(job.data.data());
+      job.input_nbyte = job.data.size();
+    }
+#endif
+    span.AddBytes(job.input_nbyte);
+    if (RunPlugin(plan.lambda, plan.name, plan.tags, job.input,
+                  job.input_nbyte, plan.dest, job.lambda_output) != 0) {
+      std::cerr << "Error: lambda failed to generate '" << plan.dest << "'"
+                << std::endl;
+      return -1;
+    }
+    return 0;
+  }
+
+  span.SetBackend("process");
+#ifdef USE_POCO
+  job.lambda_result = RunLambda(plan.lambda, plan.name, plan.dest);
+#endif
+  return 0;
+}
+
+int OMNI::UploadStage(OmniJob& job) {
+  const OmniPlan& plan = job.plan;
+  const std::string& dest = plan.dest;
+
+  if (dest.empty()) {
+    return 0;
+  }
+  size_t scheme = dest.find("://");
+  std::string dest_scheme =
+      scheme == std::string::npos ? "file" : dest.substr(0, scheme);
+  if (!plan.lambda.empty() && IsPluginLambda(plan.lambda)) {
+    StatSpan span("upload");
+    span.SetBackend(dest_scheme);
+    span.AddBytes(job.lambda_output.size());
+    return WriteLambdaOutput(dest, job.lambda_output);
+  }
+
+#ifdef USE_POCO
+  const std::string& name = plan.name;
+#ifndef NDEBUG
+  if (!quiet_) {
+    std::cerr << "dst=" << dest << std::endl;
+  }
+#endif
+  StatSpan span("upload");
+  span.SetBackend(dest_scheme);
+  try {
+    if (!plan.lambda.empty()) {
+      if (job.lambda_result == 0) {
+        WriteS3(dest, NULL);
       } else {
-#if defined(USE_AWS) || defined(USE_POCO)
-        Poco::File file(name);
-        if (!file.exists()) {
-          throw Poco::FileNotFoundException("Error: buffer '" + name +
-                                            "' not found");
-        }
+        std::cerr << "Error: lambda failed to generate '" << dest << "'"
+                  << std::endl;
+      }
+    } else if (job.meta.frames.codec != Codec::kNone) {
+      // The stored buffer is compressed; upload the raw bytes instead
+      span.AddBytes(job.input_nbyte);
+      WriteS3(dest, reinterpret_cast<const char*>(job.input),
+              job.input_nbyte);
+    } else {
+      Poco::File file(name);
+      if (!file.exists()) {
+        throw Poco::FileNotFoundException("Error: buffer '" + name +
+                                          "' not found");
+      }
 
 #ifdef USE_MEMCACHED
-        // Try Memcached first if available
-        try {
-          MemcachedClient memcached_client("localhost", 11211);
-          if (memcached_client.connect()) {
-            std::string memcached_data;
-            if (memcached_client.get(name, memcached_data)) {
-              if (!quiet_) {
-                std::cout << "read data from Memcached key '" << name << "'" << std::endl;
-              }
-              WriteS3(dest, memcached_data.c_str());
-            } else {
-              throw std::runtime_error("Memcached GET command failed - key not found");
+      // Try Memcached first if available
+      try {
+        MemcachedClient memcached_client("localhost", 11211);
+        if (memcached_client.connect()) {
+          std::string memcached_data;
+          if (memcached_client.get(name, memcached_data)) {
+            if (!quiet_) {
+              std::cout << "read data from Memcached key '" << name << "'" << std::endl;
             }
+            WriteS3(dest, memcached_data.c_str());
           } else {
-            throw std::runtime_error("Failed to connect to Memcached server");
-          }
-        } catch (const std::exception& e) {
-          if (!quiet_) {
-            std::cout << "Memcached error: " << e.what() << ", falling back to other storage..." << std::endl;
+            throw std::runtime_error("Memcached GET command failed - key not found");
           }
-          // Fall through to other storage backends
+        } else {
+          throw std::runtime_error("Failed to connect to Memcached server");
+        }
+      } catch (const std::exception& e) {
+        if (!quiet_) {
+          std::cout << "Memcached error: " << e.what() << ", falling back to other storage..." << std::endl;
         }
+        // Fall through to other storage backends
+      }
 #endif
 
 #ifdef USE_REDIS
-        // Try Redis if available
-        try {
-          Poco::Redis::Client redis_client("localhost", 6379);
-          Poco::Redis::Command get_cmd("GET");
-          get_cmd << name;
-          
-          Poco::Redis::BulkString result = redis_client.execute<Poco::Redis::BulkString>(get_cmd);
-          if (!result.isNull()) {
-            std::string redis_data = result.value();
-            if (!quiet_) {
-              std::cout << "read data from Redis key '" << name << "'" << std::endl;
-            }
-            WriteS3(dest, redis_data.c_str());
-          } else {
-            throw Poco::Exception("Redis GET command failed - key not found");
-          }
-        } catch (const Poco::Exception& e) {
-          if (!quiet_) {
-            std::cout << "Redis error: " << e.displayText() << ", falling back to SharedMemory..." << std::endl;
-          }
-          // Fall through to SharedMemory
-        } catch (const std::exception& e) {
+      // Try Redis if available
+      try {
+        Poco::Redis::Client redis_client("localhost", 6379);
+        Poco::Redis::Command get_cmd("GET");
+        get_cmd << name;
+
+        Poco::Redis::BulkString result = redis_client.execute<Poco::Redis::BulkString>(get_cmd);
+        if (!result.isNull()) {
+          std::string redis_data = result.value();
           if (!quiet_) {
-            std::cout << "Redis error: " << e.what() << ", falling back to SharedMemory..." << std::endl;
+            std::cout << "read data from Redis key '" << name << "'" << std::endl;
           }
-          // Fall through to SharedMemory
+          WriteS3(dest, redis_data.c_str());
+        } else {
+          throw Poco::Exception("Redis GET command failed - key not found");
         }
-#endif
-
-        // Fallback to SharedMemory (original implementation)
-        Poco::SharedMemory shm_r(file, Poco::SharedMemory::AM_READ);
+      } catch (const Poco::Exception& e) {
         if (!quiet_) {
-          std::cout << "read '" << shm_r.begin() << "' from '" << name
-                    << "' buffer (SharedMemory)." << std::endl;
+          std::cout << "Redis error: " << e.displayText() << ", falling back to SharedMemory..." << std::endl;
         }
-        WriteS3(dest, shm_r.begin());
-#endif  // USE_AWS || USE_POCO
+        // Fall through to SharedMemory
+      } catch (const std::exception& e) {
+        if (!quiet_) {
+          std::cout << "Redis error: " << e.what() << ", falling back to SharedMemory..." << std::endl;
+        }
+        // Fall through to SharedMemory
       }
-      if (res == 0) {
-#if defined(USE_AWS) || defined(USE_POCO)
-        WriteS3(dest, NULL);
-#endif  // USE_AWS || USE_POCO
-      } else {
-        std::cerr << "Error: lambda failed to generate '" << dest << "'"
-                  << std::endl;
+#endif
+
+      // Fallback to SharedMemory (original implementation)
+      Poco::SharedMemory shm_r(file, Poco::SharedMemory::AM_READ);
+      if (!quiet_) {
+        std::cout << "read '" << shm_r.begin() << "' from '" << name
+                  << "' buffer (SharedMemory)." << std::endl;
       }
-    } catch (Poco::Exception& e) {
-      std::cerr << "Error: poco exception - " << e.displayText() << std::endl;
-      return 1;
-    } catch (std::exception& e) {
-      std::cerr << "Error: standard exception - " << e.what() << std::endl;
-      return 1;
+      WriteS3(dest, shm_r.begin());
     }
-#endif  // POCO: dset not empty
+  } catch (Poco::Exception& e) {
+    std::cerr << "Error: poco exception - " << e.displayText() << std::endl;
+    return 1;
+  } catch (std::exception& e) {
+    std::cerr << "Error: standard exception - " << e.what() << std::endl;
+    return 1;
   }
-#endif  // POCO: URL
+#endif  // USE_POCO
   return 0;
 }
 
@@ -2968,16 +4115,57 @@ std::string OMNI::ReadTags(const std::string& buf) {
   return "";
 }
 
+std::string OMNI::BufferDigest(const std::string& name) {
+  BufferMeta meta;
+  bool cataloged = ReadBufferMeta(name, meta) == 0;
+  if (cataloged && (meta.backend == "arena" || meta.backend == "striped")) {
+    // No single buffer file: the digest taken at put is always current
+    if (!quiet_ && !meta.digest.empty()) {
+      std::cout << "using cached digest of '" << name << "'" << std::endl;
+    }
+    return meta.digest;
+  }
+  uint64_t size = 0;
+  int64_t mtime = 0;
+  if (!StatBufferFile(name, size, mtime)) {
+    return "";
+  }
+  if (cataloged && !meta.digest.empty() && meta.file_size == size &&
+      meta.mtime == mtime) {
+    if (!quiet_) {
+      std::cout << "using cached digest of '" << name << "'" << std::endl;
+    }
+    return meta.digest;
+  }
+
+  // Unknown or modified since put: hash once and refresh the catalog
+  if (!quiet_) {
+    std::cout << "hashing '" << name << "'" << std::endl;
+  }
+  std::string h;
+  try {
+    h = Sha256File(name);
+  } catch (std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return "";
+  }
+  if (cataloged) {
+    meta.digest = h;
+    meta.file_size = size;
+    meta.mtime = mtime;
+    WriteBufferMeta(meta);
+  }
+  return h;
+}
+
 int OMNI::WriteOmni(const std::string& buf) {
+  std::string h = BufferDigest(buf);
+
   std::string ofile = buf + ".omni.yaml";
   if (!quiet_) {
     std::cout << "writing output " << ofile << "...";
   }
 
-#ifdef USE_POCO
-  std::string h = Sha256File(buf);
-#endif
-
   std::ofstream of(ofile);
   of << "# OMNI" << std::endl;
   of << "name: " << buf << std::endl;
@@ -3008,13 +4196,21 @@ int OMNI::WriteOmni(const std::string& buf) {
     return -1;
   }
 
-#ifdef USE_POCO
-  Poco::Path path(buf);
-  of << "src: " << path.makeAbsolute().toString() << std::endl;
   if (!h.empty()) {
+    if (fs::exists(buf)) {
+      of << "src: " << fs::absolute(buf).string() << std::endl;
+    }
     of << "hash: " << h << std::endl;
   }
-#endif
+  // Schema of a columnar buffer
+  BufferMeta meta;
+  if (ReadBufferMeta(buf, meta) == 0 && !meta.columns.empty()) {
+    YAML::Emitter columns;
+    columns << YAML::Flow << meta.columns;
+    of << "columns: " << columns.c_str() << std::endl;
+    of << "dtype: " << meta.dtype << std::endl;
+    of << "rows: " << meta.rows << std::endl;
+  }
   of.close();
   if (!quiet_) {
     std::cout << "done" << std::endl;
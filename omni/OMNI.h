@@ -4,10 +4,12 @@
 #ifndef CAE_OMNI_H_
 #define CAE_OMNI_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <utility>
 #include <cstddef>
+#include <cstdint>
 #include <sys/types.h>
 
 #ifdef USE_HERMES
@@ -36,6 +38,29 @@ struct WaitConfig {
   int timeout_seconds = -1;  // -1 means wait forever (default), 0 or positive means timeout in seconds
 };
 
+// Execution plan compiled from one OMNI descriptor. Every key is known
+// before any stage runs, so YAML key order does not matter.
+struct OmniPlan {
+  std::string input_file;  // descriptor the plan was compiled from
+  std::string name;
+  std::string tags;        // comma separated
+  std::string path;        // 'src' without the '>' wait prefix
+  bool wait_for_file = false;
+  std::string hash;
+  size_t offset = 0;
+  size_t nbyte = 0;
+  bool has_nbyte = false;  // 'nbyte' present: read and put the range
+  std::string lambda;      // 'run'
+  std::string dest;        // 'dst'
+  std::string compress;    // codec for the stored buffer ('compress')
+  std::string format;      // 'format': csv, parquet or feather columns
+  std::vector<std::string> columns;  // 'columns' to keep (default all)
+  std::vector<int> row_groups;       // Parquet 'row_groups' (default all)
+};
+
+struct OmniJob;
+struct BufferMeta;
+
 class OMNI {
  public:
   OMNI() = default;
@@ -43,12 +68,34 @@ class OMNI {
 
   // Main public API - these call private helper methods
   int Put(const std::string& input_file);
+  int Put(const std::vector<std::string>& input_files);
   int Get(const std::string& buffer);
   int List();
 
+  // Read a stored buffer back from its backend, decompressing if needed
+  int GetData(const std::string& name, std::vector<unsigned char>& data);
+
+  // Stream nbyte raw bytes of a buffer from offset to out_path ("-" is
+  // stdout); file and shm buffers are copied in-kernel where possible
+  int StreamData(const std::string& name, const std::string& out_path,
+                 uint64_t offset = 0, uint64_t nbyte = UINT64_MAX);
+
   // Set quiet mode (suppress stdout)
   void SetQuiet(bool quiet) { quiet_ = quiet; }
 
+  // Storage backends compiled into this build, in the order PutData tries
+  // them (hermes, arena, memcached, redis, then shm or file)
+  static std::vector<std::string> Backends();
+
+  // Store every put in one backend with no fallback ("" restores the
+  // default order). Returns 1 if the backend is not compiled in.
+  int SetBackend(const std::string& backend);
+
+  // Share each descriptor's byte range among nranks MPI ranks: every rank
+  // stores its own slice as <name>.<rank> and rank 0 catalogs <name> as
+  // the striped buffer. Returns 1 if nranks > 1 without USE_MPI.
+  int SetPartition(int rank, int nranks);
+
   // DataHub configuration (public for testing)
   bool CheckDataHubConfig();
   std::string ReadConfigFile(const std::string& config_path);
@@ -58,15 +105,26 @@ class OMNI {
   WaitConfig ReadWaitConfig();
 
   // Exposed for testing
-#ifdef USE_POCO
+  int CompilePlan(const std::string& input_file, OmniPlan& plan);
   std::string Sha256File(const std::string& file_path);
-#endif
+  std::string MerkleHash(const std::string& file_path);  // "merkle:<hex>"
+  std::string BufferDigest(const std::string& name);
   int ReadExactBytesFromOffset(const char* filename, off_t offset,
                                size_t num_bytes, unsigned char* buffer);
 
  private:
   // Core processing methods
-  int ReadOmni(const std::string& input_file);
+  int ReadOmni(const std::vector<std::string>& input_files);
+  int FetchStage(OmniJob& job);
+  int ReadStage(OmniJob& job);
+  int ConvertStage(OmniJob& job);
+  int ReadColumnsStage(OmniJob& job);
+  int CompressStage(OmniJob& job);
+  int PutStage(OmniJob& job);
+  int StoreJob(OmniJob& job);
+  int LambdaStage(OmniJob& job);
+  int UploadStage(OmniJob& job);
+  int CommitStripes(const std::vector<std::unique_ptr<OmniJob>>& jobs);
   int WriteOmni(const std::string& buf);
   int SetBlackhole();
 
@@ -78,6 +136,8 @@ class OMNI {
 
   // Metadata functions
   int WriteMeta(const std::string& name, const std::string& tags);
+  int ListBuffer(const std::string& name, const std::string& tags,
+                 const BufferMeta* meta);
   std::string ReadTags(const std::string& buf);
 
   // DataHub integration functions
@@ -95,9 +155,14 @@ class OMNI {
   int GetHermes(const std::string& name, const std::string& path);
 #endif
   int PutData(const std::string& name, const std::string& tags,
-              const std::string& path, unsigned char* buffer, size_t nbyte);
+              const std::string& path, unsigned char* buffer, size_t nbyte,
+              BufferMeta* meta = nullptr);
+  int CommitPut(const std::string& name, const std::string& tags,
+                const std::string& backend, const unsigned char* buffer,
+                size_t nbyte, BufferMeta* meta);
+  int ReadStored(const BufferMeta& meta, std::vector<unsigned char>& stored);
 #if defined(USE_AWS) || defined(USE_POCO)
-  int WriteS3(const std::string& dest, char* ptr);
+  int WriteS3(const std::string& dest, const char* ptr, size_t nbyte = 0);
 #endif
 
   // Download/transfer functions
@@ -110,8 +175,23 @@ class OMNI {
   int RunLambda(const std::string& lambda, const std::string& name,
                 const std::string& dest);
 
+  // In-process lambdas loaded from 'run: plugin.so:symbol' (see omni_lambda.h)
+  bool IsPluginLambda(const std::string& lambda);
+  int RunPlugin(const std::string& lambda, const std::string& name,
+                const std::string& tags, const unsigned char* buffer,
+                size_t nbyte, const std::string& dest, std::string& output);
+  int WriteLambdaOutput(const std::string& dest, const std::string& output);
+
+  // True if PutData may try this backend
+  bool UseBackend(const char* backend) const {
+    return backend_.empty() || backend_ == backend;
+  }
+
   // Member variables
   bool quiet_ = false;
+  std::string backend_;  // forced by SetBackend, empty for the default order
+  int rank_ = 0;         // this rank of a partitioned put
+  int nranks_ = 1;
 };
 
 }  // namespace cae
@@ -0,0 +1,144 @@
+///
+/// catalog.cc
+///
+#include "catalog.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <yaml-cpp/yaml.h>
+
+namespace cae {
+
+static const char* kMetaDir = ".blackhole/meta";
+
+bool StatBufferFile(const std::string& path, uint64_t& size, int64_t& mtime) {
+  std::error_code ec;
+  size = std::filesystem::file_size(path, ec);
+  if (ec) {
+    return false;
+  }
+  auto t = std::filesystem::last_write_time(path, ec);
+  if (ec) {
+    return false;
+  }
+  mtime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+              t.time_since_epoch())
+              .count();
+  return true;
+}
+
+std::string BufferMetaPath(const std::string& name) {
+  // Buffer names may contain path separators; keep one flat directory.
+  std::string file = name;
+  for (char& c : file) {
+    if (c == '/' || c == '\\') {
+      c = '_';
+    }
+  }
+  return std::string(kMetaDir) + "/" + file + ".yaml";
+}
+
+int WriteBufferMeta(const BufferMeta& meta) {
+  std::error_code ec;
+  std::filesystem::create_directories(kMetaDir, ec);
+  if (ec) {
+    std::cerr << "Error: failed to create " << kMetaDir << " - "
+              << ec.message() << std::endl;
+    return -1;
+  }
+
+  YAML::Emitter out;
+  out << YAML::BeginMap;
+  out << YAML::Key << "name" << YAML::Value << meta.name;
+  out << YAML::Key << "tags" << YAML::Value << meta.tags;
+  out << YAML::Key << "backend" << YAML::Value << meta.backend;
+  out << YAML::Key << "size" << YAML::Value << meta.size;
+  out << YAML::Key << "stored_size" << YAML::Value << meta.stored_size;
+  out << YAML::Key << "codec" << YAML::Value << CodecName(meta.frames.codec);
+  if (meta.frames.codec != Codec::kNone) {
+    out << YAML::Key << "frame_size" << YAML::Value << meta.frames.frame_size;
+    out << YAML::Key << "frames" << YAML::Value << YAML::Flow
+        << meta.frames.offsets;
+  }
+  if (!meta.digest.empty()) {
+    out << YAML::Key << "digest" << YAML::Value << meta.digest;
+    out << YAML::Key << "file_size" << YAML::Value << meta.file_size;
+    out << YAML::Key << "mtime" << YAML::Value << meta.mtime;
+  }
+  if (meta.stripes > 0) {
+    out << YAML::Key << "stripes" << YAML::Value << meta.stripes;
+  }
+  if (!meta.stripe_of.empty()) {
+    out << YAML::Key << "stripe_of" << YAML::Value << meta.stripe_of;
+  }
+  if (!meta.columns.empty()) {
+    out << YAML::Key << "columns" << YAML::Value << YAML::Flow << meta.columns;
+    out << YAML::Key << "dtype" << YAML::Value << meta.dtype;
+    out << YAML::Key << "rows" << YAML::Value << meta.rows;
+  }
+  out << YAML::EndMap;
+
+  // Write to a temporary file and rename so readers never see half a record.
+  std::string path = BufferMetaPath(meta.name);
+  std::string tmp = path + ".tmp";
+  {
+    std::ofstream ofs(tmp, std::ios::trunc);
+    if (!ofs.is_open()) {
+      std::cerr << "Error: could not open " << tmp << std::endl;
+      return -1;
+    }
+    ofs << out.c_str() << std::endl;
+  }
+  std::filesystem::rename(tmp, path, ec);
+  if (ec) {
+    std::cerr << "Error: could not write " << path << " - " << ec.message()
+              << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+int ReadBufferMeta(const std::string& name, BufferMeta& meta) {
+  std::string path = BufferMetaPath(name);
+  if (!std::filesystem::exists(path)) {
+    return 1;
+  }
+  try {
+    YAML::Node node = YAML::LoadFile(path);
+    meta = BufferMeta();
+    meta.name = node["name"].as<std::string>(name);
+    meta.tags = node["tags"].as<std::string>("");
+    meta.backend = node["backend"].as<std::string>("");
+    meta.size = node["size"].as<size_t>(0);
+    meta.stored_size = node["stored_size"].as<size_t>(meta.size);
+    if (!ParseCodec(node["codec"].as<std::string>("none"),
+                    meta.frames.codec)) {
+      std::cerr << "Error: unknown codec in " << path << std::endl;
+      return -1;
+    }
+    meta.frames.frame_size =
+        node["frame_size"].as<size_t>(kDefaultFrameSize);
+    meta.frames.raw_size = meta.size;
+    if (node["frames"]) {
+      meta.frames.offsets = node["frames"].as<std::vector<uint64_t>>();
+    }
+    meta.digest = node["digest"].as<std::string>("");
+    meta.file_size = node["file_size"].as<uint64_t>(0);
+    meta.mtime = node["mtime"].as<int64_t>(0);
+    meta.stripes = node["stripes"].as<uint32_t>(0);
+    meta.stripe_of = node["stripe_of"].as<std::string>("");
+    if (node["columns"]) {
+      meta.columns = node["columns"].as<std::vector<std::string>>();
+    }
+    meta.dtype = node["dtype"].as<std::string>("");
+    meta.rows = node["rows"].as<uint64_t>(0);
+  } catch (YAML::Exception& e) {
+    std::cerr << "Error: parsing " << path << " - " << e.what() << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+}  // namespace cae
@@ -0,0 +1,71 @@
+///
+/// catalog.h
+///
+/// Per-buffer metadata catalog kept next to the tag list in .blackhole.
+/// Each buffer has one YAML record at .blackhole/meta/<name>.yaml that
+/// describes how its bytes are stored.
+///
+#ifndef CAE_CATALOG_H_
+#define CAE_CATALOG_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "codec.h"
+
+namespace cae {
+
+/**
+ * Catalog record of a stored buffer
+ */
+struct BufferMeta {
+  std::string name;
+  std::string tags;
+  std::string backend;     // where the bytes live: file, shm, redis, ...
+  size_t size = 0;         // raw (uncompressed) bytes
+  size_t stored_size = 0;  // bytes held by the backend
+  FrameIndex frames;       // codec and frame offsets of the stored bytes
+  std::string digest;      // SHA256 of the buffer file, computed at put
+                           // (Merkle root of the bytes if striped)
+  uint64_t file_size = 0;  // buffer file size when digest was taken
+  int64_t mtime = 0;       // buffer file mtime (ns) when digest was taken
+  uint32_t stripes = 0;    // striped: bytes live in <name>.0 ... <name>.N-1
+  std::string stripe_of;   // set on a stripe: the striped buffer it is part of
+  // Columnar buffer ('format: csv'): one array of rows values of dtype per
+  // column, stored back to back in column order
+  std::vector<std::string> columns;
+  std::string dtype;
+  uint64_t rows = 0;
+};
+
+/**
+ * Stat a buffer file
+ * @param path Buffer file
+ * @param size File size in bytes
+ * @param mtime Modification time in nanoseconds
+ * @return true if the file exists
+ */
+bool StatBufferFile(const std::string& path, uint64_t& size, int64_t& mtime);
+
+/**
+ * Get the catalog path of a buffer
+ */
+std::string BufferMetaPath(const std::string& name);
+
+/**
+ * Write (or replace) the catalog record of a buffer
+ * @return 0 on success
+ */
+int WriteBufferMeta(const BufferMeta& meta);
+
+/**
+ * Read the catalog record of a buffer
+ * @return 0 on success, 1 if the buffer has no record, -1 on error
+ */
+int ReadBufferMeta(const std::string& name, BufferMeta& meta);
+
+}  // namespace cae
+
+#endif  // CAE_CATALOG_H_
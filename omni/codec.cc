@@ -0,0 +1,295 @@
+///
+/// codec.cc
+///
+#include "codec.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+
+namespace cae {
+
+// Runs fn(i) for every i in [0, n) on up to 'threads' workers.
+template <typename Fn>
+static void ParallelFor(size_t n, unsigned threads, Fn fn) {
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  size_t workers = std::min<size_t>(threads, n);
+  if (workers <= 1) {
+    for (size_t i = 0; i < n; ++i) {
+      fn(i);
+    }
+    return;
+  }
+  std::atomic<size_t> next(0);
+  std::vector<std::thread> pool;
+  for (size_t w = 0; w < workers; ++w) {
+    pool.emplace_back([&] {
+      for (size_t i = next++; i < n; i = next++) {
+        fn(i);
+      }
+    });
+  }
+  for (std::thread& t : pool) {
+    t.join();
+  }
+}
+
+// Raw length of frame i.
+static size_t FrameRawSize(const FrameIndex& index, size_t i) {
+  size_t start = i * index.frame_size;
+  return std::min(index.frame_size, index.raw_size - start);
+}
+
+static bool CheckIndex(const FrameIndex& index, size_t in_nbyte) {
+  if (index.frame_size == 0) {
+    std::cerr << "Error: frame size is zero" << std::endl;
+    return false;
+  }
+  size_t frames = (index.raw_size + index.frame_size - 1) / index.frame_size;
+  if (index.offsets.size() != frames + 1 || index.offsets.back() > in_nbyte) {
+    std::cerr << "Error: frame index does not match compressed buffer"
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+static bool CompressFrame(Codec codec, const unsigned char* src, size_t len,
+                          std::vector<unsigned char>& dst) {
+  switch (codec) {
+    case Codec::kNone:
+      dst.assign(src, src + len);
+      return true;
+#ifdef USE_ZSTD
+    case Codec::kZstd: {
+      dst.resize(ZSTD_compressBound(len));
+      size_t n = ZSTD_compress(dst.data(), dst.size(), src, len, 3);
+      if (ZSTD_isError(n)) {
+        std::cerr << "Error: zstd - " << ZSTD_getErrorName(n) << std::endl;
+        return false;
+      }
+      dst.resize(n);
+      return true;
+    }
+#endif
+#ifdef USE_LZ4
+    case Codec::kLz4: {
+      dst.resize(LZ4_compressBound(static_cast<int>(len)));
+      int n = LZ4_compress_default(reinterpret_cast<const char*>(src),
+                                   reinterpret_cast<char*>(dst.data()),
+                                   static_cast<int>(len),
+                                   static_cast<int>(dst.size()));
+      if (n <= 0) {
+        std::cerr << "Error: lz4 compression failed" << std::endl;
+        return false;
+      }
+      dst.resize(n);
+      return true;
+    }
+#endif
+    default:
+      std::cerr << "Error: codec '" << CodecName(codec)
+                << "' is not available in this build" << std::endl;
+      return false;
+  }
+}
+
+static bool DecompressFrame(const FrameIndex& index, const unsigned char* in,
+                            size_t i, unsigned char* dst) {
+  const unsigned char* src = in + index.offsets[i];
+  size_t len = index.offsets[i + 1] - index.offsets[i];
+  size_t raw = FrameRawSize(index, i);
+  switch (index.codec) {
+    case Codec::kNone:
+      if (len != raw) {
+        break;
+      }
+      std::memcpy(dst, src, raw);
+      return true;
+#ifdef USE_ZSTD
+    case Codec::kZstd: {
+      size_t n = ZSTD_decompress(dst, raw, src, len);
+      if (ZSTD_isError(n)) {
+        std::cerr << "Error: zstd - " << ZSTD_getErrorName(n) << std::endl;
+        return false;
+      }
+      if (n != raw) {
+        break;
+      }
+      return true;
+    }
+#endif
+#ifdef USE_LZ4
+    case Codec::kLz4: {
+      int n = LZ4_decompress_safe(reinterpret_cast<const char*>(src),
+                                  reinterpret_cast<char*>(dst),
+                                  static_cast<int>(len),
+                                  static_cast<int>(raw));
+      if (n < 0 || static_cast<size_t>(n) != raw) {
+        break;
+      }
+      return true;
+    }
+#endif
+    default:
+      std::cerr << "Error: codec '" << CodecName(index.codec)
+                << "' is not available in this build" << std::endl;
+      return false;
+  }
+  std::cerr << "Error: frame " << i << " is corrupt" << std::endl;
+  return false;
+}
+
+bool ParseCodec(const std::string& name, Codec& codec) {
+  std::string lower = name;
+  std::transform(lower.begin(), lower.end(), lower.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  if (lower.empty() || lower == "none") {
+    codec = Codec::kNone;
+  } else if (lower == "zstd") {
+    codec = Codec::kZstd;
+  } else if (lower == "lz4") {
+    codec = Codec::kLz4;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::string CodecName(Codec codec) {
+  switch (codec) {
+    case Codec::kZstd:
+      return "zstd";
+    case Codec::kLz4:
+      return "lz4";
+    default:
+      return "none";
+  }
+}
+
+bool CodecAvailable(Codec codec) {
+  switch (codec) {
+    case Codec::kNone:
+      return true;
+    case Codec::kZstd:
+#ifdef USE_ZSTD
+      return true;
+#else
+      return false;
+#endif
+    case Codec::kLz4:
+#ifdef USE_LZ4
+      return true;
+#else
+      return false;
+#endif
+  }
+  return false;
+}
+
+int CompressFrames(Codec codec, const unsigned char* data, size_t nbyte,
+                   size_t frame_size, unsigned threads,
+                   std::vector<unsigned char>& out, FrameIndex& index) {
+  if (frame_size == 0) {
+    std::cerr << "Error: frame size is zero" << std::endl;
+    return -1;
+  }
+#ifdef USE_LZ4
+  if (codec == Codec::kLz4 && frame_size > LZ4_MAX_INPUT_SIZE) {
+    std::cerr << "Error: lz4 frame size exceeds " << LZ4_MAX_INPUT_SIZE
+              << " bytes" << std::endl;
+    return -1;
+  }
+#endif
+  index = FrameIndex();
+  index.codec = codec;
+  index.frame_size = frame_size;
+  index.raw_size = nbyte;
+
+  size_t frames = (nbyte + frame_size - 1) / frame_size;
+  std::vector<std::vector<unsigned char>> parts(frames);
+  std::atomic<bool> ok(true);
+  ParallelFor(frames, threads, [&](size_t i) {
+    if (ok && !CompressFrame(codec, data + i * frame_size,
+                             FrameRawSize(index, i), parts[i])) {
+      ok = false;
+    }
+  });
+  if (!ok) {
+    return -1;
+  }
+
+  index.offsets.resize(frames + 1);
+  index.offsets[0] = 0;
+  for (size_t i = 0; i < frames; ++i) {
+    index.offsets[i + 1] = index.offsets[i] + parts[i].size();
+  }
+  out.resize(index.offsets[frames]);
+  for (size_t i = 0; i < frames; ++i) {
+    std::memcpy(out.data() + index.offsets[i], parts[i].data(),
+                parts[i].size());
+  }
+  return 0;
+}
+
+int DecompressFrames(const FrameIndex& index, const unsigned char* in,
+                     size_t in_nbyte, unsigned char* out, unsigned threads) {
+  if (!CheckIndex(index, in_nbyte)) {
+    return -1;
+  }
+  std::atomic<bool> ok(true);
+  ParallelFor(index.Frames(), threads, [&](size_t i) {
+    if (ok && !DecompressFrame(index, in, i, out + i * index.frame_size)) {
+      ok = false;
+    }
+  });
+  return ok ? 0 : -1;
+}
+
+int DecompressRange(const FrameIndex& index, const unsigned char* in,
+                    size_t in_nbyte, size_t offset, size_t nbyte,
+                    std::vector<unsigned char>& out) {
+  out.clear();
+  if (!CheckIndex(index, in_nbyte)) {
+    return -1;
+  }
+  if (offset >= index.raw_size || nbyte == 0) {
+    return 0;
+  }
+  nbyte = std::min(nbyte, index.raw_size - offset);
+
+  size_t first = offset / index.frame_size;
+  size_t last = (offset + nbyte - 1) / index.frame_size;
+  size_t span_start = first * index.frame_size;
+  size_t span_end = std::min(index.raw_size, (last + 1) * index.frame_size);
+  std::vector<unsigned char> span(span_end - span_start);
+
+  std::atomic<bool> ok(true);
+  ParallelFor(last - first + 1, 0, [&](size_t k) {
+    size_t i = first + k;
+    if (ok && !DecompressFrame(index, in, i,
+                               span.data() + k * index.frame_size)) {
+      ok = false;
+    }
+  });
+  if (!ok) {
+    return -1;
+  }
+  size_t skip = offset - span_start;
+  out.assign(span.begin() + skip, span.begin() + skip + nbyte);
+  return 0;
+}
+
+}  // namespace cae
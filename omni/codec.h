@@ -0,0 +1,99 @@
+///
+/// codec.h
+///
+/// Framed buffer compression. A buffer is cut into fixed-size raw frames
+/// that are compressed independently, so frames can be (de)compressed in
+/// parallel and any byte range can be decoded without touching the rest.
+///
+#ifndef CAE_CODEC_H_
+#define CAE_CODEC_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cae {
+
+/**
+ * Enumeration of supported codecs
+ */
+enum class Codec { kNone, kZstd, kLz4 };
+
+/** Default raw bytes per frame */
+constexpr size_t kDefaultFrameSize = 1 << 20;
+
+/**
+ * Location of every compressed frame of a buffer
+ */
+struct FrameIndex {
+  Codec codec = Codec::kNone;
+  size_t frame_size = kDefaultFrameSize;  // raw bytes per frame (last may be short)
+  size_t raw_size = 0;                    // total uncompressed bytes
+  std::vector<uint64_t> offsets;          // compressed offset of each frame, plus the end
+
+  size_t Frames() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+};
+
+/**
+ * Parse a codec name ("none", "zstd", "lz4")
+ * @param name Codec name, case insensitive
+ * @param codec Parsed codec
+ * @return true if the name is known
+ */
+bool ParseCodec(const std::string& name, Codec& codec);
+
+/**
+ * Get the catalog name of a codec
+ */
+std::string CodecName(Codec codec);
+
+/**
+ * Check whether a codec was compiled into this build
+ */
+bool CodecAvailable(Codec codec);
+
+/**
+ * Compress a buffer into independent frames
+ * @param codec Codec to use
+ * @param data Raw bytes
+ * @param nbyte Number of raw bytes
+ * @param frame_size Raw bytes per frame
+ * @param threads Worker threads (0 = hardware concurrency)
+ * @param out Concatenated compressed frames
+ * @param index Frame index describing out
+ * @return 0 on success
+ */
+int CompressFrames(Codec codec, const unsigned char* data, size_t nbyte,
+                   size_t frame_size, unsigned threads,
+                   std::vector<unsigned char>& out, FrameIndex& index);
+
+/**
+ * Decompress every frame in parallel
+ * @param index Frame index of the compressed buffer
+ * @param in Compressed frames
+ * @param in_nbyte Number of compressed bytes
+ * @param out Destination of index.raw_size bytes
+ * @param threads Worker threads (0 = hardware concurrency)
+ * @return 0 on success
+ */
+int DecompressFrames(const FrameIndex& index, const unsigned char* in,
+                     size_t in_nbyte, unsigned char* out, unsigned threads);
+
+/**
+ * Decompress only the frames covering a raw byte range
+ * @param index Frame index of the compressed buffer
+ * @param in Compressed frames
+ * @param in_nbyte Number of compressed bytes
+ * @param offset First raw byte
+ * @param nbyte Number of raw bytes, clipped to the buffer end
+ * @param out Decoded bytes of the range
+ * @return 0 on success
+ */
+int DecompressRange(const FrameIndex& index, const unsigned char* in,
+                    size_t in_nbyte, size_t offset, size_t nbyte,
+                    std::vector<unsigned char>& out);
+
+}  // namespace cae
+
+#endif  // CAE_CODEC_H_
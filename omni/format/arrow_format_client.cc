@@ -0,0 +1,255 @@
+#include "arrow_format_client.h"
+
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/reader.h>
+#include <parquet/arrow/reader.h>
+#include <parquet/properties.h>
+
+#include <iostream>
+#include <limits>
+#include <memory>
+
+namespace cae {
+
+namespace {
+
+template <typename ArrayType>
+void AppendValues(const arrow::Array &array, std::vector<double> &out) {
+  const ArrayType &typed = static_cast<const ArrayType &>(array);
+  for (int64_t i = 0; i < typed.length(); ++i) {
+    out.push_back(typed.IsNull(i) ? std::numeric_limits<double>::quiet_NaN()
+                                  : static_cast<double>(typed.Value(i)));
+  }
+}
+
+// Widen one numeric column to float64; false if it is not numeric
+bool AppendColumn(const arrow::ChunkedArray &column,
+                  std::vector<double> &out) {
+  out.reserve(out.size() + static_cast<size_t>(column.length()));
+  for (const std::shared_ptr<arrow::Array> &chunk : column.chunks()) {
+    switch (chunk->type_id()) {
+    case arrow::Type::DOUBLE:
+      AppendValues<arrow::DoubleArray>(*chunk, out);
+      break;
+    case arrow::Type::FLOAT:
+      AppendValues<arrow::FloatArray>(*chunk, out);
+      break;
+    case arrow::Type::INT8:
+      AppendValues<arrow::Int8Array>(*chunk, out);
+      break;
+    case arrow::Type::INT16:
+      AppendValues<arrow::Int16Array>(*chunk, out);
+      break;
+    case arrow::Type::INT32:
+      AppendValues<arrow::Int32Array>(*chunk, out);
+      break;
+    case arrow::Type::INT64:
+      AppendValues<arrow::Int64Array>(*chunk, out);
+      break;
+    case arrow::Type::UINT8:
+      AppendValues<arrow::UInt8Array>(*chunk, out);
+      break;
+    case arrow::Type::UINT16:
+      AppendValues<arrow::UInt16Array>(*chunk, out);
+      break;
+    case arrow::Type::UINT32:
+      AppendValues<arrow::UInt32Array>(*chunk, out);
+      break;
+    case arrow::Type::UINT64:
+      AppendValues<arrow::UInt64Array>(*chunk, out);
+      break;
+    default:
+      return false;
+    }
+  }
+  return true;
+}
+
+// Field indices of the requested columns (all if none are named). For the
+// flat schemas of numeric tables these are also the Parquet leaf indices.
+bool Project(const arrow::Schema &schema,
+             const std::vector<std::string> &names, std::vector<int> &indices,
+             std::string &error) {
+  indices.clear();
+  if (names.empty()) {
+    for (int i = 0; i < schema.num_fields(); ++i) {
+      indices.push_back(i);
+    }
+    return true;
+  }
+  for (const std::string &name : names) {
+    int i = schema.GetFieldIndex(name);
+    if (i < 0) {
+      error = "no column '" + name + "'";
+      return false;
+    }
+    indices.push_back(i);
+  }
+  return true;
+}
+
+// Row groups (or record batches) to read out of count
+bool SelectGroups(const std::vector<int> &requested, int count,
+                  std::vector<int> &groups, std::string &error) {
+  groups.clear();
+  if (requested.empty()) {
+    for (int i = 0; i < count; ++i) {
+      groups.push_back(i);
+    }
+    return true;
+  }
+  for (int group : requested) {
+    if (group < 0 || group >= count) {
+      error = "row group " + std::to_string(group) + " is out of range (" +
+              std::to_string(count) + " in file)";
+      return false;
+    }
+    groups.push_back(group);
+  }
+  return true;
+}
+
+int ToColumns(const arrow::Table &in, ColumnTable &table, std::string &error) {
+  table = ColumnTable();
+  table.rows = static_cast<size_t>(in.num_rows());
+  for (int i = 0; i < in.num_columns(); ++i) {
+    const std::shared_ptr<arrow::Field> &field = in.schema()->field(i);
+    table.names.push_back(field->name());
+    table.columns.emplace_back();
+    if (!AppendColumn(*in.column(i), table.columns.back())) {
+      error = "column '" + field->name() + "' is not numeric (" +
+              field->type()->ToString() + ")";
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int ReadParquet(const std::string &path, const ColumnProjection &projection,
+                std::shared_ptr<arrow::Table> &out, std::string &error) {
+  arrow::Result<std::shared_ptr<arrow::io::ReadableFile>> file =
+      arrow::io::ReadableFile::Open(path);
+  if (!file.ok()) {
+    error = file.status().ToString();
+    return 1;
+  }
+
+  // Column chunks are decoded on Arrow's thread pool, and the reads of the
+  // selected chunks are issued together up front
+  parquet::ArrowReaderProperties properties;
+  properties.set_use_threads(true);
+  properties.set_pre_buffer(true);
+  parquet::arrow::FileReaderBuilder builder;
+  std::unique_ptr<parquet::arrow::FileReader> reader;
+  arrow::Status status = builder.Open(*file);
+  if (status.ok()) {
+    status = builder.properties(properties)->Build(&reader);
+  }
+  std::shared_ptr<arrow::Schema> schema;
+  if (status.ok()) {
+    status = reader->GetSchema(&schema);
+  }
+  if (!status.ok()) {
+    error = status.ToString();
+    return 1;
+  }
+
+  std::vector<int> indices;
+  std::vector<int> groups;
+  if (!Project(*schema, projection.columns, indices, error) ||
+      !SelectGroups(projection.row_groups, reader->num_row_groups(), groups,
+                    error)) {
+    return 1;
+  }
+  status = reader->ReadRowGroups(groups, indices, &out);
+  if (!status.ok()) {
+    error = status.ToString();
+    return 1;
+  }
+  return 0;
+}
+
+int ReadFeather(const std::string &path, const ColumnProjection &projection,
+                std::shared_ptr<arrow::Table> &out, std::string &error) {
+  arrow::Result<std::shared_ptr<arrow::io::MemoryMappedFile>> file =
+      arrow::io::MemoryMappedFile::Open(path, arrow::io::FileMode::READ);
+  if (!file.ok()) {
+    error = file.status().ToString();
+    return 1;
+  }
+
+  // The footer gives the schema; reopen with only the projected fields so
+  // the other columns' buffers are never touched
+  arrow::ipc::IpcReadOptions options = arrow::ipc::IpcReadOptions::Defaults();
+  options.use_threads = true;
+  auto footer = arrow::ipc::RecordBatchFileReader::Open(*file, options);
+  if (!footer.ok()) {
+    error = footer.status().ToString() + " (Feather v1 files are not read)";
+    return 1;
+  }
+  std::vector<int> indices;
+  std::vector<int> batches;
+  if (!Project(*(*footer)->schema(), projection.columns, indices, error) ||
+      !SelectGroups(projection.row_groups, (*footer)->num_record_batches(),
+                    batches, error)) {
+    return 1;
+  }
+  options.included_fields = indices;
+  auto reader = arrow::ipc::RecordBatchFileReader::Open(*file, options);
+  if (!reader.ok()) {
+    error = reader.status().ToString();
+    return 1;
+  }
+
+  std::vector<std::shared_ptr<arrow::RecordBatch>> selected;
+  for (int i : batches) {
+    arrow::Result<std::shared_ptr<arrow::RecordBatch>> batch =
+        (*reader)->ReadRecordBatch(i);
+    if (!batch.ok()) {
+      error = batch.status().ToString();
+      return 1;
+    }
+    selected.push_back(*batch);
+  }
+  arrow::Result<std::shared_ptr<arrow::Table>> table =
+      arrow::Table::FromRecordBatches((*reader)->schema(), selected);
+  if (!table.ok()) {
+    error = table.status().ToString();
+    return 1;
+  }
+  out = *table;
+  return 0;
+}
+
+} // namespace
+
+std::string ArrowFormatClient::Describe(const FormatContext &ctx) {
+  return std::string(kind_ == Kind::kParquet ? "Parquet" : "Feather") +
+         " file: " + ctx.filename_;
+}
+
+void ArrowFormatClient::Import(const FormatContext &ctx) {
+  std::string error;
+  if (Read(ctx.filename_, table_, error) != 0) {
+    std::cerr << "Error: " << ctx.filename_ << ": " << error << std::endl;
+    return;
+  }
+  std::cout << "Read " << table_.rows << " rows x " << table_.columns.size()
+            << " columns" << std::endl;
+}
+
+int ArrowFormatClient::Read(const std::string &path, ColumnTable &table,
+                            std::string &error) const {
+  table = ColumnTable();
+  std::shared_ptr<arrow::Table> columns;
+  int rc = kind_ == Kind::kParquet
+               ? ReadParquet(path, projection_, columns, error)
+               : ReadFeather(path, projection_, columns, error);
+  if (rc != 0) {
+    return rc;
+  }
+  return ToColumns(*columns, table, error);
+}
+
+} // namespace cae
@@ -0,0 +1,70 @@
+#ifndef CAE_FORMAT_ARROW_FORMAT_CLIENT_H_
+#define CAE_FORMAT_ARROW_FORMAT_CLIENT_H_
+
+#include "column_table.h"
+#include "format_client.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Parquet and Feather Processing Strategy:
+ *
+ * 1. Footer first: the Parquet footer (or the Arrow IPC footer of a Feather
+ *    v2 file) lists every column chunk and record batch with its offset, so
+ *    only the projected columns of the selected row groups are read
+ * 2. Parallel decode: Arrow decodes the selected column chunks on its CPU
+ *    thread pool; Feather files are memory-mapped and decoded the same way
+ * 3. Layout: numeric columns of any width are widened to float64 with
+ *    nulls as NaN, giving the same ColumnTable as the CSV client
+ */
+
+namespace cae {
+
+/**
+ * Columns and row groups to read; empty means all of them
+ */
+struct ColumnProjection {
+  std::vector<std::string> columns;
+  std::vector<int> row_groups;  // Parquet row groups / Feather record batches
+};
+
+/**
+ * Parquet and Arrow IPC (Feather v2) format client
+ */
+class ArrowFormatClient : public FormatClient {
+public:
+  enum class Kind { kParquet, kFeather };
+
+  explicit ArrowFormatClient(Kind kind,
+                             ColumnProjection projection = ColumnProjection())
+      : kind_(kind), projection_(std::move(projection)) {}
+  ~ArrowFormatClient() override = default;
+
+  /** Describe the file */
+  std::string Describe(const FormatContext &ctx) override;
+
+  /** Read the projected columns of the file */
+  void Import(const FormatContext &ctx) override;
+
+  /**
+   * Read the projected columns of a file
+   * @param error Set to the reason on failure
+   * @return 0 on success, 1 if the file cannot be read, a column does not
+   *         exist or is not numeric, or a row group is out of range
+   */
+  int Read(const std::string &path, ColumnTable &table,
+           std::string &error) const;
+
+  /** Columns of the last Import */
+  const ColumnTable &Table() const { return table_; }
+
+private:
+  Kind kind_;
+  ColumnProjection projection_;
+  ColumnTable table_;
+};
+
+} // namespace cae
+
+#endif // CAE_FORMAT_ARROW_FORMAT_CLIENT_H_
@@ -94,12 +94,8 @@ public:
       total_read += bytes_read;
       remaining -= bytes_read;
 
-      // Process the chunk (for now, just report progress)
-      std::cout << "Read chunk: " << bytes_read
-                << " bytes (total: " << total_read << "/" << ctx.size_ << ")"
-                << std::endl;
-
-      // Call progress callback
+      // Progress goes to the callback only: a line per chunk from every
+      // rank serializes on the launcher's stdout
       OnChunkProcessed(total_read);
     }
 
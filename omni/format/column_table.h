@@ -0,0 +1,70 @@
+#ifndef CAE_FORMAT_COLUMN_TABLE_H_
+#define CAE_FORMAT_COLUMN_TABLE_H_
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cae {
+
+/**
+ * Numeric columns decoded by a format client (CSV, Parquet, Feather)
+ */
+struct ColumnTable {
+  std::vector<std::string> names;
+  std::vector<std::vector<double>> columns;  // one array per column
+  size_t rows = 0;
+};
+
+/** Element type of packed columns */
+constexpr const char *kColumnDtype = "f64";
+
+/**
+ * Pack the columns back to back as native float64 (column-major), the
+ * layout OMNI stores for a 'format' descriptor
+ */
+inline void PackColumns(const ColumnTable &table,
+                        std::vector<unsigned char> &bytes) {
+  size_t column_nbyte = table.rows * sizeof(double);
+  bytes.resize(column_nbyte * table.columns.size());
+  for (size_t i = 0; i < table.columns.size(); ++i) {
+    if (column_nbyte > 0) {
+      std::memcpy(bytes.data() + i * column_nbyte, table.columns[i].data(),
+                  column_nbyte);
+    }
+  }
+}
+
+/**
+ * Keep only the named columns, in the order given (all if none are named)
+ * @param error Set to the reason on failure
+ * @return false if a name is not a column of the table
+ */
+inline bool SelectColumns(const std::vector<std::string> &names,
+                          ColumnTable &table, std::string &error) {
+  if (names.empty()) {
+    return true;
+  }
+  ColumnTable selected;
+  selected.rows = table.rows;
+  for (const std::string &name : names) {
+    size_t i = 0;
+    while (i < table.names.size() && table.names[i] != name) {
+      ++i;
+    }
+    if (i == table.names.size()) {
+      error = "no column '" + name + "'";
+      return false;
+    }
+    selected.names.push_back(name);
+    selected.columns.push_back(table.columns[i]);
+  }
+  table = std::move(selected);
+  return true;
+}
+
+} // namespace cae
+
+#endif // CAE_FORMAT_COLUMN_TABLE_H_
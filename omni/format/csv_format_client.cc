@@ -0,0 +1,331 @@
+#include "csv_format_client.h"
+#include "record_splitter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <thread>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace cae {
+
+namespace {
+
+// Next delimiter or newline in [p, end), or end
+const char *NextStructural(const char *p, const char *end, char delimiter) {
+#ifdef __SSE2__
+  const __m128i delims = _mm_set1_epi8(delimiter);
+  const __m128i newlines = _mm_set1_epi8('\n');
+  while (end - p >= 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    int mask = _mm_movemask_epi8(
+        _mm_or_si128(_mm_cmpeq_epi8(v, delims), _mm_cmpeq_epi8(v, newlines)));
+    if (mask != 0) {
+      return p + __builtin_ctz(static_cast<unsigned>(mask));
+    }
+    p += 16;
+  }
+#endif
+  while (p < end && *p != delimiter && *p != '\n') {
+    ++p;
+  }
+  return p;
+}
+
+// Field text without surrounding blanks, '\r' or quotes
+void Trim(const char *&begin, const char *&end) {
+  while (begin < end && (*begin == ' ' || *begin == '\t')) {
+    ++begin;
+  }
+  while (end > begin &&
+         (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) {
+    --end;
+  }
+  if (end - begin >= 2 && *begin == '"' && end[-1] == '"') {
+    ++begin;
+    --end;
+  }
+}
+
+bool ParseNumber(const char *begin, const char *end, double &value) {
+  if (begin == end) {
+    value = std::numeric_limits<double>::quiet_NaN();
+    return true;
+  }
+  if (*begin == '+') {
+    ++begin;
+  }
+  // Fast path for plain decimals: up to 15 digits are exact in a double, as
+  // is 10^places, so one correctly rounded division gives the nearest
+  // double (Clinger)
+  static const double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                  1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                  1e18, 1e19, 1e20, 1e21, 1e22};
+  const char *p = begin;
+  bool negative = *p == '-';
+  p += negative;
+  uint64_t digits = 0;
+  int ndigit = 0;
+  int places = -1;
+  for (; p < end; ++p) {
+    if (*p >= '0' && *p <= '9') {
+      digits = digits * 10 + static_cast<uint64_t>(*p - '0');
+      ++ndigit;
+      places += places >= 0;
+    } else if (*p == '.' && places < 0) {
+      places = 0;
+    } else {
+      break;
+    }
+  }
+  if (p == end && ndigit > 0 && ndigit <= 15 && places <= 22) {
+    double v = static_cast<double>(digits);
+    v = places > 0 ? v / kPow10[places] : v;
+    value = negative ? -v : v;
+    return true;
+  }
+#ifdef __cpp_lib_to_chars
+  std::from_chars_result r = std::from_chars(begin, end, value);
+  return r.ec == std::errc() && r.ptr == end;
+#else
+  // No floating-point from_chars (Apple libc++): strtod on a terminated
+  // copy, without the leading space and sign strtod would also accept
+  if (std::isspace(static_cast<unsigned char>(*begin)) || *begin == '+') {
+    return false;
+  }
+  std::string text(begin, end);
+  char *stop = nullptr;
+  errno = 0;
+  double v = std::strtod(text.c_str(), &stop);
+  if (stop != text.c_str() + text.size() || errno == ERANGE) {
+    return false;
+  }
+  value = v;
+  return true;
+#endif
+}
+
+// Fields in the first record that is not blank, or 0 if there is none
+size_t CountColumns(const char *data, size_t nbyte, char delimiter) {
+  const char *p = data;
+  const char *end = data + nbyte;
+  while (p < end) {
+    size_t fields = 1;
+    bool blank = true;
+    for (; p < end && *p != '\n'; ++p) {
+      fields += *p == delimiter;
+      blank = blank && (*p == ' ' || *p == '\t' || *p == '\r');
+    }
+    p += p < end;
+    if (!blank || fields > 1) {
+      return fields;
+    }
+  }
+  return 0;
+}
+
+// Parse the records of one chunk into ncolumns columns. Line numbers in
+// errors count from first_line.
+int ParseRecords(const char *data, size_t nbyte, char delimiter, bool header,
+                 size_t ncolumns, size_t first_line, ColumnTable &table,
+                 std::string &error) {
+  table = ColumnTable();
+  table.columns.resize(ncolumns);
+  const char *p = data;
+  const char *end = data + nbyte;
+  std::vector<double> row;
+  std::vector<std::string> names;
+  size_t line = first_line;
+  bool first = true;
+  bool reserved = false;
+  while (p < end) {
+    const char *record = p;
+    ++line;
+    row.clear();
+    names.clear();
+    bool numeric = true;
+    bool eol = false;
+    while (!eol) {
+      const char *stop = NextStructural(p, end, delimiter);
+      const char *begin = p;
+      const char *field_end = stop;
+      Trim(begin, field_end);
+      double value = 0.0;
+      if (!ParseNumber(begin, field_end, value)) {
+        numeric = false;
+      }
+      row.push_back(value);
+      if (first && header) {
+        names.emplace_back(begin, field_end);
+      }
+      eol = stop == end || *stop == '\n';
+      p = stop == end ? end : stop + 1;
+    }
+    // Blank lines are not records
+    if (row.size() == 1 && std::isnan(row[0])) {
+      continue;
+    }
+    bool was_first = first;
+    first = false;
+    if (was_first && header && !numeric && names.size() == ncolumns) {
+      table.names = names;
+      continue;
+    }
+    if (!numeric) {
+      error = "line " + std::to_string(line) + " has a field that is not a "
+              "number";
+      return 1;
+    }
+    if (row.size() != ncolumns) {
+      error = "line " + std::to_string(line) + " has " +
+              std::to_string(row.size()) + " fields, expected " +
+              std::to_string(ncolumns);
+      return 1;
+    }
+    if (!reserved) {
+      // Size the columns from the first row; growing them by doubling
+      // copies and touches every value again
+      size_t rows = nbyte / static_cast<size_t>(p - record) + 1;
+      for (std::vector<double> &column : table.columns) {
+        column.reserve(rows);
+      }
+      reserved = true;
+    }
+    for (size_t i = 0; i < ncolumns; ++i) {
+      table.columns[i].push_back(row[i]);
+    }
+    ++table.rows;
+  }
+  return 0;
+}
+
+} // namespace
+
+std::string CsvFormatClient::Describe(const FormatContext &ctx) {
+  return "CSV file: " + ctx.filename_ +
+         " (size: " + std::to_string(ctx.size_) +
+         " bytes, offset: " + std::to_string(ctx.offset_) + ")";
+}
+
+void CsvFormatClient::Import(const FormatContext &ctx) {
+  table_ = ColumnTable();
+  RecordOptions options;
+  options.quote = '"';
+  RecordRange range;
+  if (AlignToRecords(ctx.filename_, ctx.offset_, ctx.size_, options, range) !=
+      0) {
+    return;
+  }
+  std::vector<char> text(range.nbyte);
+  FILE *file = fopen(ctx.filename_.c_str(), "rb");
+  if (!file) {
+    std::cerr << "Error: Failed to open file " << ctx.filename_ << std::endl;
+    return;
+  }
+  bool read = fseek(file, (long)range.offset, SEEK_SET) == 0 &&
+              fread(text.data(), 1, text.size(), file) == text.size();
+  fclose(file);
+  if (!read) {
+    std::cerr << "Error: Failed to read " << range.nbyte << " bytes at "
+              << range.offset << " from " << ctx.filename_ << std::endl;
+    return;
+  }
+
+  std::string error;
+  if (Parse(text.data(), text.size(), range.offset == 0, table_, error) != 0) {
+    std::cerr << "Error: " << ctx.filename_ << ": " << error << std::endl;
+    return;
+  }
+  std::cout << "Parsed " << table_.rows << " rows x " << table_.columns.size()
+            << " columns" << std::endl;
+}
+
+int CsvFormatClient::Parse(const char *data, size_t nbyte, bool header,
+                           ColumnTable &table, std::string &error) const {
+  table = ColumnTable();
+  size_t ncolumns = CountColumns(data, nbyte, delimiter_);
+  if (ncolumns == 0) {
+    return 0;
+  }
+
+  // Newline-aligned chunks parsed on all cores, then joined in order
+  unsigned threads = threads_;
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  size_t chunks = std::max<size_t>(1, std::min<size_t>(threads,
+                                                       nbyte / kMinChunk));
+  std::vector<const char *> bounds(1, data);
+  const char *end = data + nbyte;
+  for (size_t i = 1; i < chunks; ++i) {
+    const char *at = std::max(bounds.back(), data + nbyte / chunks * i);
+    const void *nl = std::memchr(at, '\n', static_cast<size_t>(end - at));
+    bounds.push_back(nl ? static_cast<const char *>(nl) + 1 : end);
+  }
+  bounds.push_back(end);
+
+  std::vector<ColumnTable> parts(chunks);
+  std::vector<int> results(chunks, 0);
+  std::vector<std::string> errors(chunks);
+  auto parse = [&](size_t i) {
+    results[i] = ParseRecords(bounds[i], bounds[i + 1] - bounds[i],
+                              delimiter_, header && i == 0, ncolumns, 0,
+                              parts[i], errors[i]);
+  };
+  std::vector<std::thread> pool;
+  for (size_t i = 1; i < chunks; ++i) {
+    pool.emplace_back(parse, i);
+  }
+  parse(0);
+  for (std::thread &t : pool) {
+    t.join();
+  }
+
+  for (size_t i = 0; i < chunks; ++i) {
+    if (results[i] != 0) {
+      // Parse the failing chunk again to report the line in the whole text
+      size_t first_line = CountByte(data, bounds[i] - data, '\n');
+      ColumnTable scratch;
+      ParseRecords(bounds[i], bounds[i + 1] - bounds[i], delimiter_,
+                   header && i == 0, ncolumns, first_line, scratch, error);
+      return 1;
+    }
+  }
+  if (chunks == 1) {
+    table = std::move(parts[0]);
+  } else {
+    table.names = parts[0].names;
+    table.columns.resize(ncolumns);
+    for (const ColumnTable &part : parts) {
+      table.rows += part.rows;
+    }
+    for (size_t c = 0; c < ncolumns; ++c) {
+      table.columns[c].reserve(table.rows);
+      for (const ColumnTable &part : parts) {
+        table.columns[c].insert(table.columns[c].end(),
+                                part.columns[c].begin(),
+                                part.columns[c].end());
+      }
+    }
+  }
+  if (table.names.empty()) {
+    for (size_t c = 0; c < ncolumns; ++c) {
+      table.names.push_back("c" + std::to_string(c));
+    }
+  }
+  return 0;
+}
+
+} // namespace cae
@@ -0,0 +1,70 @@
+#ifndef CAE_FORMAT_CSV_FORMAT_CLIENT_H_
+#define CAE_FORMAT_CSV_FORMAT_CLIENT_H_
+
+#include "column_table.h"
+#include "format_client.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * Numeric CSV Processing Strategy:
+ *
+ * 1. Structure: an SSE2 scan finds the next delimiter or newline 16 bytes
+ *    at a time, so field boundaries cost one compare per block. Large
+ *    inputs are cut at newlines and the pieces parsed on all cores
+ * 2. Values: plain decimals of up to 15 digits take an exact fast path;
+ *    anything else goes to std::from_chars (no locale, no allocation). An
+ *    empty field is NaN
+ * 3. Layout: values go straight into one contiguous float64 array per
+ *    column (see column_table.h)
+ * 4. Header: if the first record of the file is not all numbers it names
+ *    the columns; otherwise they are named c0, c1, ...
+ */
+
+namespace cae {
+
+/**
+ * Numeric CSV format client: parses delimited numbers into columns
+ */
+class CsvFormatClient : public FormatClient {
+public:
+  /** Smallest piece of text given to one parsing thread */
+  static constexpr size_t kMinChunk = 4 << 20;
+
+  /**
+   * @param delimiter Field separator
+   * @param threads Parsing threads (0 = hardware concurrency)
+   */
+  explicit CsvFormatClient(char delimiter = ',', unsigned threads = 0)
+      : delimiter_(delimiter), threads_(threads) {}
+  ~CsvFormatClient() override = default;
+
+  /** Describe the file */
+  std::string Describe(const FormatContext &ctx) override;
+
+  /** Parse the whole records of the requested range into columns */
+  void Import(const FormatContext &ctx) override;
+
+  /**
+   * Parse CSV text into columns
+   * @param header The first record may be a header (the range starts the
+   *               file)
+   * @param error Set to the reason on failure
+   * @return 0 on success, 1 on a non-numeric field or a ragged row
+   */
+  int Parse(const char *data, size_t nbyte, bool header, ColumnTable &table,
+            std::string &error) const;
+
+  /** Columns of the last Import */
+  const ColumnTable &Table() const { return table_; }
+
+private:
+  char delimiter_;
+  unsigned threads_;
+  ColumnTable table_;
+};
+
+} // namespace cae
+
+#endif // CAE_FORMAT_CSV_FORMAT_CLIENT_H_
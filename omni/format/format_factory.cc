@@ -1,22 +1,112 @@
 #include "format_factory.h"
 #include "binary_file_omni.h"
+#include "csv_format_client.h"
+#include "lines_file_omni.h"
 #ifdef  USE_HDF5
 #include "hdf5_dataset_client.h"
 #endif
+#ifdef USE_ARROW
+#include "arrow_format_client.h"
+#endif
 #include <algorithm>
 #include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
 #include <stdexcept>
+#include <unordered_map>
 
 namespace cae {
 
+namespace {
+
+// Detected formats by path; an entry is valid while size and mtime match
+struct SniffEntry {
+  uintmax_t size;
+  std::filesystem::file_time_type mtime;
+  Format format;
+};
+std::mutex sniff_mutex;
+std::unordered_map<std::string, SniffEntry> sniff_cache;
+
+bool HasPrefix(const unsigned char *head, size_t n, const char *magic,
+               size_t len, size_t at = 0) {
+  return n >= at + len && std::memcmp(head + at, magic, len) == 0;
+}
+
+// Number-like field: digits, sign, point, exponent, blanks or quotes
+bool NumericField(const unsigned char *p, const unsigned char *end) {
+  for (; p < end; ++p) {
+    if (!std::isdigit(*p) && std::strchr("+-.eE \t\r\"", *p) == nullptr) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// A header of complete records whose rows are numeric with a constant
+// number of commas; the first record may be a header of names
+bool LooksLikeCsv(const unsigned char *head, size_t n, bool truncated) {
+  const unsigned char *p = head;
+  const unsigned char *end = head + n;
+  size_t fields = 0;
+  size_t records = 0;
+  while (p < end) {
+    const unsigned char *eol =
+        static_cast<const unsigned char *>(std::memchr(p, '\n', end - p));
+    if (eol == nullptr) {
+      if (truncated) {
+        break;  // the last record is cut off by the sniff size
+      }
+      eol = end;
+    }
+    size_t count = 1;
+    bool numeric = true;
+    const unsigned char *field = p;
+    for (const unsigned char *q = p; q <= eol; ++q) {
+      if (q == eol || *q == ',') {
+        numeric = numeric && NumericField(field, q);
+        field = q + 1;
+        count += q < eol;
+      }
+    }
+    bool blank = eol - p <= 1 && (eol == p || *p == '\r');
+    if (!blank) {
+      if (records == 0) {
+        fields = count;
+      } else if (count != fields || !numeric) {
+        return false;
+      }
+      ++records;
+    }
+    p = eol + 1;
+  }
+  return fields > 1 && records > 1;
+}
+
+} // namespace
+
 std::unique_ptr<FormatClient> FormatFactory::Get(Format format) {
   switch (format) {
   case Format::kPosix:
   case Format::kBinary:
+  case Format::kGzip:  // stored as the compressed bytes
+  case Format::kZstd:
     return std::make_unique<BinaryFileOmni>();
+  case Format::kLines:
+    return std::make_unique<LinesFileOmni>();
+  case Format::kCsv:
+    return std::make_unique<CsvFormatClient>();
 #ifdef  USE_HDF5    
   case Format::kHDF5:
     return std::make_unique<Hdf5DatasetClient>();
+#endif
+#ifdef USE_ARROW
+  case Format::kParquet:
+    return std::make_unique<ArrowFormatClient>(ArrowFormatClient::Kind::kParquet);
+  case Format::kFeather:
+    return std::make_unique<ArrowFormatClient>(ArrowFormatClient::Kind::kFeather);
 #endif
   default:
     throw std::runtime_error("Unknown format type");
@@ -31,11 +121,145 @@ FormatFactory::Get(const std::string &format_str) {
 
   if (lower_format == "posix" || lower_format == "binary") {
     return Get(Format::kPosix);
+  } else if (lower_format == "lines") {
+    return Get(Format::kLines);
+  } else if (lower_format == "csv") {
+    return Get(Format::kCsv);
   } else if (lower_format == "hdf5") {
     return Get(Format::kHDF5);
+  } else if (lower_format == "parquet") {
+    return Get(Format::kParquet);
+  } else if (lower_format == "feather" || lower_format == "arrow") {
+    return Get(Format::kFeather);
+  } else if (lower_format == "gzip") {
+    return Get(Format::kGzip);
+  } else if (lower_format == "zstd") {
+    return Get(Format::kZstd);
   } else {
     throw std::runtime_error("Unknown format string: " + format_str);
   }
 }
 
+Format FormatFactory::Sniff(const unsigned char *head, size_t n) {
+  // HDF5 files may start with a user block of 512 bytes or a power of two
+  for (size_t at : {0, 512, 1024, 2048}) {
+    if (HasPrefix(head, n, "\x89HDF\r\n\x1a\n", 8, at)) {
+      return Format::kHDF5;
+    }
+  }
+  if (HasPrefix(head, n, "PAR1", 4)) {
+    return Format::kParquet;
+  }
+  if (HasPrefix(head, n, "ARROW1", 6)) {
+    return Format::kFeather;
+  }
+  if (HasPrefix(head, n, "\x1f\x8b", 2)) {
+    return Format::kGzip;
+  }
+  if (HasPrefix(head, n, "\x28\xb5\x2f\xfd", 4)) {
+    return Format::kZstd;
+  }
+
+  // Text: no NUL or other control bytes, and at least one record
+  bool text = n > 0;
+  for (size_t i = 0; i < n && text; ++i) {
+    text = head[i] >= 0x20 || head[i] == '\n' || head[i] == '\r' ||
+           head[i] == '\t';
+  }
+  if (!text || std::memchr(head, '\n', n) == nullptr) {
+    return Format::kBinary;
+  }
+  return LooksLikeCsv(head, n, n >= kSniffBytes) ? Format::kCsv
+                                                   : Format::kLines;
+}
+
+bool FormatFactory::DetectFormat(const std::string &path, Format &format) {
+  namespace fs = std::filesystem;
+  // Only regular files are sniffed; a directory has no size to key on
+  std::error_code ec;
+  if (!fs::is_regular_file(path, ec)) {
+    return false;
+  }
+  uintmax_t size = fs::file_size(path, ec);
+  if (ec) {
+    return false;
+  }
+  fs::file_time_type mtime = fs::last_write_time(path, ec);
+  if (ec) {
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(sniff_mutex);
+    auto it = sniff_cache.find(path);
+    if (it != sniff_cache.end() && it->second.size == size &&
+        it->second.mtime == mtime) {
+      format = it->second.format;
+      return true;
+    }
+  }
+
+  unsigned char head[kSniffBytes];
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  file.read(reinterpret_cast<char *>(head), sizeof(head));
+  format = Sniff(head, static_cast<size_t>(file.gcount()));
+
+  std::lock_guard<std::mutex> lock(sniff_mutex);
+  sniff_cache[path] = SniffEntry{size, mtime, format};
+  return true;
+}
+
+std::unique_ptr<FormatClient> FormatFactory::Detect(const std::string &path) {
+  Format format;
+  if (!DetectFormat(path, format)) {
+    return nullptr;
+  }
+  return Get(Available(format) ? format : Format::kBinary);
+}
+
+bool FormatFactory::Available(Format format) {
+  switch (format) {
+  case Format::kHDF5:
+#ifdef USE_HDF5
+    return true;
+#else
+    return false;
+#endif
+  case Format::kParquet:
+  case Format::kFeather:
+#ifdef USE_ARROW
+    return true;
+#else
+    return false;
+#endif
+  default:
+    return true;
+  }
+}
+
+std::string FormatFactory::Name(Format format) {
+  switch (format) {
+  case Format::kPosix:
+    return "posix";
+  case Format::kHDF5:
+    return "hdf5";
+  case Format::kLines:
+    return "lines";
+  case Format::kCsv:
+    return "csv";
+  case Format::kParquet:
+    return "parquet";
+  case Format::kFeather:
+    return "feather";
+  case Format::kGzip:
+    return "gzip";
+  case Format::kZstd:
+    return "zstd";
+  default:
+    return "binary";
+  }
+}
+
 } // namespace cae
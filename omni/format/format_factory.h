@@ -2,20 +2,47 @@
 #define CAE_FORMAT_FORMAT_FACTORY_H_
 
 #include "format_client.h"
+#include <cstddef>
 #include <memory>
+#include <string>
+
+/**
+ * Format Detection Strategy:
+ *
+ * 1. Magic bytes: the first kSniffBytes of a file are read once and checked
+ *    for the HDF5 superblock signature (at 0, 512, 1024 or 2048), PAR1,
+ *    ARROW1, gzip and zstd frames
+ * 2. Text: a header with no NUL bytes and at least one newline is CSV if
+ *    its first records have the same number of commas, otherwise lines
+ * 3. Cache: results are kept per path with the file's size and mtime, so
+ *    wildcard jobs and repeated puts do not re-open unchanged files
+ */
 
 namespace cae {
 
 /**
  * Enumeration of supported formats
  */
-enum class Format { kPosix, kHDF5, kBinary };
+enum class Format {
+  kPosix,
+  kHDF5,
+  kBinary,
+  kLines,
+  kCsv,
+  kParquet,
+  kFeather,
+  kGzip,
+  kZstd
+};
 
 /**
  * Factory class for creating format clients
  */
 class FormatFactory {
 public:
+  /** Bytes of a file read to detect its format */
+  static constexpr size_t kSniffBytes = 4096;
+
   /**
    * Get a format client instance for the specified format
    * @param format The format type to create
@@ -29,8 +56,34 @@ public:
    * @return Unique pointer to the format client
    */
   static std::unique_ptr<FormatClient> Get(const std::string &format_str);
+
+  /**
+   * Get the most specific client built in for the content of a file;
+   * formats without one (e.g. Parquet without USE_ARROW, gzip) get the
+   * byte-range binary client
+   * @param path Local file
+   * @return Unique pointer to the format client, or nullptr if the file
+   *         cannot be read
+   */
+  static std::unique_ptr<FormatClient> Detect(const std::string &path);
+
+  /**
+   * Detect the format of a file from its first bytes (cached by path,
+   * size and mtime)
+   * @return false if the file cannot be read
+   */
+  static bool DetectFormat(const std::string &path, Format &format);
+
+  /** Classify a file from its first bytes (n <= kSniffBytes) */
+  static Format Sniff(const unsigned char *head, size_t n);
+
+  /** Whether Get() has a client for the format in this build */
+  static bool Available(Format format);
+
+  /** Lower-case name of a format, as accepted by Get() */
+  static std::string Name(Format format);
 };
 
 } // namespace cae
 
-#endif // CAE_FORMAT_FORMAT_FACTORY_H_
\ No newline at end of file
+#endif // CAE_FORMAT_FORMAT_FACTORY_H_
@@ -0,0 +1,140 @@
+#ifndef CAE_FORMAT_MPI_PROGRESS_H_
+#define CAE_FORMAT_MPI_PROGRESS_H_
+
+#include "progress_bar.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mpi.h>
+#include <string>
+
+/**
+ * Aggregate Progress Strategy:
+ *
+ * 1. Rate limit: ranks only record their byte count per chunk; at most one
+ *    reduction per interval is started, so stdout and the launcher are not
+ *    flooded however many ranks there are
+ * 2. Non-blocking: counts are summed with MPI_Iallreduce on a private
+ *    duplicate of the communicator and polled with MPI_Test, so readers
+ *    never wait for each other and collective reads on the original
+ *    communicator are not disturbed
+ * 3. Matched rounds: every rank starts the same sequence of reductions.
+ *    Ranks that are done keep joining rounds (with a done flag) until one
+ *    round reports every rank done, so all ranks stop on the same round
+ * 4. One bar: rank 0 alone renders the total with throughput and ETA
+ */
+
+namespace cae {
+
+/**
+ * Progress of one parallel read, summed over the ranks of a communicator
+ */
+class MpiProgress {
+public:
+  static constexpr double kDefaultInterval = 0.25;  // seconds
+
+  /**
+   * Collective over comm
+   * @param total Bytes read by all ranks together
+   * @param interval Seconds between reductions (and redraws)
+   */
+  MpiProgress(const std::string &title, uint64_t total, MPI_Comm comm,
+              double interval = kDefaultInterval)
+      : title_(title), total_(total), interval_(interval),
+        last_(std::chrono::steady_clock::now()) {
+    MPI_Comm_dup(comm, &comm_);
+    MPI_Comm_rank(comm_, &rank_);
+    MPI_Comm_size(comm_, &nranks_);
+    if (rank_ == 0) {
+      bar_ = std::make_unique<ProgressBar>(
+          title_, total_, "All " + std::to_string(nranks_));
+    }
+  }
+
+  ~MpiProgress() {
+    if (request_ != MPI_REQUEST_NULL) {
+      MPI_Wait(&request_, MPI_STATUS_IGNORE);
+    }
+    MPI_Comm_free(&comm_);
+  }
+
+  MpiProgress(const MpiProgress &) = delete;
+  MpiProgress &operator=(const MpiProgress &) = delete;
+
+  /** Record this rank's bytes so far; cheap enough to call per chunk */
+  void Update(uint64_t bytes) {
+    local_[0] = bytes;
+    Poll();
+    auto now = std::chrono::steady_clock::now();
+    if (request_ == MPI_REQUEST_NULL &&
+        std::chrono::duration<double>(now - last_).count() >= interval_) {
+      last_ = now;
+      Start();
+    }
+  }
+
+  /**
+   * This rank is done: join rounds until every rank is; the last round
+   * draws the final count. Every rank of the communicator must call it once.
+   */
+  void Finish() {
+    local_[1] = 1;
+    for (;;) {
+      if (request_ == MPI_REQUEST_NULL) {
+        Start();
+      }
+      MPI_Wait(&request_, MPI_STATUS_IGNORE);
+      Complete();
+      if (sum_[1] == static_cast<uint64_t>(nranks_)) {
+        break;
+      }
+    }
+    if (bar_) {
+      std::cout << std::endl;  // the last round drew the final count
+    }
+  }
+
+  /** Bytes of all ranks at the last completed round */
+  uint64_t Total() const { return sum_[0]; }
+
+private:
+  void Start() {
+    send_[0] = local_[0];
+    send_[1] = local_[1];
+    MPI_Iallreduce(send_, sum_, 2, MPI_UINT64_T, MPI_SUM, comm_, &request_);
+  }
+
+  void Poll() {
+    if (request_ == MPI_REQUEST_NULL) {
+      return;
+    }
+    int done = 0;
+    MPI_Test(&request_, &done, MPI_STATUS_IGNORE);
+    if (done) {
+      Complete();
+    }
+  }
+
+  void Complete() {
+    if (bar_) {
+      bar_->Update(sum_[0]);
+    }
+  }
+
+  std::string title_;
+  uint64_t total_;
+  double interval_;
+  MPI_Comm comm_ = MPI_COMM_NULL;
+  int rank_ = 0;
+  int nranks_ = 1;
+  uint64_t local_[2] = {0, 0};  // bytes, done
+  uint64_t send_[2] = {0, 0};   // stable until the round completes
+  uint64_t sum_[2] = {0, 0};
+  MPI_Request request_ = MPI_REQUEST_NULL;
+  std::chrono::steady_clock::time_point last_;
+  std::unique_ptr<ProgressBar> bar_;
+};
+
+} // namespace cae
+
+#endif // CAE_FORMAT_MPI_PROGRESS_H_
@@ -0,0 +1,310 @@
+#ifndef CAE_FORMAT_MPI_WORKER_POOL_H_
+#define CAE_FORMAT_MPI_WORKER_POOL_H_
+
+#include "binary_file_omni.h"
+#include "format_factory.h"
+#include "lines_file_omni.h"
+#include "../merkle.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mpi.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Worker Pool Strategy:
+ *
+ * 1. Launch once: the job spawns its worker ranks with MPI_Comm_spawn when
+ *    it starts, so MPI launch and wire-up are paid once per job instead of
+ *    once per file
+ * 2. Descriptors: each work item (path, offset, size, format, hash) is one
+ *    message over the parent/worker intercommunicator; a worker answers
+ *    with one result message and gets the next item
+ * 3. Dynamic: items go to whichever worker answers first, so a few large
+ *    files and many small ones keep every worker busy
+ * 4. Same readers: a worker reads its range with the format clients
+ *    wrp_binary_format_mpi uses (bytes, or whole records with format auto)
+ */
+
+namespace cae {
+
+/** Message tags between the job and its workers */
+enum WorkTag : int { kWorkTag = 1, kResultTag, kStopTag };
+
+/**
+ * One range of one file for a pool worker
+ */
+struct WorkItem {
+  std::string path;
+  uint64_t offset = 0;
+  uint64_t size = 0;    // 0: to end of file
+  std::string format;   // "auto": records for CSV and line files
+  std::string hash;     // "merkle:<hex>" of the range, checked if given
+};
+
+/**
+ * What a worker did with a work item
+ */
+struct WorkResult {
+  int status = 0;
+  uint64_t bytes = 0;
+  uint64_t records = 0;  // records were counted if format detection found text
+  double seconds = 0.0;
+};
+
+/** Item as one message: offset, size, then NUL-terminated strings */
+inline std::string PackWorkItem(const WorkItem &item) {
+  std::string message(2 * sizeof(uint64_t), '\0');
+  std::memcpy(&message[0], &item.offset, sizeof(uint64_t));
+  std::memcpy(&message[sizeof(uint64_t)], &item.size, sizeof(uint64_t));
+  for (const std::string *text : {&item.path, &item.format, &item.hash}) {
+    message += *text;
+    message += '\0';
+  }
+  return message;
+}
+
+/** @return false if the message is not a packed item */
+inline bool UnpackWorkItem(const std::string &message, WorkItem &item) {
+  size_t pos = 2 * sizeof(uint64_t);
+  if (message.size() < pos) {
+    return false;
+  }
+  std::memcpy(&item.offset, &message[0], sizeof(uint64_t));
+  std::memcpy(&item.size, &message[sizeof(uint64_t)], sizeof(uint64_t));
+  for (std::string *text : {&item.path, &item.format, &item.hash}) {
+    size_t end = message.find('\0', pos);
+    if (end == std::string::npos) {
+      return false;
+    }
+    *text = message.substr(pos, end - pos);
+    pos = end + 1;
+  }
+  return pos == message.size();
+}
+
+/** Read one item in this process */
+inline WorkResult RunWorkItem(const WorkItem &item) {
+  WorkResult result;
+  double start = MPI_Wtime();
+  try {
+    std::ifstream file(item.path, std::ios::binary | std::ios::ate);
+    if (!file) {
+      throw std::runtime_error("Could not open file: " + item.path);
+    }
+    uint64_t file_size = static_cast<uint64_t>(file.tellg());
+    uint64_t offset = std::min(item.offset, file_size);
+    uint64_t size = file_size - offset;
+    if (item.size != 0 && item.size < size) {
+      size = item.size;
+    }
+
+    Format format = Format::kBinary;
+    if (item.format == "auto" && !FormatFactory::DetectFormat(item.path, format)) {
+      throw std::runtime_error("Could not read file: " + item.path);
+    }
+    FormatContext ctx;
+    ctx.filename_ = item.path;
+    ctx.offset_ = offset;
+    ctx.size_ = size;
+    ctx.hash_ = item.hash;
+    if (format == Format::kCsv || format == Format::kLines) {
+      RecordOptions options;
+      options.header = format == Format::kCsv;
+      options.quote = format == Format::kCsv ? '"' : '\0';
+      LinesFileOmni lines(options);
+      lines.Import(ctx);
+      result.records = lines.Records();
+    } else {
+      BinaryFileOmni binary;
+      binary.Import(ctx);
+    }
+    result.bytes = size;
+
+    if (IsMerkleHash(item.hash)) {
+      std::string root = MerkleRootFile(item.path, offset, size);
+      if (root != item.hash) {
+        std::cerr << "Error: hash '" << item.hash << "' is not same as actual '"
+                  << root << "'" << std::endl;
+        result.status = 1;
+      }
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    result.status = 1;
+  }
+  result.seconds = MPI_Wtime() - start;
+  return result;
+}
+
+/**
+ * Worker side: run the items rank 0 of the parent sends until it says stop
+ * @return 0 when stopped
+ */
+inline int ServeWorkItems(MPI_Comm parent) {
+  for (;;) {
+    MPI_Status status;
+    MPI_Probe(0, MPI_ANY_TAG, parent, &status);
+    int nbyte = 0;
+    MPI_Get_count(&status, MPI_CHAR, &nbyte);
+    std::string message(nbyte, '\0');
+    MPI_Recv(&message[0], nbyte, MPI_CHAR, 0, status.MPI_TAG, parent,
+             MPI_STATUS_IGNORE);
+    if (status.MPI_TAG != kWorkTag) {
+      return 0;
+    }
+    WorkItem item;
+    WorkResult result;
+    if (UnpackWorkItem(message, item)) {
+      result = RunWorkItem(item);
+    } else {
+      std::cerr << "Error: malformed work item" << std::endl;
+      result.status = 1;
+    }
+    uint64_t reply[4] = {static_cast<uint64_t>(result.status), result.bytes,
+                         result.records,
+                         static_cast<uint64_t>(result.seconds * 1e6)};
+    MPI_Send(reply, 4, MPI_UINT64_T, 0, kResultTag, parent);
+  }
+}
+
+/**
+ * Parent side: worker ranks spawned once and fed work items
+ */
+class MpiWorkerPool {
+public:
+  /** Called as each item completes, with the worker's rank */
+  using Callback =
+      std::function<void(size_t index, int worker, const WorkResult &)>;
+  /** Fills the next item; false when there are no more */
+  using Source = std::function<bool(WorkItem &item)>;
+
+  MpiWorkerPool() = default;
+  ~MpiWorkerPool() { Stop(); }
+
+  MpiWorkerPool(const MpiWorkerPool &) = delete;
+  MpiWorkerPool &operator=(const MpiWorkerPool &) = delete;
+
+  /**
+   * Spawn the worker ranks (program must call ServeWorkItems on its parent
+   * communicator)
+   * @param hostfile Hosts to place the workers on; empty for the default
+   * @return 0 on success, otherwise error describes why
+   */
+  int Start(const std::string &program, int nworkers,
+            const std::string &hostfile, std::string &error) {
+    MPI_Info info;
+    MPI_Info_create(&info);
+    if (!hostfile.empty()) {
+      MPI_Info_set(info, "hostfile", hostfile.c_str());
+    }
+    // Report a failed spawn instead of aborting, so callers can fall back
+    MPI_Comm_set_errhandler(MPI_COMM_SELF, MPI_ERRORS_RETURN);
+    std::vector<int> codes(nworkers, MPI_SUCCESS);
+    int rc = MPI_Comm_spawn(program.c_str(), MPI_ARGV_NULL, nworkers, info, 0,
+                            MPI_COMM_SELF, &workers_, codes.data());
+    MPI_Comm_set_errhandler(MPI_COMM_SELF, MPI_ERRORS_ARE_FATAL);
+    MPI_Info_free(&info);
+    if (rc != MPI_SUCCESS) {
+      workers_ = MPI_COMM_NULL;
+      error = "could not spawn " + std::to_string(nworkers) + " x " + program;
+      return 1;
+    }
+    nworkers_ = nworkers;
+    return 0;
+  }
+
+  /** Number of worker ranks */
+  int Size() const { return nworkers_; }
+
+  /**
+   * Run every item on the first idle worker
+   * @return the results, in item order
+   */
+  std::vector<WorkResult> Run(const std::vector<WorkItem> &items,
+                              const Callback &done = Callback()) {
+    size_t next = 0;
+    return Run(
+        [&](WorkItem &item) {
+          if (next == items.size()) {
+            return false;
+          }
+          item = items[next++];
+          return true;
+        },
+        done);
+  }
+
+  /**
+   * Run items drawn from a source as workers go idle, until it is
+   * exhausted; the source may block while items are still being found
+   * @return the results, in the order the items were drawn
+   */
+  std::vector<WorkResult> Run(const Source &source,
+                              const Callback &done = Callback()) {
+    std::vector<WorkResult> results;
+    std::vector<size_t> running(nworkers_);
+    std::vector<std::string> messages(nworkers_);
+    bool more = true;
+    int busy = 0;
+    auto send = [&](int worker) {
+      WorkItem item;
+      if (!more || !(more = source(item))) {
+        return;
+      }
+      running[worker] = results.size();
+      results.emplace_back();
+      messages[worker] = PackWorkItem(item);
+      MPI_Send(messages[worker].data(), static_cast<int>(messages[worker].size()),
+               MPI_CHAR, worker, kWorkTag, workers_);
+      ++busy;
+    };
+    for (int worker = 0; worker < nworkers_ && more; ++worker) {
+      send(worker);
+    }
+    while (busy > 0) {
+      uint64_t reply[4];
+      MPI_Status status;
+      MPI_Recv(reply, 4, MPI_UINT64_T, MPI_ANY_SOURCE, kResultTag, workers_,
+               &status);
+      --busy;
+      int worker = status.MPI_SOURCE;
+      WorkResult &result = results[running[worker]];
+      result.status = static_cast<int>(reply[0]);
+      result.bytes = reply[1];
+      result.records = reply[2];
+      result.seconds = reply[3] / 1e6;
+      if (done) {
+        done(running[worker], worker, result);
+      }
+      send(worker);
+    }
+    return results;
+  }
+
+  /** Tell the workers to exit and disconnect from them */
+  void Stop() {
+    if (workers_ == MPI_COMM_NULL) {
+      return;
+    }
+    for (int worker = 0; worker < nworkers_; ++worker) {
+      MPI_Send(nullptr, 0, MPI_CHAR, worker, kStopTag, workers_);
+    }
+    MPI_Comm_disconnect(&workers_);
+    nworkers_ = 0;
+  }
+
+private:
+  MPI_Comm workers_ = MPI_COMM_NULL;
+  int nworkers_ = 0;
+};
+
+} // namespace cae
+
+#endif // CAE_FORMAT_MPI_WORKER_POOL_H_
@@ -13,8 +13,13 @@ namespace cae {
 class ProgressBar {
 public:
   ProgressBar(const std::string &title, size_t total, int rank, int width = 50)
-      : title_(title), total_(total), current_(0), width_(width), rank_(rank),
-        start_time_(std::chrono::steady_clock::now()) {
+      : ProgressBar(title, total, RankLabel(rank), width) {}
+
+  /** A bar for something other than one rank, e.g. "All 512" */
+  ProgressBar(const std::string &title, size_t total, const std::string &label,
+              int width = 50)
+      : title_(title), label_(label), total_(total), current_(0),
+        width_(width), start_time_(std::chrono::steady_clock::now()) {
     PrintBar(0);
   }
 
@@ -26,6 +31,12 @@ public:
   void Finish() { PrintBar(100); }
 
 private:
+  static std::string RankLabel(int rank) {
+    std::ostringstream oss;
+    oss << "Rank " << std::setw(3) << rank;
+    return oss.str();
+  }
+
   double CalculatePercentage() const {
     return total_ == 0 ? 100 : (current_ * 100.0) / total_;
   }
@@ -63,9 +74,8 @@ private:
 
   void PrintBar(double percentage) const {
     auto now = std::chrono::steady_clock::now();
-    auto elapsed =
-        std::chrono::duration_cast<std::chrono::seconds>(now - start_time_)
-            .count();
+    double elapsed =
+        std::chrono::duration<double>(now - start_time_).count();
 
     // Calculate speed and ETA
     double speed = elapsed > 0 ? (current_ / elapsed) : 0;
@@ -75,8 +85,8 @@ private:
     std::cout << "\r";
 
     // Print rank and title
-    std::cout << "Rank " << std::setw(3) << rank_ << " [" << std::setw(20)
-              << std::left << title_ << "] ";
+    std::cout << label_ << " [" << std::setw(20) << std::left << title_
+              << "] ";
 
     // Print progress bar
     int pos = static_cast<int>(width_ * percentage / 100.0);
@@ -92,8 +102,8 @@ private:
     std::cout << "] ";
 
     // Print percentage and progress details
-    std::cout << std::fixed << std::setprecision(1) << std::setw(5)
-              << percentage << "% " << "(" << FormatSize(current_) << "/"
+    std::cout << std::fixed << std::setprecision(1) << std::right
+              << std::setw(5) << percentage << "% " << "(" << FormatSize(current_) << "/"
               << FormatSize(total_) << ") " << FormatSize(speed) << "/s ";
 
     if (percentage < 100) {
@@ -107,10 +117,10 @@ private:
   }
 
   std::string title_;
+  std::string label_;  // "Rank   3" or the caller's label
   size_t total_;
   size_t current_;
   int width_;
-  int rank_;
   std::chrono::steady_clock::time_point start_time_;
 };
 
@@ -0,0 +1,224 @@
+#include "record_splitter.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace cae {
+
+namespace {
+
+constexpr size_t kScanBlock = 64 * 1024;
+
+// Calls fn(data, nbyte) on consecutive blocks of [from, to) until it
+// returns false; false if a read fails
+template <typename Fn>
+bool ForEachBlock(std::ifstream &in, uint64_t from, uint64_t to, Fn fn) {
+  std::vector<char> buffer(kScanBlock);
+  in.clear();
+  in.seekg(static_cast<std::streamoff>(from));
+  while (from < to) {
+    size_t want = static_cast<size_t>(std::min<uint64_t>(kScanBlock, to - from));
+    if (!in.read(buffer.data(), static_cast<std::streamsize>(want))) {
+      return false;
+    }
+    if (!fn(buffer.data(), want, from)) {
+      return true;
+    }
+    from += want;
+  }
+  return true;
+}
+
+// Whether c is field content: a quote next to it is not at a field edge
+bool Ordinary(char c, const RecordOptions &options) {
+  return c != options.quote && c != options.delimiter &&
+         c != options.separator && c != '\r';
+}
+
+// Quote state at from, told from the first quote past it that can only
+// open or only close a field. The window grows until one is found; false
+// if a read fails, and decided is false if no quote in the rest of the
+// file tells.
+bool LocalQuoteState(std::ifstream &in, uint64_t from, uint64_t file_size,
+                     const RecordOptions &options, bool &decided,
+                     bool &in_quotes) {
+  decided = false;
+  uint64_t lo = from > 0 ? from - 1 : 0;
+  std::vector<char> window;
+  for (uint64_t size = kScanBlock;; size *= 2) {
+    uint64_t hi = std::min(file_size, from + size);
+    window.resize(static_cast<size_t>(hi - lo));
+    in.clear();
+    in.seekg(static_cast<std::streamoff>(lo));
+    if (!in.read(window.data(), static_cast<std::streamsize>(window.size()))) {
+      return false;
+    }
+    // The byte after a quote must be in the window, unless it ends the file
+    uint64_t last = hi == file_size ? hi : hi - 1;
+    size_t quotes = 0;
+    for (uint64_t i = from; i < last; ++i) {
+      if (window[i - lo] != options.quote) {
+        continue;
+      }
+      bool closes = i > lo && Ordinary(window[i - lo - 1], options);
+      bool opens = i + 1 < hi && Ordinary(window[i - lo + 1], options);
+      if (closes != opens) {
+        // Inside quotes just before a closing quote, outside before an
+        // opening one; every quote since from flipped the state
+        in_quotes = closes != (quotes % 2 == 1);
+        decided = true;
+        return true;
+      }
+      ++quotes;
+    }
+    if (hi == file_size) {
+      return true;
+    }
+  }
+}
+
+} // namespace
+
+const char *FindRecordEnd(const char *begin, const char *end, char delimiter,
+                          char quote, bool &in_quotes) {
+  const char *p = begin;
+#ifdef __SSE2__
+  // 16 bytes per step: only delimiters and quotes are looked at one by one
+  const __m128i delims = _mm_set1_epi8(delimiter);
+  const __m128i quotes = _mm_set1_epi8(quote ? quote : delimiter);
+  while (end - p >= 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(
+        _mm_cmpeq_epi8(v, delims), _mm_cmpeq_epi8(v, quotes))));
+    while (mask != 0) {
+      const char *hit = p + __builtin_ctz(mask);
+      if (*hit == delimiter && !in_quotes) {
+        return hit;
+      }
+      if (quote && *hit == quote) {
+        in_quotes = !in_quotes;
+      }
+      mask &= mask - 1;
+    }
+    p += 16;
+  }
+#endif
+  for (; p < end; ++p) {
+    if (*p == delimiter && !in_quotes) {
+      return p;
+    }
+    if (quote && *p == quote) {
+      in_quotes = !in_quotes;
+    }
+  }
+  return nullptr;
+}
+
+size_t CountByte(const char *data, size_t nbyte, char c) {
+  size_t count = 0;
+  size_t i = 0;
+#ifdef __SSE2__
+  const __m128i needle = _mm_set1_epi8(c);
+  for (; i + 16 <= nbyte; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+    count += static_cast<size_t>(
+        __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(v, needle))));
+  }
+#endif
+  for (; i < nbyte; ++i) {
+    count += data[i] == c;
+  }
+  return count;
+}
+
+int RecordBoundary(const std::string &path, uint64_t pos, uint64_t file_size,
+                   const RecordOptions &options, uint64_t &boundary) {
+  if (pos == 0 || pos >= file_size) {
+    boundary = std::min(pos, file_size);
+    return 0;
+  }
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    std::cerr << "Error: cannot open '" << path << "'" << std::endl;
+    return 1;
+  }
+
+  // A record starts at pos if the byte before it ends one, so the search
+  // begins at pos - 1 with the quote state there
+  uint64_t from = pos - 1;
+  bool in_quotes = false;
+  bool ok = true;
+  if (options.quote && from > 0) {
+    bool decided = false;
+    ok = LocalQuoteState(in, from, file_size, options, decided, in_quotes);
+    if (ok && !decided) {
+      // Nothing past from tells; fall back to the parity of the quotes
+      // before it
+      size_t quotes = 0;
+      ok = ForEachBlock(in, 0, from,
+                        [&](const char *data, size_t n, uint64_t) {
+                          quotes += CountByte(data, n, options.quote);
+                          return true;
+                        });
+      in_quotes = quotes % 2 == 1;
+    }
+  }
+
+  boundary = file_size;
+  ok = ok && ForEachBlock(in, from, file_size,
+                          [&](const char *data, size_t n, uint64_t at) {
+                            const char *hit =
+                                FindRecordEnd(data, data + n, options.delimiter,
+                                              options.quote, in_quotes);
+                            if (hit == nullptr) {
+                              return true;
+                            }
+                            boundary = at + static_cast<uint64_t>(hit - data) + 1;
+                            return false;
+                          });
+  if (!ok) {
+    std::cerr << "Error: cannot read '" << path << "'" << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+int AlignToRecords(const std::string &path, uint64_t offset, uint64_t nbyte,
+                   const RecordOptions &options, RecordRange &range) {
+  std::error_code ec;
+  uint64_t file_size = std::filesystem::file_size(path, ec);
+  if (ec) {
+    std::cerr << "Error: cannot stat '" << path << "'" << std::endl;
+    return 1;
+  }
+  uint64_t first = std::min(offset, file_size);
+  uint64_t last = std::min(file_size - first, nbyte) + first;
+
+  uint64_t start = 0;
+  uint64_t end = 0;
+  if (RecordBoundary(path, first, file_size, options, start) != 0 ||
+      RecordBoundary(path, last, file_size, options, end) != 0) {
+    return 1;
+  }
+  // Record starts past 0 are past the header, so only the range that
+  // starts the file looks for its end
+  range.header_nbyte = 0;
+  if (options.header && start == 0 && file_size > 0) {
+    if (RecordBoundary(path, 1, file_size, options, range.header_nbyte) != 0) {
+      return 1;
+    }
+    start = std::max(start, range.header_nbyte);
+  }
+  range.offset = start;
+  range.nbyte = end > start ? end - start : 0;
+  return 0;
+}
+
+} // namespace cae
@@ -0,0 +1,79 @@
+#ifndef CAE_FORMAT_RECORD_SPLITTER_H_
+#define CAE_FORMAT_RECORD_SPLITTER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Record-Boundary Splitting Strategy:
+ *
+ * A CSV or other line-oriented file split by byte offset cuts records in
+ * half. Each partition is instead moved to whole records:
+ *
+ * 1. Boundaries: a partition [offset, offset + size) becomes [start, end),
+ *    where start and end are the first record starts at or after offset and
+ *    offset + size. Neighbouring partitions compute the same boundary for
+ *    their shared edge, so the adjusted ranges still tile the file with no
+ *    communication between ranks or threads.
+ * 2. Quotes (opt-in, for CSV): a delimiter inside a quoted field does not
+ *    end a record. The quote state at a boundary is resolved locally: a
+ *    quote right after an ordinary byte can only close a field and one
+ *    right before an ordinary byte can only open one (RFC 4180), so the
+ *    first such quote past the boundary fixes the parity there. Only if no
+ *    quote past the boundary tells are the quotes before it counted.
+ * 3. Header: optionally the first record of the file is a header and is
+ *    left out of the records of the partition that starts the file.
+ */
+
+namespace cae {
+
+/**
+ * How records are delimited
+ */
+struct RecordOptions {
+  char delimiter = '\n';
+  char quote = '\0';     // '"' for CSV; '\0': fields are never quoted
+  char separator = ',';  // field separator, to resolve quotes locally
+  bool header = false;   // first record of the file is a header
+};
+
+/**
+ * Whole-record range of a partition
+ */
+struct RecordRange {
+  uint64_t offset = 0;
+  uint64_t nbyte = 0;
+  uint64_t header_nbyte = 0;  // header length (with delimiter) if skipped,
+                              // only in the range that starts the file
+};
+
+/**
+ * Find the first delimiter outside quotes in [begin, end)
+ * @param in_quotes Quote state at begin; updated to the state at the
+ *                  returned delimiter, or at end if there is none
+ * @return Pointer to the delimiter, or nullptr
+ */
+const char *FindRecordEnd(const char *begin, const char *end, char delimiter,
+                          char quote, bool &in_quotes);
+
+/** Number of bytes equal to c in [data, data + nbyte) */
+size_t CountByte(const char *data, size_t nbyte, char c);
+
+/**
+ * Start of the first record at or after pos, or file_size if none
+ * @return 0 on success, 1 if the file cannot be read
+ */
+int RecordBoundary(const std::string &path, uint64_t pos, uint64_t file_size,
+                   const RecordOptions &options, uint64_t &boundary);
+
+/**
+ * Move a byte partition of a file to whole records
+ * @return 0 on success, 1 if the file cannot be read
+ */
+int AlignToRecords(const std::string &path, uint64_t offset, uint64_t nbyte,
+                   const RecordOptions &options, RecordRange &range);
+
+} // namespace cae
+
+#endif // CAE_FORMAT_RECORD_SPLITTER_H_
@@ -0,0 +1,620 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "manifest.h"
+#include "omni_processing.h"
+#include "repo/filesystem_repo_omni.h"
+#include "scale_model.h"
+#include "scheduler.h"
+#include "walk.h"
+#include "watch.h"
+#ifdef USE_MPI
+#include "format/mpi_worker_pool.h"
+#include "partition.h"
+#endif
+#ifndef _WIN32
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// wrp_binary_format_mpi installed next to the running wrp, else from PATH
+std::string WorkerProgram() {
+  std::error_code ec;
+  fs::path self = fs::read_symlink("/proc/self/exe", ec);
+  if (!ec) {
+    fs::path sibling = self.parent_path() / "wrp_binary_format_mpi";
+    if (fs::exists(sibling, ec)) {
+      return sibling.string();
+    }
+  }
+  return "wrp_binary_format_mpi";
+}
+
+#ifndef _WIN32
+// Variables the MPI runtime of this process (e.g. a singleton wrp built with
+// USE_MPI) sets for itself; an mpirun started with them refuses to run
+bool LauncherVariable(const char *var) {
+  auto starts = [var](const char *prefix) {
+    return std::strncmp(var, prefix, std::strlen(prefix)) == 0;
+  };
+  if (starts("PMIX_") || starts("PMI_") || starts("HYDRA_")) {
+    return true;
+  }
+  if (!starts("OMPI_") || starts("OMPI_ALLOW_RUN_AS_ROOT")) {
+    return false;
+  }
+  // OMPI_MCA_* are user settings, except the ones the runtime wires up
+  return !starts("OMPI_MCA_") || starts("OMPI_MCA_ess") ||
+         starts("OMPI_MCA_orte_") || starts("OMPI_MCA_pmix") ||
+         starts("OMPI_MCA_initial_wdir");
+}
+#endif
+
+// Run a shell command and return its exit status
+int RunCommand(const std::string &cmd) {
+#ifdef _WIN32
+  return std::system(cmd.c_str());
+#else
+  std::vector<char *> env;
+  for (char **var = environ; *var != nullptr; ++var) {
+    if (!LauncherVariable(*var)) {
+      env.push_back(*var);
+    }
+  }
+  env.push_back(nullptr);
+  const char *argv[] = {"sh", "-c", cmd.c_str(), nullptr};
+  pid_t pid;
+  if (posix_spawn(&pid, "/bin/sh", nullptr, nullptr,
+                  const_cast<char *const *>(argv), env.data()) != 0) {
+    return -1;
+  }
+  int status = 0;
+  while (waitpid(pid, &status, 0) < 0) {
+    if (errno != EINTR) {
+      return -1;
+    }
+  }
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#endif
+}
+
+// Process slots shared by all runs of a job: a run takes its nprocs slots
+// before it starts and returns them when it ends
+class ProcessSlots {
+ public:
+  explicit ProcessSlots(int capacity) : free_(capacity) {}
+
+  void Acquire(int n) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&] { return free_ >= n; });
+    free_ -= n;
+  }
+
+  void Release(int n) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      free_ += n;
+    }
+    cv_.notify_all();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  int free_;
+};
+
+// One launch: a data entry narrowed to a single file
+struct JobRun {
+  OmniJobConfig::DataEntry entry;
+  int nprocs = 1;
+  uint64_t bytes = 0;  // of the entry's range in this file
+  int status = 0;
+};
+
+// Runs of a job as they are found: the directory walk pushes them while
+// the readers already pop the first ones. Runs stay in place, so popped
+// pointers remain valid until the queue goes away.
+class RunQueue {
+ public:
+  void Push(JobRun run) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      runs_.push_back(std::move(run));
+    }
+    cv_.notify_one();
+  }
+
+  // No more runs will be pushed
+  void Close() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+    }
+    cv_.notify_all();
+  }
+
+  // The next run and its index, waiting for one to be pushed; nullptr once
+  // the queue is closed and drained
+  JobRun *Pop(size_t &index) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&] { return next_ < runs_.size() || closed_; });
+    if (next_ == runs_.size()) {
+      return nullptr;
+    }
+    index = next_++;
+    return &runs_[index];
+  }
+
+  // Every run pushed; only complete after Close()
+  const std::deque<JobRun> &Runs() const { return runs_; }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<JobRun> runs_;
+  size_t next_ = 0;
+  bool closed_ = false;
+};
+
+#ifdef USE_MPI
+// Work items of a run: its range in nprocs block-aligned pieces, or the
+// whole range when a hash covers it
+std::vector<cae::WorkItem> SplitRun(const JobRun &run) {
+  const OmniJobConfig::DataEntry &entry = run.entry;
+  cae::WorkItem item;
+  item.path = entry.paths[0];
+  item.offset = entry.offset;
+  item.size = entry.size;
+  item.format = entry.format;
+  item.hash = entry.hash;
+  std::error_code ec;
+  uint64_t file_size = fs::file_size(item.path, ec);
+  uint64_t block = 0;
+  if (ec || run.nprocs < 2 || !item.hash.empty() || item.offset >= file_size ||
+      (!entry.block.empty() && entry.block != "auto" &&
+       !cae::ParseByteSize(entry.block, block))) {
+    return {item};
+  }
+  uint64_t nbyte = file_size - item.offset;
+  if (item.size != 0) {
+    nbyte = std::min<uint64_t>(nbyte, item.size);
+  }
+  if (entry.block.empty() || entry.block == "auto") {
+    block = cae::DetectBlockSize(item.path);
+  }
+  std::vector<cae::WorkItem> pieces;
+  for (int i = 0; i < run.nprocs; ++i) {
+    cae::Slice slice =
+        cae::PartitionAligned(item.offset, nbyte, block, i, run.nprocs);
+    if (slice.nbyte > 0) {
+      pieces.push_back(item);
+      pieces.back().offset = slice.offset;
+      pieces.back().size = slice.nbyte;
+    }
+  }
+  return pieces;
+}
+
+// Feed every piece of every run to the pool as the runs arrive; a run
+// fails if any piece does
+void RunOnPool(RunQueue &queue, cae::MpiWorkerPool &pool) {
+  std::vector<cae::WorkItem> items;
+  std::vector<JobRun *> owners;
+  std::deque<cae::WorkItem> pieces;
+  JobRun *run = nullptr;
+  auto source = [&](cae::WorkItem &item) {
+    size_t index = 0;
+    while (pieces.empty()) {
+      if ((run = queue.Pop(index)) == nullptr) {
+        return false;
+      }
+      for (const cae::WorkItem &piece : SplitRun(*run)) {
+        pieces.push_back(piece);
+      }
+    }
+    item = pieces.front();
+    pieces.pop_front();
+    items.push_back(item);
+    owners.push_back(run);
+    return true;
+  };
+  auto report = [&](size_t index, int worker, const cae::WorkResult &result) {
+    const cae::WorkItem &item = items[index];
+    if (result.status != 0) {
+      owners[index]->status = result.status;
+      std::cerr << "Error: '" << item.path << "' failed on worker " << worker
+                << std::endl;
+      return;
+    }
+    std::cout << std::fixed << std::setprecision(3) << "worker " << worker
+              << ": '" << item.path << "' at " << item.offset << ": "
+              << result.bytes << " bytes";
+    if (result.records > 0) {
+      std::cout << ", " << result.records << " records";
+    }
+    std::cout << " in " << result.seconds << " s" << std::endl;
+  };
+  std::vector<cae::WorkResult> results = pool.Run(source, report);
+
+  // A run's pieces read side by side, so it took as long as its slowest
+  struct Total {
+    cae::WorkResult result;
+    int pieces = 0;
+  };
+  std::vector<std::pair<JobRun *, Total>> totals;
+  for (size_t i = 0; i < items.size(); ++i) {
+    if (totals.empty() || totals.back().first != owners[i]) {
+      totals.push_back({owners[i], Total()});
+    }
+    Total &total = totals.back().second;
+    total.result.bytes += results[i].bytes;
+    total.result.seconds = std::max(total.result.seconds, results[i].seconds);
+    ++total.pieces;
+  }
+  for (const auto &[owner, total] : totals) {
+    if (owner->status == 0) {
+      cae::ScaleModel::Record(owner->entry.paths[0], total.result.bytes,
+                              total.pieces, 1, total.result.seconds);
+    }
+  }
+}
+#endif
+
+// Print the job summary; returns the number of failed runs
+int ReportJob(const OmniJobConfig &config, const std::deque<JobRun> &runs,
+              size_t unchanged, std::chrono::steady_clock::time_point start,
+              const std::string &scale) {
+  int failed = 0;
+  for (const JobRun &run : runs) {
+    failed += run.status != 0;
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  std::cout << std::fixed << std::setprecision(3) << "job '" << config.name
+            << "': " << runs.size() << " runs, " << failed << " failed";
+  if (unchanged > 0) {
+    std::cout << ", " << unchanged << " unchanged";
+  }
+  std::cout << " in " << seconds << " s (" << scale << ")" << std::endl;
+  return failed;
+}
+
+// Runs of a job: files are sized, checked against the job's manifest and
+// read, on the worker pool or an mpirun each, as a producer finds them
+class JobRunner {
+ public:
+  using AddRun = std::function<void(const OmniJobConfig::DataEntry &entry,
+                                    const std::string &path)>;
+  using Producer = std::function<void(const AddRun &add)>;
+
+  JobRunner(const OmniJobConfig &config, const std::string &hostfile_path)
+      : config_(config),
+        hostfile_path_(hostfile_path),
+        max_scale_(std::max(1, config.max_scale)),
+        manifest_path_(cae::IngestManifest::DefaultPath(config.name)) {}
+
+  // The worker pool, if one was spawned, exits with the runner
+  ~JobRunner() {
+#ifdef USE_MPI
+    pool_.Stop();
+#endif
+  }
+
+  // Read the hostfile and the manifest and spawn the worker pool; returns
+  // 1 if the hostfile has no hosts
+  int Init() {
+    if (!hostfile_path_.empty()) {
+      hosts_ = ParseHostfile(hostfile_path_);
+      if (hosts_.empty()) {
+        std::cerr << "Error: no hosts in " << hostfile_path_ << std::endl;
+        return 1;
+      }
+    }
+    // Files ingested by an earlier run of this job and unchanged since
+    // are skipped
+    if (!manifest_path_.empty()) {
+      manifest_.Load(manifest_path_);
+    }
+#ifdef USE_MPI
+    // One pool of max_scale worker ranks reads the runs of every Run call,
+    // so a watched job spawns it once, not per batch; an mpirun per run is
+    // the fallback when workers cannot be spawned
+    std::string error;
+    if (pool_.Start(WorkerProgram(), max_scale_, hostfile_path_, error) != 0) {
+      std::cerr << "Warning: " << error << "; starting mpirun per file"
+                << std::endl;
+    }
+#endif
+    return 0;
+  }
+
+  // Run every file produce adds, from a thread of its own, and print the
+  // summary; returns the number of failed runs, or -1 if none was added
+  int Run(const Producer &produce) {
+    auto start = std::chrono::steady_clock::now();
+    RunQueue queue;
+    std::atomic<size_t> unchanged{0};
+    std::thread producer([&]() {
+      produce([&](const OmniJobConfig::DataEntry &entry,
+                  const std::string &path) {
+        if (!manifest_path_.empty() &&
+            manifest_.Unchanged(path, entry.offset, entry.size)) {
+          ++unchanged;
+          return;
+        }
+        queue.Push(Size(entry, path));
+      });
+      queue.Close();
+    });
+    auto finish = [&](const std::string &scale) {
+      producer.join();
+      const std::deque<JobRun> &runs = queue.Runs();
+      if (runs.empty() && unchanged == 0) {
+        return -1;
+      }
+      Record(runs);
+      return ReportJob(config_, runs, unchanged, start, scale);
+    };
+
+#ifdef USE_MPI
+    if (pool_.Size() > 0) {
+      RunOnPool(queue, pool_);
+      return finish("pool of " + std::to_string(pool_.Size()) + " workers");
+    }
+#endif
+
+    // Up to max_scale processes run at once; each worker thread takes the
+    // next run as soon as enough process slots are free
+    // With a hostfile, each run holds the least-loaded hosts, weighted by
+    // its bytes, until it ends
+    ProcessSlots slots(max_scale_);
+    cae::NodeScheduler scheduler(hosts_);
+    std::mutex log_mutex;
+    auto worker = [&]() {
+      size_t i = 0;
+      while (JobRun *run = queue.Pop(i)) {
+        slots.Acquire(run->nprocs);
+        cae::NodeScheduler::Allocation allocation;
+        std::string host_list;
+        if (scheduler.Size() > 0) {
+          allocation = scheduler.Allocate(
+              run->nprocs, cae::NodeScheduler::Weight(run->bytes));
+          host_list = scheduler.HostList(allocation, run->nprocs);
+          std::lock_guard<std::mutex> lock(log_mutex);
+          std::cout << "Run " << i << " allocated hosts: " << host_list
+                    << std::endl;
+        }
+        run->status = ProcessDataEntry(run->entry, run->nprocs, "", host_list);
+        scheduler.Release(allocation);
+        slots.Release(run->nprocs);
+      }
+    };
+    std::vector<std::thread> pool;
+    for (int i = 0; i < max_scale_; ++i) {
+      pool.emplace_back(worker);
+    }
+    for (std::thread &t : pool) {
+      t.join();
+    }
+
+    return finish("up to " + std::to_string(max_scale_) + " processes");
+  }
+
+ private:
+  // A run of one file of an entry, sized by the repository client
+  JobRun Size(const OmniJobConfig::DataEntry &entry, const std::string &path) {
+    JobRun run;
+    run.entry = entry;
+    run.entry.paths = {path};
+    run.entry.pattern.clear();
+    {
+      std::lock_guard<std::mutex> lock(sizing_mutex_);
+      int nthreads = 1;
+      repo_.RecommendScaleForFile(path, max_scale_, run.nprocs, nthreads);
+    }
+    run.nprocs = std::min(std::max(run.nprocs, 1), max_scale_);
+    std::error_code ec;
+    uint64_t file_size = fs::file_size(path, ec);
+    if (!ec && entry.offset < file_size) {
+      run.bytes = file_size - entry.offset;
+      if (entry.size != 0) {
+        run.bytes = std::min<uint64_t>(run.bytes, entry.size);
+      }
+    }
+    return run;
+  }
+
+  // Add the files of successful runs to the manifest and save it
+  void Record(const std::deque<JobRun> &runs) {
+    if (manifest_path_.empty()) {
+      return;
+    }
+    // Hashing the files just read is a second pass over them; spread it
+    // over the cores while they are still in the page cache. Entries of
+    // touched but unchanged files were refreshed, so always save.
+    std::atomic<size_t> next{0};
+    auto record = [&]() {
+      for (size_t i = next++; i < runs.size(); i = next++) {
+        const JobRun &run = runs[i];
+        if (run.status == 0) {
+          manifest_.Record(run.entry.paths[0], run.entry.offset,
+                           run.entry.size);
+        }
+      }
+    };
+    std::vector<std::thread> hashers;
+    unsigned ncores = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t i = 1; i < std::min<size_t>(runs.size(), ncores); ++i) {
+      hashers.emplace_back(record);
+    }
+    record();
+    for (std::thread &t : hashers) {
+      t.join();
+    }
+    if (manifest_.Save(manifest_path_) != 0) {
+      std::cerr << "Warning: cannot write manifest " << manifest_path_
+                << std::endl;
+    }
+  }
+
+  const OmniJobConfig &config_;
+  std::string hostfile_path_;
+  int max_scale_;
+  std::vector<std::string> hosts_;
+  cae::FilesystemRepoClient repo_;
+  std::mutex sizing_mutex_;
+  cae::IngestManifest manifest_;
+  std::string manifest_path_;
+#ifdef USE_MPI
+  cae::MpiWorkerPool pool_;
+#endif
+};
+
+// Every file of every entry: its paths, then the matches of its pattern as
+// the walk finds them
+void WalkEntries(const OmniJobConfig &config, const JobRunner::AddRun &add) {
+  cae::DirectoryWalker walker;
+  for (const OmniJobConfig::DataEntry &entry : config.data_entries) {
+    for (const std::string &path : entry.paths) {
+      add(entry, path);
+    }
+    if (entry.pattern.empty()) {
+      continue;
+    }
+    // Alternatives of {a,b} may overlap; each file is read once
+    std::set<std::string> seen;
+    std::mutex seen_mutex;
+    for (const std::string &each : cae::ExpandBraces(entry.pattern)) {
+      walker.Walk(each, [&](const std::string &path) {
+        {
+          std::lock_guard<std::mutex> lock(seen_mutex);
+          if (!seen.insert(path).second) {
+            return;
+          }
+        }
+        add(entry, path);
+      });
+    }
+  }
+}
+
+std::atomic<bool> stop_watching{false};
+
+void StopWatching(int) { stop_watching = true; }
+
+}  // namespace
+
+int ProcessDataEntry(const OmniJobConfig::DataEntry &entry, int nprocs,
+                     const std::string &hostfile, const std::string &hosts) {
+  if (entry.paths.empty()) {
+    std::cerr << "Error: data entry has no files" << std::endl;
+    return 1;
+  }
+  std::string cmd =
+      BuildMpiCommand(entry, nprocs, hostfile, WorkerProgram(), hosts);
+  std::cout << "Executing: " << cmd << std::endl;
+  int rc = RunCommand(cmd);
+  if (rc != 0) {
+    std::cerr << "Error: '" << entry.paths[0] << "' failed with status " << rc
+              << std::endl;
+  }
+  return rc;
+}
+
+std::future<int> ProcessDataEntryAsync(const OmniJobConfig::DataEntry &entry,
+                                       int nprocs,
+                                       const std::string &hostfile,
+                                       const std::string &hosts) {
+  return std::async(std::launch::async, ProcessDataEntry, entry, nprocs,
+                    hostfile, hosts);
+}
+
+int RunJob(const OmniJobConfig &config, const std::string &hostfile_path) {
+  // Every file a wildcard or directory matches is a run of its own; runs
+  // are queued while the tree is still being walked, so reading starts
+  // with the first match
+  JobRunner runner(config, hostfile_path);
+  if (runner.Init() != 0) {
+    return 1;
+  }
+  int failed = runner.Run(
+      [&](const JobRunner::AddRun &add) { WalkEntries(config, add); });
+  if (failed < 0) {
+    std::cerr << "Error: job '" << config.name << "' matched no files"
+              << std::endl;
+    return 1;
+  }
+  return failed;
+}
+
+int WatchJob(const OmniJobConfig &config, const std::string &hostfile_path) {
+  JobRunner runner(config, hostfile_path);
+  if (runner.Init() != 0) {
+    return 1;
+  }
+  // Watches go up before the first walk, so no file falls in between
+  cae::DirectoryWatcher watcher;
+  for (size_t i = 0; i < config.data_entries.size(); ++i) {
+    const OmniJobConfig::DataEntry &entry = config.data_entries[i];
+    std::vector<std::string> patterns = entry.paths;
+    if (!entry.pattern.empty()) {
+      patterns.push_back(entry.pattern);
+    }
+    for (const std::string &pattern : patterns) {
+      std::string error;
+      if (watcher.Add(pattern, i, error) != 0) {
+        std::cerr << "Error: job '" << config.name << "' - " << error
+                  << std::endl;
+        return 1;
+      }
+    }
+  }
+
+  stop_watching = false;
+  auto old_int = std::signal(SIGINT, StopWatching);
+  auto old_term = std::signal(SIGTERM, StopWatching);
+  std::cout << "watching job '" << config.name << "' (Ctrl-C to stop)"
+            << std::endl;
+
+  // Catch up on the files already there (the manifest skips those read
+  // before), then read each batch of new ones as it lands
+  int failed = std::max(0, runner.Run([&](const JobRunner::AddRun &add) {
+    WalkEntries(config, add);
+  }));
+  std::vector<cae::WatchMatch> batch;
+  while (watcher.Next(batch, stop_watching)) {
+    failed += std::max(0, runner.Run([&](const JobRunner::AddRun &add) {
+      for (const cae::WatchMatch &match : batch) {
+        add(config.data_entries[match.id], match.path);
+      }
+    }));
+  }
+
+  std::signal(SIGINT, old_int);
+  std::signal(SIGTERM, old_term);
+  std::cout << "stopped watching job '" << config.name << "': " << failed
+            << " failed runs" << std::endl;
+  return failed;
+}
@@ -0,0 +1,320 @@
+///
+/// job_plan.cc
+///
+#include "job_plan.h"
+#include "omni_processing.h"
+#include "sha256.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace cae {
+
+namespace {
+
+constexpr char kMagic[8] = {'O', 'M', 'N', 'I', 'P', 'L', 'A', 'N'};
+
+// Fields a build carries; a plan of another build is recompiled
+uint32_t BuildFlags() {
+  uint32_t flags = 0;
+#ifdef USE_HDF5
+  flags |= 1u;
+#endif
+  return flags;
+}
+
+class PlanWriter {
+ public:
+  void U32(uint32_t v) { Raw(&v, sizeof(v)); }
+  void U64(uint64_t v) { Raw(&v, sizeof(v)); }
+  void Str(const std::string& s) {
+    U32(static_cast<uint32_t>(s.size()));
+    Raw(s.data(), s.size());
+  }
+  void Strs(const std::vector<std::string>& list) {
+    U32(static_cast<uint32_t>(list.size()));
+    for (const std::string& s : list) {
+      Str(s);
+    }
+  }
+  template <typename T>
+  void U64s(const std::vector<T>& list) {
+    U32(static_cast<uint32_t>(list.size()));
+    for (T v : list) {
+      U64(static_cast<uint64_t>(v));
+    }
+  }
+  void Raw(const void* data, size_t nbyte) {
+    out_.append(static_cast<const char*>(data), nbyte);
+  }
+  const std::string& Bytes() const { return out_; }
+
+ private:
+  std::string out_;
+};
+
+// Bounds-checked reads; the first overrun makes every later read fail
+class PlanReader {
+ public:
+  PlanReader(const char* data, size_t nbyte) : p_(data), end_(data + nbyte) {}
+
+  bool U32(uint32_t& v) { return Raw(&v, sizeof(v)); }
+  bool U64(uint64_t& v) { return Raw(&v, sizeof(v)); }
+  bool Str(std::string& s) {
+    uint32_t n = 0;
+    if (!U32(n) || n > Left()) {
+      return Fail();
+    }
+    s.assign(p_, n);
+    p_ += n;
+    return true;
+  }
+  bool Strs(std::vector<std::string>& list) {
+    uint32_t n = 0;
+    if (!U32(n) || n > Left() / sizeof(uint32_t)) {
+      return Fail();
+    }
+    list.resize(n);
+    for (std::string& s : list) {
+      if (!Str(s)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  template <typename T>
+  bool U64s(std::vector<T>& list) {
+    uint32_t n = 0;
+    if (!U32(n) || n > Left() / sizeof(uint64_t)) {
+      return Fail();
+    }
+    list.resize(n);
+    for (T& v : list) {
+      uint64_t u = 0;
+      if (!U64(u)) {
+        return false;
+      }
+      v = static_cast<T>(u);
+    }
+    return true;
+  }
+  bool Raw(void* data, size_t nbyte) {
+    if (!ok_ || nbyte > Left()) {
+      return Fail();
+    }
+    std::memcpy(data, p_, nbyte);
+    p_ += nbyte;
+    return true;
+  }
+  bool Done() const { return ok_ && p_ == end_; }
+
+ private:
+  size_t Left() const { return static_cast<size_t>(end_ - p_); }
+  bool Fail() {
+    ok_ = false;
+    return false;
+  }
+
+  const char* p_;
+  const char* end_;
+  bool ok_ = true;
+};
+
+void WriteEntry(PlanWriter& w, const OmniJobConfig::DataEntry& entry) {
+  w.Strs(entry.paths);
+  w.Str(entry.pattern);
+  w.U64s(entry.range);
+  w.U64(entry.offset);
+  w.U64(entry.size);
+  w.Strs(entry.description);
+  w.Str(entry.hash);
+  w.Str(entry.block);
+  w.Str(entry.format);
+#ifdef USE_HDF5
+  w.Str(entry.src);
+  w.U64s(entry.hdf5_start);
+  w.U64s(entry.hdf5_count);
+  w.U64s(entry.hdf5_stride);
+  w.Str(entry.run_script);
+  w.Str(entry.destination);
+#endif
+}
+
+bool ReadEntry(PlanReader& r, OmniJobConfig::DataEntry& entry) {
+  uint64_t offset = 0;
+  uint64_t size = 0;
+  bool ok = r.Strs(entry.paths) && r.Str(entry.pattern) &&
+            r.U64s(entry.range) && r.U64(offset) && r.U64(size) &&
+            r.Strs(entry.description) && r.Str(entry.hash) &&
+            r.Str(entry.block) && r.Str(entry.format);
+#ifdef USE_HDF5
+  ok = ok && r.Str(entry.src) && r.U64s(entry.hdf5_start) &&
+       r.U64s(entry.hdf5_count) && r.U64s(entry.hdf5_stride) &&
+       r.Str(entry.run_script) && r.Str(entry.destination);
+#endif
+  entry.offset = offset;
+  entry.size = size;
+  return ok;
+}
+
+// Whole file in one read
+bool ReadFile(const std::string& path, std::string& bytes) {
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  if (!in) {
+    return false;
+  }
+  bytes.resize(static_cast<size_t>(in.tellg()));
+  in.seekg(0);
+  return static_cast<bool>(
+      in.read(&bytes[0], static_cast<std::streamsize>(bytes.size())));
+}
+
+// An entry resolved to nothing (a file that did not exist yet) would
+// resolve differently on a later run, so such a job is not cached
+bool Resolved(const OmniJobConfig& config) {
+  for (const OmniJobConfig::DataEntry& entry : config.data_entries) {
+    bool resolved = !entry.paths.empty() || !entry.pattern.empty();
+#ifdef USE_HDF5
+    resolved = resolved || !entry.src.empty();
+#endif
+    if (!resolved) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+std::string JobPlanPath(const std::string& yaml_file) {
+  if (const char* dir = std::getenv("OMNI_PLAN_DIR")) {
+    if (*dir == '\0') {
+      return "";
+    }
+    std::string name = std::filesystem::path(yaml_file).filename().string();
+    return std::string(dir) + "/" + name + ".plan";
+  }
+  return yaml_file + ".plan";
+}
+
+std::string JobPlanKey(const std::string& yaml_file) {
+  std::string bytes;
+  if (!ReadFile(yaml_file, bytes)) {
+    return "";
+  }
+  std::error_code ec;
+  std::string cwd = std::filesystem::current_path(ec).string();
+  const char* home = std::getenv("HOME");
+  Sha256 sha;
+  sha.Update(bytes.data(), bytes.size());
+  sha.Update("", 1);
+  sha.Update(cwd.data(), cwd.size());
+  sha.Update("", 1);
+  if (home != nullptr) {
+    sha.Update(home, std::strlen(home));
+  }
+  return Sha256::ToHex(sha.Final());
+}
+
+int WriteJobPlan(const std::string& path, const std::string& key,
+                 const OmniJobConfig& config) {
+  PlanWriter w;
+  w.Raw(kMagic, sizeof(kMagic));
+  w.U32(kJobPlanVersion);
+  w.U32(BuildFlags());
+  w.Str(key);
+  w.Str(config.name);
+  w.U64(static_cast<uint64_t>(static_cast<int64_t>(config.max_scale)));
+  w.Str(config.hostfile);
+  w.U32(static_cast<uint32_t>(config.data_entries.size()));
+  for (const OmniJobConfig::DataEntry& entry : config.data_entries) {
+    WriteEntry(w, entry);
+  }
+
+  // Write to a temporary file and rename so a concurrent run never reads
+  // half a plan
+  std::error_code ec;
+  std::filesystem::path parent = std::filesystem::path(path).parent_path();
+  if (!parent.empty()) {
+    std::filesystem::create_directories(parent, ec);
+  }
+  std::string tmp = path + ".tmp";
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    out.write(w.Bytes().data(),
+              static_cast<std::streamsize>(w.Bytes().size()));
+    out.flush();
+    if (!out) {
+      std::filesystem::remove(tmp, ec);
+      return 1;
+    }
+  }
+  std::filesystem::rename(tmp, path, ec);
+  return ec ? 1 : 0;
+}
+
+int ReadJobPlan(const std::string& path, const std::string& key,
+                OmniJobConfig& config) {
+  std::string bytes;
+  if (!ReadFile(path, bytes)) {
+    return 1;
+  }
+  PlanReader r(bytes.data(), bytes.size());
+  char magic[sizeof(kMagic)];
+  uint32_t version = 0;
+  uint32_t flags = 0;
+  std::string plan_key;
+  if (!r.Raw(magic, sizeof(magic)) ||
+      std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 || !r.U32(version) ||
+      version != kJobPlanVersion || !r.U32(flags) || flags != BuildFlags() ||
+      !r.Str(plan_key) || plan_key != key) {
+    return 1;
+  }
+  OmniJobConfig plan;
+  uint64_t max_scale = 0;
+  uint32_t nentries = 0;
+  if (!r.Str(plan.name) || !r.U64(max_scale) || !r.Str(plan.hostfile) ||
+      !r.U32(nentries)) {
+    return 1;
+  }
+  plan.max_scale = static_cast<int>(static_cast<int64_t>(max_scale));
+  plan.data_entries.reserve(std::min<size_t>(nentries, bytes.size()));
+  for (uint32_t i = 0; i < nentries; ++i) {
+    plan.data_entries.emplace_back();
+    if (!ReadEntry(r, plan.data_entries.back())) {
+      return 1;
+    }
+  }
+  if (!r.Done()) {
+    return 1;
+  }
+  config = std::move(plan);
+  return 0;
+}
+
+OmniJobConfig LoadJob(const std::string& yaml_file) {
+  std::string path = JobPlanPath(yaml_file);
+  std::string key = path.empty() ? "" : JobPlanKey(yaml_file);
+  if (!key.empty()) {
+    OmniJobConfig config;
+    if (ReadJobPlan(path, key, config) == 0) {
+      std::cout << "Loaded job plan " << path << " ("
+                << config.data_entries.size() << " data entries)"
+                << std::endl;
+      return config;
+    }
+  }
+  OmniJobConfig config = ParseOmniFile(yaml_file);
+  if (!key.empty() && Resolved(config) &&
+      WriteJobPlan(path, key, config) == 0) {
+    std::cout << "Compiled job plan " << path << std::endl;
+  }
+  return config;
+}
+
+}  // namespace cae
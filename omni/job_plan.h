@@ -0,0 +1,64 @@
+///
+/// job_plan.h
+///
+/// Compiled job plans. Parsing a large job file with yaml-cpp takes longer
+/// than small jobs run, so the parsed OmniJobConfig is flattened into a
+/// binary plan and cached next to the YAML as <yaml>.plan. A plan is keyed
+/// by the SHA-256 of the YAML bytes, the working directory and $HOME (what
+/// its relative and ~ paths resolved against), so a changed job file
+/// compiles a new plan. A later run reads the plan in one read and never
+/// touches YAML.
+///
+/// Layout, in host byte order: "OMNIPLAN", u32 version, u32 build flags,
+/// the key, then the config. Strings are a u32 length and bytes, lists a
+/// u32 count and items, numbers u64.
+///
+#ifndef CAE_JOB_PLAN_H_
+#define CAE_JOB_PLAN_H_
+
+#include <cstdint>
+#include <string>
+
+#include "omni_job_config.h"
+
+namespace cae {
+
+/** Plans of another version are recompiled */
+constexpr uint32_t kJobPlanVersion = 1;
+
+/**
+ * Plan of a job file: <yaml>.plan, or $OMNI_PLAN_DIR/<yaml name>.plan if
+ * set; empty disables plans
+ */
+std::string JobPlanPath(const std::string& yaml_file);
+
+/**
+ * Hex key of a job file as it would be parsed here and now
+ * @return "" if the file cannot be read
+ */
+std::string JobPlanKey(const std::string& yaml_file);
+
+/**
+ * Write a plan, replacing the file atomically
+ * @return 0 on success, 1 if it cannot be written
+ */
+int WriteJobPlan(const std::string& path, const std::string& key,
+                 const OmniJobConfig& config);
+
+/**
+ * Read a plan compiled under key
+ * @return 0 on success, 1 if it is missing, stale or malformed
+ */
+int ReadJobPlan(const std::string& path, const std::string& key,
+                OmniJobConfig& config);
+
+/**
+ * ParseOmniFile through the plan cache: the plan if it matches the job
+ * file, else the parsed YAML, compiled into a plan for the next run
+ * @throws what ParseOmniFile throws
+ */
+OmniJobConfig LoadJob(const std::string& yaml_file);
+
+}  // namespace cae
+
+#endif  // CAE_JOB_PLAN_H_
@@ -0,0 +1,230 @@
+///
+/// manifest.cc
+///
+#include "manifest.h"
+#include "sha256.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace cae {
+
+namespace {
+
+// Manifests are keyed by absolute path, so a job run from another
+// directory still finds its files
+std::string Key(const std::string& path) {
+  std::error_code ec;
+  std::filesystem::path absolute = std::filesystem::absolute(path, ec);
+  return ec ? path : absolute.lexically_normal().string();
+}
+
+bool StatFile(const std::string& path, ManifestEntry& entry) {
+  // The mtime comes from std::filesystem, as in the catalog, since the
+  // nanosecond field of struct stat is named differently on each platform
+  std::error_code ec;
+  if (!std::filesystem::is_regular_file(path, ec)) {
+    return false;
+  }
+  entry.size = std::filesystem::file_size(path, ec);
+  if (ec) {
+    return false;
+  }
+  auto t = std::filesystem::last_write_time(path, ec);
+  if (ec) {
+    return false;
+  }
+  entry.mtime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    t.time_since_epoch())
+                    .count();
+  entry.inode = 0;
+#ifndef _WIN32
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) {
+    return false;
+  }
+  entry.inode = static_cast<uint64_t>(st.st_ino);
+#endif
+  return true;
+}
+
+bool SameStat(const ManifestEntry& a, const ManifestEntry& b) {
+  return a.size == b.size && a.mtime == b.mtime && a.inode == b.inode;
+}
+
+std::string HashFile(const std::string& path) {
+  try {
+    return Sha256HexFile(path);
+  } catch (const std::runtime_error&) {
+    return "";
+  }
+}
+
+}  // namespace
+
+std::string IngestManifest::DefaultPath(const std::string& job) {
+  // Job names become file names; keep them to one flat directory
+  std::string file = job.empty() ? "job" : job;
+  for (char& c : file) {
+    if (c == '/' || c == '\\') {
+      c = '_';
+    }
+  }
+  if (const char* dir = std::getenv("OMNI_MANIFEST_DIR")) {
+    return *dir == '\0' ? "" : std::string(dir) + "/" + file + ".manifest";
+  }
+  const char* home = std::getenv("HOME");
+  if (home == nullptr || *home == '\0') {
+    return "";
+  }
+  return std::string(home) + "/.wrp/manifests/" + file + ".manifest";
+}
+
+void IngestManifest::Load(const std::string& path) {
+  std::ifstream in(path);
+  std::string line;
+  std::lock_guard<std::mutex> lock(mutex_);
+  while (std::getline(in, line)) {
+    // size mtime inode offset range digest, then the path (which may
+    // hold spaces) up to the end of the line
+    std::istringstream fields(line);
+    ManifestEntry entry;
+    std::string file;
+    if (!(fields >> entry.size >> entry.mtime >> entry.inode >>
+          entry.offset >> entry.range >> entry.digest) ||
+        fields.get() != '\t' || !std::getline(fields, file) || file.empty()) {
+      continue;
+    }
+    if (entry.inode != 0) {
+      inodes_[entry.inode] = file;
+    }
+    entries_[file] = entry;
+  }
+}
+
+int IngestManifest::Save(const std::string& path) const {
+  std::vector<std::string> files;
+  std::ostringstream out;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [file, entry] : entries_) {
+      files.push_back(file);
+    }
+    std::sort(files.begin(), files.end());
+    for (const std::string& file : files) {
+      const ManifestEntry& entry = entries_.at(file);
+      out << entry.size << '\t' << entry.mtime << '\t' << entry.inode << '\t'
+          << entry.offset << '\t' << entry.range << '\t' << entry.digest
+          << '\t' << file << '\n';
+    }
+  }
+
+  // Write to a temporary file and rename so an interrupted job never
+  // leaves half a manifest
+  std::error_code ec;
+  std::filesystem::path parent = std::filesystem::path(path).parent_path();
+  if (!parent.empty()) {
+    std::filesystem::create_directories(parent, ec);
+  }
+  std::string tmp = path + ".tmp";
+  {
+    std::ofstream file(tmp, std::ios::trunc);
+    file << out.str();
+    file.flush();
+    if (!file) {
+      return 1;
+    }
+  }
+  std::filesystem::rename(tmp, path, ec);
+  return ec ? 1 : 0;
+}
+
+bool IngestManifest::Unchanged(const std::string& path, uint64_t offset,
+                               uint64_t range) {
+  ManifestEntry now;
+  if (!StatFile(path, now)) {
+    return false;  // the run reports it
+  }
+  std::string key = Key(path);
+  ManifestEntry old;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end() && now.inode != 0) {
+      // A renamed file keeps its inode, size and mtime
+      auto moved = inodes_.find(now.inode);
+      if (moved != inodes_.end()) {
+        auto from = entries_.find(moved->second);
+        if (from != entries_.end() && SameStat(from->second, now) &&
+            from->second.offset == offset && from->second.range == range) {
+          ManifestEntry entry = from->second;
+          std::error_code ec;
+          if (!std::filesystem::exists(moved->second, ec)) {
+            entries_.erase(from);
+          }
+          entries_[key] = entry;
+          moved->second = key;
+          return true;
+        }
+      }
+    }
+    if (it == entries_.end() || it->second.offset != offset ||
+        it->second.range != range || it->second.size != now.size) {
+      return false;
+    }
+    if (SameStat(it->second, now)) {
+      return true;
+    }
+    old = it->second;
+  }
+
+  // Same size, new mtime or inode: unchanged only if the content is
+  if (old.digest.empty() || HashFile(path) != old.digest) {
+    return false;
+  }
+  now.offset = offset;
+  now.range = range;
+  now.digest = old.digest;
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_[key] = now;
+  if (now.inode != 0) {
+    inodes_[now.inode] = key;
+  }
+  return true;
+}
+
+int IngestManifest::Record(const std::string& path, uint64_t offset,
+                           uint64_t range) {
+  ManifestEntry entry;
+  if (!StatFile(path, entry)) {
+    return 1;
+  }
+  entry.offset = offset;
+  entry.range = range;
+  entry.digest = HashFile(path);
+  if (entry.digest.empty()) {
+    return 1;
+  }
+  std::string key = Key(path);
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_[key] = entry;
+  if (entry.inode != 0) {
+    inodes_[entry.inode] = key;
+  }
+  return 0;
+}
+
+size_t IngestManifest::Size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+}  // namespace cae
@@ -0,0 +1,81 @@
+///
+/// manifest.h
+///
+/// Per-job record of the files a job has ingested, so a re-run reads only
+/// new or changed files. Each file is kept by absolute path with its size,
+/// mtime, inode, the range the job read and the SHA-256 of its content.
+/// A file whose size, mtime and inode still match is unchanged without
+/// being read. One whose stat changed but whose content hashes the same
+/// (e.g. touched or copied back) is also unchanged, and so is a file that
+/// was only renamed: its inode, size and mtime match another entry.
+///
+#ifndef CAE_MANIFEST_H_
+#define CAE_MANIFEST_H_
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace cae {
+
+/**
+ * One ingested file
+ */
+struct ManifestEntry {
+  uint64_t size = 0;
+  int64_t mtime = 0;    // nanoseconds
+  uint64_t inode = 0;   // 0 where the platform has none
+  uint64_t offset = 0;  // range the job read
+  uint64_t range = 0;   // 0: to the end of the file
+  std::string digest;   // SHA-256 hex of the whole file
+};
+
+/**
+ * Files ingested by one job; safe to use from concurrent threads
+ */
+class IngestManifest {
+ public:
+  /**
+   * Manifest of a job: $OMNI_MANIFEST_DIR/<job>.manifest if set (empty
+   * disables manifests), else ~/.wrp/manifests/<job>.manifest
+   */
+  static std::string DefaultPath(const std::string& job);
+
+  /**
+   * Load a manifest; a missing file is an empty manifest and malformed
+   * lines are skipped
+   */
+  void Load(const std::string& path);
+
+  /**
+   * Write the manifest (creating its directory), replacing the file
+   * atomically
+   * @return 0 on success, 1 if it cannot be written
+   */
+  int Save(const std::string& path) const;
+
+  /**
+   * Whether a file was ingested with the same range and has not changed
+   * since; an entry whose stat changed but whose content did not is
+   * refreshed
+   */
+  bool Unchanged(const std::string& path, uint64_t offset, uint64_t range);
+
+  /**
+   * Stat and hash a file the job has just ingested
+   * @return 0 on success, 1 if the file cannot be read
+   */
+  int Record(const std::string& path, uint64_t offset, uint64_t range);
+
+  size_t Size() const;
+
+ private:
+  std::unordered_map<std::string, ManifestEntry> entries_;  // by path
+  std::unordered_map<uint64_t, std::string> inodes_;  // path of each inode
+  mutable std::mutex mutex_;
+};
+
+}  // namespace cae
+
+#endif  // CAE_MANIFEST_H_
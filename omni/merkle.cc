@@ -0,0 +1,164 @@
+///
+/// merkle.cc
+///
+#include "merkle.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#include "partition.h"
+
+namespace cae {
+
+bool IsMerkleHash(const std::string& hash) {
+  return hash.rfind(kMerklePrefix, 0) == 0;
+}
+
+Sha256::Digest MerkleLeaf(const void* data, size_t nbyte) {
+  const uint8_t tag = 0x00;
+  Sha256 sha;
+  sha.Update(&tag, 1);
+  sha.Update(data, nbyte);
+  return sha.Final();
+}
+
+Sha256::Digest MerkleParent(const Sha256::Digest& left,
+                            const Sha256::Digest& right) {
+  const uint8_t tag = 0x01;
+  Sha256 sha;
+  sha.Update(&tag, 1);
+  sha.Update(left.data(), left.size());
+  sha.Update(right.data(), right.size());
+  return sha.Final();
+}
+
+Sha256::Digest MerkleRoot(std::vector<Sha256::Digest> leaves) {
+  if (leaves.empty()) {
+    return MerkleLeaf(nullptr, 0);
+  }
+  while (leaves.size() > 1) {
+    size_t n = 0;
+    for (size_t i = 0; i < leaves.size(); i += 2) {
+      leaves[n++] = i + 1 < leaves.size()
+                        ? MerkleParent(leaves[i], leaves[i + 1])
+                        : leaves[i];
+    }
+    leaves.resize(n);
+  }
+  return leaves[0];
+}
+
+size_t MerkleLeafCount(uint64_t nbyte, size_t leaf_size) {
+  if (nbyte == 0 || leaf_size == 0) {
+    return 1;
+  }
+  return static_cast<size_t>((nbyte + leaf_size - 1) / leaf_size);
+}
+
+int MerkleHashLeaves(const std::string& path, uint64_t offset, uint64_t nbyte,
+                     size_t first, size_t count, size_t leaf_size,
+                     std::vector<Sha256::Digest>& leaves) {
+  if (count == 0) {
+    return 0;
+  }
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return -1;
+  }
+  std::vector<char> chunk(std::min<uint64_t>(leaf_size, nbyte));
+  uint64_t begin = static_cast<uint64_t>(first) * leaf_size;
+  in.seekg(static_cast<std::streamoff>(offset + begin));
+  for (size_t leaf = first; leaf < first + count; ++leaf) {
+    begin = static_cast<uint64_t>(leaf) * leaf_size;
+    size_t want = static_cast<size_t>(
+        std::min<uint64_t>(leaf_size, nbyte > begin ? nbyte - begin : 0));
+    // Fails on an error, or if the file is shorter than the range
+    if (!in.read(chunk.data(), static_cast<std::streamsize>(want))) {
+      return -1;
+    }
+    leaves.push_back(MerkleLeaf(chunk.data(), want));
+  }
+  return 0;
+}
+
+std::vector<Sha256::Digest> MerkleLeaves(const void* data, size_t nbyte,
+                                         size_t leaf_size) {
+  std::vector<Sha256::Digest> leaves;
+  const unsigned char* p = static_cast<const unsigned char*>(data);
+  for (size_t done = 0; done < nbyte; done += leaf_size) {
+    leaves.push_back(MerkleLeaf(p + done, std::min(leaf_size, nbyte - done)));
+  }
+  return leaves;
+}
+
+std::string MerkleRootFile(const std::string& path, uint64_t offset,
+                           uint64_t nbyte, size_t leaf_size) {
+  std::vector<Sha256::Digest> leaves;
+  if (MerkleHashLeaves(path, offset, nbyte, 0,
+                       MerkleLeafCount(nbyte, leaf_size), leaf_size,
+                       leaves) != 0) {
+    throw std::runtime_error("Error: calculating Merkle root - cannot read " +
+                             path);
+  }
+  return kMerklePrefix + Sha256::ToHex(MerkleRoot(leaves));
+}
+
+#ifdef USE_MPI
+std::string MerkleRootMpi(const std::string& path, uint64_t offset,
+                          uint64_t nbyte, MPI_Comm comm, size_t leaf_size) {
+  int rank = 0;
+  int nranks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nranks);
+
+  // Each rank hashes a contiguous run of whole leaves
+  size_t total = MerkleLeafCount(nbyte, leaf_size);
+  Slice share = PartitionRange(0, total, rank, nranks);
+  std::vector<Sha256::Digest> mine;
+  bool failed = MerkleHashLeaves(path, offset, nbyte, share.offset,
+                                 share.nbyte, leaf_size, mine) != 0;
+  return MerkleRootGather(mine, failed, comm);
+}
+
+std::string MerkleRootGather(const std::vector<Sha256::Digest>& leaves,
+                             bool failed, MPI_Comm comm) {
+  int rank = 0;
+  int nranks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nranks);
+  int mine_failed = failed ? 1 : 0;
+  int any_failed = 0;
+  MPI_Allreduce(&mine_failed, &any_failed, 1, MPI_INT, MPI_MAX, comm);
+  if (any_failed) {
+    return "";
+  }
+
+  const int kDigest = static_cast<int>(sizeof(Sha256::Digest));
+  int nbyte = static_cast<int>(leaves.size()) * kDigest;
+  std::vector<int> counts(rank == 0 ? nranks : 1);
+  MPI_Gather(&nbyte, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, comm);
+  std::vector<int> displs;
+  std::vector<Sha256::Digest> all;
+  if (rank == 0) {
+    displs.resize(nranks);
+    int total = 0;
+    for (int r = 0; r < nranks; ++r) {
+      displs[r] = total;
+      total += counts[r];
+    }
+    all.resize(static_cast<size_t>(total / kDigest));
+  }
+  MPI_Gatherv(leaves.data(), nbyte, MPI_BYTE, all.data(), counts.data(),
+              displs.data(), MPI_BYTE, 0, comm);
+
+  Sha256::Digest root{};
+  if (rank == 0) {
+    root = MerkleRoot(std::move(all));
+  }
+  MPI_Bcast(root.data(), kDigest, MPI_BYTE, 0, comm);
+  return kMerklePrefix + Sha256::ToHex(root);
+}
+#endif
+
+}  // namespace cae
@@ -0,0 +1,99 @@
+///
+/// merkle.h
+///
+/// Merkle-tree SHA-256 of a file range. The range is cut into fixed-size
+/// leaves, so any process can hash any subset of the leaves and the root
+/// does not depend on how the work was split. Under MPI the ranks hash
+/// their share of the leaves in parallel and rank 0 combines them.
+///
+/// Leaves are SHA-256(0x00 || bytes) and inner nodes SHA-256(0x01 || left
+/// || right), as in RFC 6962. An unpaired node moves up a level unchanged.
+/// A root is written as "merkle:<hex>" wherever a hash is expected.
+///
+#ifndef CAE_MERKLE_H_
+#define CAE_MERKLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+
+#include "sha256.h"
+
+namespace cae {
+
+/** Default leaf size */
+constexpr size_t kMerkleLeafSize = 1 << 20;
+
+/** Prefix that marks a hash as a Merkle root */
+constexpr const char kMerklePrefix[] = "merkle:";
+
+/** True if hash is written as "merkle:<hex>" */
+bool IsMerkleHash(const std::string& hash);
+
+Sha256::Digest MerkleLeaf(const void* data, size_t nbyte);
+Sha256::Digest MerkleParent(const Sha256::Digest& left,
+                            const Sha256::Digest& right);
+
+/**
+ * Root of a tree over leaves, in order. An empty list has the root of a
+ * single empty leaf.
+ */
+Sha256::Digest MerkleRoot(std::vector<Sha256::Digest> leaves);
+
+/** Number of leaves of an nbyte range (at least one) */
+size_t MerkleLeafCount(uint64_t nbyte, size_t leaf_size = kMerkleLeafSize);
+
+/**
+ * Hash leaves [first, first + count) of the range [offset, offset + nbyte)
+ * of a file and append them to leaves
+ * @return 0 on success, -1 if the file cannot be read
+ */
+int MerkleHashLeaves(const std::string& path, uint64_t offset, uint64_t nbyte,
+                     size_t first, size_t count, size_t leaf_size,
+                     std::vector<Sha256::Digest>& leaves);
+
+/**
+ * Leaves of bytes already in memory that start on a leaf boundary: one per
+ * leaf_size bytes, the last one possibly shorter, none if nbyte is 0
+ */
+std::vector<Sha256::Digest> MerkleLeaves(const void* data, size_t nbyte,
+                                         size_t leaf_size = kMerkleLeafSize);
+
+/**
+ * "merkle:<hex>" root of [offset, offset + nbyte) of a file, hashed by
+ * this process alone
+ * @throws std::runtime_error if the file cannot be read
+ */
+std::string MerkleRootFile(const std::string& path, uint64_t offset,
+                           uint64_t nbyte,
+                           size_t leaf_size = kMerkleLeafSize);
+
+#ifdef USE_MPI
+/**
+ * Collective "merkle:<hex>" root of [offset, offset + nbyte) of a file
+ * every rank can read. Each rank hashes a contiguous share of the leaves;
+ * rank 0 gathers them and broadcasts the root.
+ * @return the root on every rank, or "" on every rank if any read failed
+ */
+std::string MerkleRootMpi(const std::string& path, uint64_t offset,
+                          uint64_t nbyte, MPI_Comm comm,
+                          size_t leaf_size = kMerkleLeafSize);
+
+/**
+ * Collective "merkle:<hex>" root of the leaves the ranks hashed, joined in
+ * rank order; a rank may contribute none
+ * @param failed This rank could not hash its leaves
+ * @return the root on every rank, or "" on every rank if any rank failed
+ */
+std::string MerkleRootGather(const std::vector<Sha256::Digest>& leaves,
+                             bool failed, MPI_Comm comm);
+#endif
+
+}  // namespace cae
+
+#endif  // CAE_MERKLE_H_
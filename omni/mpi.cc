@@ -1,5 +1,12 @@
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include "omni_processing.h"
+
 std::string BuildMpiCommand(const OmniJobConfig::DataEntry &entry, int nprocs,
-                            const std::string &hostfile) {
+                            const std::string &hostfile,
+                            const std::string &program,
+                            const std::string &hosts) {
   std::ostringstream cmd;
 
   // Build description string
@@ -21,6 +28,9 @@ std::string BuildMpiCommand(const OmniJobConfig::DataEntry &entry, int nprocs,
   if (!hostfile.empty()) {
     cmd << " --hostfile " << hostfile;
   }
+  if (!hosts.empty()) {
+    cmd << " --host " << hosts;
+  }
 
   // Forward other important environment variables
   const char *important_env_vars[] = {"PATH",
@@ -41,7 +51,13 @@ std::string BuildMpiCommand(const OmniJobConfig::DataEntry &entry, int nprocs,
   }
 
   cmd << " -np " << nprocs;
-  cmd << " wrp_binary_format_mpi";
+  cmd << " " << program;
+  if (!entry.block.empty()) {
+    cmd << " --block " << entry.block;
+  }
+  if (entry.format == "auto") {
+    cmd << " --detect";
+  }
   cmd << " \"" << entry.paths[0] << "\""; // Use the first (and only) path
   cmd << " " << entry.offset;
   cmd << " " << entry.size;
@@ -1,6 +1,7 @@
 #ifndef OMNI_JOB_CONFIG_H
 #define OMNI_JOB_CONFIG_H
 
+#include <future>
 #include <string>
 #include <vector>
 
@@ -20,6 +21,9 @@ struct OmniJobConfig {
     size_t size;
     std::vector<std::string> description;
     std::string hash;
+    std::string block;  // rank alignment for parallel reads: bytes or "auto"
+    std::string format;  // "auto": reader chosen from the file's magic bytes
+    std::string pattern;  // wildcards or a directory, walked as the job runs
 
 #ifdef  USE_HDF5    
     // HDF5 support
@@ -39,8 +43,10 @@ struct OmniJobConfig {
   OmniJobConfig() : max_scale(100) {}
 };
 
-// Function declarations
-void ProcessDataEntry(const OmniJobConfig::DataEntry &entry, int nprocs, const std::string &hostfile);
-void ProcessDataEntryAsync(const OmniJobConfig::DataEntry &entry, int nprocs, const std::string &hostfile);
+// Run wrp_binary_format_mpi on the first path of an entry, on the hosts of
+// a hostfile or an mpirun --host list; returns the launcher's exit status
+// (0 on success)
+int ProcessDataEntry(const OmniJobConfig::DataEntry &entry, int nprocs, const std::string &hostfile, const std::string &hosts = "");
+std::future<int> ProcessDataEntryAsync(const OmniJobConfig::DataEntry &entry, int nprocs, const std::string &hostfile, const std::string &hosts = "");
 
 #endif // OMNI_JOB_CONFIG_H
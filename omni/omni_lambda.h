@@ -0,0 +1,60 @@
+///
+/// omni_lambda.h
+///
+/// Stable C ABI for in-process OMNI lambdas.
+///
+/// A lambda plugin is a shared object that exports a function with the
+/// omni_lambda_fn signature.  It is referenced from an OMNI YAML file as
+///
+///   run: ./libmy_lambda.so:my_symbol
+///
+/// wrp loads the object with dlopen (LoadLibrary on Windows), hands it the
+/// bytes that were just ingested, and uploads whatever the plugin writes
+/// through the output callback to the 'dst' URI.  No process is spawned
+/// and the input buffer is never copied.
+///
+#ifndef CAE_OMNI_LAMBDA_H_
+#define CAE_OMNI_LAMBDA_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OMNI_LAMBDA_ABI_VERSION 1
+
+#ifdef _WIN32
+#define OMNI_LAMBDA_EXPORT __declspec(dllexport)
+#else
+#define OMNI_LAMBDA_EXPORT __attribute__((visibility("default")))
+#endif
+
+/** Append nbyte bytes to the lambda output. Returns 0 on success. */
+typedef int (*omni_lambda_write_fn)(void* ctx, const void* data, size_t nbyte);
+
+/** Read-only view of the buffer handed to a lambda. */
+typedef struct omni_lambda_input {
+  int abi_version;            /* OMNI_LAMBDA_ABI_VERSION of the host */
+  const char* name;           /* buffer name from the OMNI file */
+  const char* tags;           /* comma separated tags */
+  const char* dest;           /* 'dst' URI the output is sent to */
+  const unsigned char* data;  /* ingested bytes, valid during the call */
+  size_t nbyte;               /* number of bytes in data */
+} omni_lambda_input;
+
+/** Output sink; call write() any number of times. */
+typedef struct omni_lambda_output {
+  void* ctx;
+  omni_lambda_write_fn write;
+} omni_lambda_output;
+
+/** Lambda entry point. Returns 0 on success. */
+typedef int (*omni_lambda_fn)(const omni_lambda_input* in,
+                              const omni_lambda_output* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // CAE_OMNI_LAMBDA_H_
@@ -15,4 +15,24 @@ void ProcessHdf5DataEntry(const OmniJobConfig::DataEntry &entry);
 std::string ExpandPath(const std::string &path);
 std::vector<std::string> ExpandFilePattern(const std::string &pattern);
 
+// Hosts of a hostfile, one per line; runs are placed on them by a
+// cae::NodeScheduler (host.cc, scheduler.h)
+std::vector<std::string> ParseHostfile(const std::string &hostfile_path);
+
+// mpirun command line for one file of a data entry, on the hosts of a
+// hostfile or of an --host list such as "n1:2,n2:1" (mpi.cc)
+std::string BuildMpiCommand(const OmniJobConfig::DataEntry &entry, int nprocs,
+                            const std::string &hostfile,
+                            const std::string &program = "wrp_binary_format_mpi",
+                            const std::string &hosts = "");
+
+// Run every file of every data entry, at most max_scale processes at a
+// time; returns the number of runs that failed (job.cc)
+int RunJob(const OmniJobConfig &config, const std::string &hostfile_path);
+
+// Run the job once, then watch the directories of its data entries and run
+// each batch of files that land in them, until SIGINT or SIGTERM; returns
+// the number of runs that failed (job.cc)
+int WatchJob(const OmniJobConfig &config, const std::string &hostfile_path);
+
 #endif // OMNI_PROCESSING_H
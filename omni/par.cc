@@ -1,12 +1,16 @@
+#include <filesystem>
 #include <iostream>
 #include <string>
 #include <vector>
 #include <yaml-cpp/yaml.h>
 #include "omni_processing.h"
+#include "walk.h"
 #ifdef USE_HDF5
 #include <hdf5.h>
 #endif
 
+namespace fs = std::filesystem;
+
 OmniJobConfig ParseOmniFile(const std::string &yaml_file) {
   OmniJobConfig config;
 
@@ -38,10 +42,19 @@ OmniJobConfig ParseOmniFile(const std::string &yaml_file) {
         std::cout << "Processing YAML entry" << std::endl;
         OmniJobConfig::DataEntry data_entry;
 
-        if (entry["src"]) {
-          std::string expanded_path = ExpandPath(entry["src"].as<std::string>());
-          std::vector<std::string> expanded_files = ExpandFilePattern(expanded_path);
-          data_entry.paths = expanded_files;
+        // 'path' is the job-file spelling of 'src'
+        const YAML::Node src = entry["src"] ? entry["src"] : entry["path"];
+        if (src) {
+          std::string expanded_path = ExpandPath(src.as<std::string>());
+          // Patterns are walked by the job itself, which starts on the
+          // first matches while a large tree is still being listed
+          if (cae::HasWildcards(expanded_path)) {
+            data_entry.pattern = expanded_path;
+          } else if (fs::is_directory(expanded_path)) {
+            data_entry.pattern = (fs::path(expanded_path) / "*").string();
+          } else {
+            data_entry.paths = ExpandFilePattern(expanded_path);
+          }
         }
 
         if (entry["range"]) {
@@ -55,6 +68,30 @@ OmniJobConfig ParseOmniFile(const std::string &yaml_file) {
           data_entry.offset = entry["offset"].as<size_t>();
         }
 
+        if (entry["size"]) {
+          data_entry.size = entry["size"].as<size_t>();
+        }
+
+        if (entry["description"]) {
+          for (const auto &val : entry["description"]) {
+            data_entry.description.push_back(val.as<std::string>());
+          }
+        }
+
+        if (entry["hash"]) {
+          data_entry.hash = entry["hash"].as<std::string>();
+        }
+
+        // Passed to wrp_binary_format_mpi, which splits on block boundaries
+        if (entry["block"]) {
+          data_entry.block = entry["block"].as<std::string>();
+        }
+
+        // "auto" lets wrp_binary_format_mpi pick the reader for each file
+        if (entry["format"]) {
+          data_entry.format = entry["format"].as<std::string>();
+        }
+
         // Removed hash field as it's not defined in DataEntry
 #ifdef  USE_HDF5
         // Parse source path/URL if present
@@ -96,7 +133,7 @@ OmniJobConfig ParseOmniFile(const std::string &yaml_file) {
         config.data_entries.push_back(data_entry);
       }
     }
-#ifndef  USE_HDF5
+#ifdef  USE_HDF5
     std::cout << "Checking for old format HDF5 entry..." << std::endl;
     if (yaml["src"] && yaml["src"].as<std::string>().find("hdf5://") == 0) {
       // Old format with direct HDF5 fields (compatibility with tf.yaml, tf3d.yaml)
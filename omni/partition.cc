@@ -0,0 +1,117 @@
+///
+/// partition.cc
+///
+#include "partition.h"
+
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/statfs.h>
+#include <sys/xattr.h>
+#endif
+
+#include <cstdlib>
+#include <cstring>
+
+namespace cae {
+
+Slice PartitionRange(uint64_t offset, uint64_t nbyte, int rank, int nranks) {
+  Slice slice;
+  if (nranks <= 0 || rank < 0 || rank >= nranks) {
+    return slice;
+  }
+  // The first nbyte % nranks ranks take one extra byte
+  uint64_t n = static_cast<uint64_t>(nranks);
+  uint64_t r = static_cast<uint64_t>(rank);
+  uint64_t base = nbyte / n;
+  uint64_t extra = nbyte % n;
+  slice.offset = offset + r * base + (r < extra ? r : extra);
+  slice.nbyte = base + (r < extra ? 1 : 0);
+  return slice;
+}
+
+Slice PartitionAligned(uint64_t offset, uint64_t nbyte, uint64_t block,
+                       int rank, int nranks) {
+  if (block <= 1) {
+    return PartitionRange(offset, nbyte, rank, nranks);
+  }
+  Slice slice;
+  if (nranks <= 0 || rank < 0 || rank >= nranks) {
+    return slice;
+  }
+  // Units are the blocks the range touches: unit k ends at base + (k+1)
+  // * block, except that the first starts at offset and the last ends at
+  // the end of the range
+  uint64_t end = offset + nbyte;
+  uint64_t base = offset - offset % block;
+  uint64_t units = nbyte == 0 ? 0 : (end - base + block - 1) / block;
+  Slice share = PartitionRange(0, units, rank, nranks);
+  auto boundary = [&](uint64_t k) {
+    if (k == 0) {
+      return offset;
+    }
+    return k >= units ? end : base + k * block;
+  };
+  slice.offset = boundary(share.offset);
+  slice.nbyte = boundary(share.offset + share.nbyte) - slice.offset;
+  return slice;
+}
+
+uint64_t DetectBlockSize(const std::string& path) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) {
+    return 0;
+  }
+#ifdef __linux__
+  // Lustre keeps the layout in the lustre.lov xattr; a plain (v1/v3)
+  // layout has the stripe size right after the object id
+  const long kLustreSuperMagic = 0x0BD00BD0;
+  const uint32_t kLovMagicV1 = 0x0BD10BD0;
+  const uint32_t kLovMagicV3 = 0x0BD30BD0;
+  struct statfs fs;
+  if (statfs(path.c_str(), &fs) == 0 &&
+      static_cast<long>(fs.f_type) == kLustreSuperMagic) {
+    unsigned char lov[4096];
+    ssize_t n = getxattr(path.c_str(), "lustre.lov", lov, sizeof(lov));
+    uint32_t magic = 0;
+    uint32_t stripe_size = 0;
+    if (n >= 28) {
+      std::memcpy(&magic, lov, sizeof(magic));
+      std::memcpy(&stripe_size, lov + 24, sizeof(stripe_size));
+    }
+    if ((magic == kLovMagicV1 || magic == kLovMagicV3) && stripe_size > 0) {
+      return stripe_size;
+    }
+  }
+#endif
+#ifdef _WIN32
+  return 0;  // no preferred I/O size in the Windows stat
+#else
+  return st.st_blksize > 0 ? static_cast<uint64_t>(st.st_blksize) : 0;
+#endif
+}
+
+bool ParseByteSize(const std::string& text, uint64_t& nbyte) {
+  char* end = nullptr;
+  unsigned long long n = std::strtoull(text.c_str(), &end, 10);
+  if (text.empty() || end == text.c_str() || text[0] == '-') {
+    return false;
+  }
+  std::string unit(end);
+  if (unit == "K" || unit == "k") {
+    n <<= 10;
+  } else if (unit == "M" || unit == "m") {
+    n <<= 20;
+  } else if (unit == "G" || unit == "g") {
+    n <<= 30;
+  } else if (!unit.empty()) {
+    return false;
+  }
+  nbyte = n;
+  return true;
+}
+
+std::string StripeName(const std::string& name, int rank) {
+  return name + "." + std::to_string(rank);
+}
+
+}  // namespace cae
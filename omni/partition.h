@@ -0,0 +1,66 @@
+///
+/// partition.h
+///
+/// Splitting one descriptor's byte range across MPI ranks. Each rank reads
+/// and stores its own contiguous slice as a stripe buffer <name>.<rank>;
+/// rank 0 then catalogs <name> as a striped buffer made of those stripes.
+///
+/// Parallel readers of one file (wrp_binary_format_mpi and the jobs that
+/// launch it) split on block boundaries instead, so no two ranks share a
+/// filesystem stripe or page.
+///
+#ifndef CAE_PARTITION_H_
+#define CAE_PARTITION_H_
+
+#include <cstdint>
+#include <string>
+
+namespace cae {
+
+/**
+ * Contiguous byte range of a source
+ */
+struct Slice {
+  uint64_t offset = 0;
+  uint64_t nbyte = 0;
+};
+
+/**
+ * Slice of [offset, offset + nbyte) read by one rank. Slices are in rank
+ * order, cover the range exactly, and differ in size by at most one byte.
+ * @param rank This rank, 0 <= rank < nranks
+ * @param nranks Number of ranks sharing the range
+ */
+Slice PartitionRange(uint64_t offset, uint64_t nbyte, int rank, int nranks);
+
+/**
+ * Slice of [offset, offset + nbyte) read by one rank, with every boundary
+ * between ranks on a multiple of block (an absolute file offset). Whole
+ * blocks are balanced, so slices differ by at most one block plus the
+ * partial blocks at either end. A block of 0 or 1 splits bytes evenly as
+ * PartitionRange does.
+ */
+Slice PartitionAligned(uint64_t offset, uint64_t nbyte, uint64_t block,
+                       int rank, int nranks);
+
+/**
+ * Preferred block size for parallel reads of a file: the stripe size on
+ * Lustre, otherwise the filesystem's st_blksize
+ * @return 0 if the file cannot be examined
+ */
+uint64_t DetectBlockSize(const std::string& path);
+
+/**
+ * Parse a byte count with an optional K, M or G (binary) suffix
+ * @return false if text is not a number or has another suffix
+ */
+bool ParseByteSize(const std::string& text, uint64_t& nbyte);
+
+/**
+ * Name of the stripe buffer stored by a rank: "<name>.<rank>"
+ */
+std::string StripeName(const std::string& name, int rank);
+
+}  // namespace cae
+
+#endif  // CAE_PARTITION_H_
@@ -2,12 +2,11 @@
 #include <iostream>
 #include <stdexcept>
 #include <string>
-#include <regex>
 #include <vector>
 #include <algorithm>
+#include "walk.h"
 
 #ifndef _WIN32
-#include <glob.h>
 #include <pwd.h>
 #include <unistd.h>
 #endif
@@ -65,48 +64,6 @@ std::string ExpandPath(const std::string &path) {
   return path;
 }
 
-// Cross-platform file pattern matching using std::filesystem
-void expandPattern(const fs::path& pattern_path,
-		   std::vector<std::string>& files) {
-  try {
-    std::string pattern_str = pattern_path.string();
-    fs::path parent_path = pattern_path.parent_path();
-    std::string filename_pattern = pattern_path.filename().string();
-    
-    if (parent_path.empty()) {
-      parent_path = ".";
-    }
-    
-    if (!fs::exists(parent_path) || !fs::is_directory(parent_path)) {
-      return;
-    }
-    
-    // Convert simple wildcards to regex
-    std::string regex_pattern = filename_pattern;
-    // Escape regex special characters except * and ?
-    std::regex special_chars(R"([\.^$+{}()[\]|])");
-    regex_pattern = std::regex_replace(regex_pattern, special_chars, R"(\$&)");
-    // Convert wildcards to regex
-    std::regex star(R"(\\\*)"); // escaped *
-    regex_pattern = std::regex_replace(regex_pattern, star, ".*");
-    std::regex question(R"(\\\?)"); // escaped ?
-    regex_pattern = std::regex_replace(regex_pattern, question, ".");
-    
-    std::regex pattern_regex(regex_pattern, std::regex_constants::icase);
-    
-    for (const auto& entry : fs::directory_iterator(parent_path)) {
-      if (entry.is_regular_file()) {
-        std::string filename = entry.path().filename().string();
-        if (std::regex_match(filename, pattern_regex)) {
-          files.push_back(entry.path().string());
-        }
-      }
-    }
-  } catch (const std::exception& e) {
-    std::cerr << "Error expanding pattern: " << e.what() << std::endl;
-  }
-}
-
 std::vector<std::string> ExpandFilePattern(const std::string &pattern) {
   std::vector<std::string> files;
   
@@ -121,34 +78,14 @@ std::vector<std::string> ExpandFilePattern(const std::string &pattern) {
   std::string expanded_pattern = ExpandPath(pattern);
   
   // Check if the pattern contains wildcards
-  bool has_wildcards = (expanded_pattern.find('*') != std::string::npos) || 
-    (expanded_pattern.find('?') != std::string::npos);
+  bool has_wildcards = cae::HasWildcards(expanded_pattern);
   
   if (has_wildcards) {
-#ifdef _WIN32
-    // Use filesystem-based pattern matching for Windows
-    expandPattern(fs::path(expanded_pattern), files);
-#else
-    // Use glob for POSIX systems
-    glob_t glob_result;
-    int glob_ret = glob(expanded_pattern.c_str(), GLOB_TILDE | GLOB_BRACE, nullptr, &glob_result);
-    
-    if (glob_ret == 0) {
-      for (size_t i = 0; i < glob_result.gl_pathc; ++i) {
-        std::string file_path = glob_result.gl_pathv[i];
-        if (fs::is_regular_file(file_path)) {
-          files.push_back(file_path);
-        }
-      }
-    } else if (glob_ret == GLOB_NOMATCH) {
+    // Parallel getdents64 walk, with ** and {a,b} (see walk.h)
+    files = cae::WalkPattern(expanded_pattern);
+    if (files.empty()) {
       std::cerr << "Warning: No files match pattern: " << expanded_pattern << std::endl;
-    } else {
-      std::cerr << "Warning: Error expanding pattern: " << expanded_pattern << " (error code: " << glob_ret << ")" << std::endl;
     }
-    
-    globfree(&glob_result);
-#endif
-    
     std::cout << "Expanded pattern '" << pattern << "' to " << files.size() << " files" << std::endl;
   } else {
     // Check if it's a directory
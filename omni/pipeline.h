@@ -0,0 +1,156 @@
+///
+/// pipeline.h
+///
+/// Bounded queues and a linear multi-stage pipeline. Each stage runs on its
+/// own thread, so stage N of one item overlaps stage N-1 of the next.
+///
+#ifndef CAE_PIPELINE_H_
+#define CAE_PIPELINE_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace cae {
+
+/** Blocking FIFO with a fixed capacity. */
+template <typename T>
+class BoundedQueue {
+ public:
+  explicit BoundedQueue(size_t capacity) : capacity_(capacity ? capacity : 1) {}
+
+  /** Blocks while full. Returns false if the queue was closed. */
+  bool Push(T item) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+    if (closed_) {
+      return false;
+    }
+    items_.push_back(std::move(item));
+    not_empty_.notify_one();
+    return true;
+  }
+
+  /** Blocks while empty. Returns false once closed and drained. */
+  bool Pop(T& item) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+    if (items_.empty()) {
+      return false;
+    }
+    item = std::move(items_.front());
+    items_.pop_front();
+    not_full_.notify_one();
+    return true;
+  }
+
+  /** Wakes all waiters; queued items can still be popped. */
+  void Close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    not_empty_.notify_all();
+    not_full_.notify_all();
+  }
+
+ private:
+  size_t capacity_;
+  bool closed_ = false;
+  std::deque<T> items_;
+  std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+};
+
+/** Timing collected for one pipeline stage. */
+struct StageStats {
+  std::string name;
+  size_t items = 0;
+  double busy_seconds = 0.0;  // time spent inside the stage function
+  double idle_seconds = 0.0;  // time spent waiting for input
+};
+
+/** Linear pipeline of named stages connected by bounded queues. */
+template <typename T>
+class Pipeline {
+ public:
+  using StageFn = std::function<void(T&)>;
+
+  explicit Pipeline(size_t queue_depth = 2) : queue_depth_(queue_depth) {}
+
+  void AddStage(const std::string& name, StageFn fn) {
+    stages_.push_back({name, std::move(fn)});
+  }
+
+  /** Pushes every item through all stages and returns per-stage timing. */
+  std::vector<StageStats> Run(const std::vector<T>& items) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<StageStats> stats(stages_.size());
+    if (stages_.empty()) {
+      return stats;
+    }
+
+    std::vector<std::unique_ptr<BoundedQueue<T>>> queues;
+    for (size_t i = 0; i < stages_.size(); ++i) {
+      queues.push_back(std::make_unique<BoundedQueue<T>>(queue_depth_));
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < stages_.size(); ++i) {
+      threads.emplace_back([this, i, &queues, &stats] {
+        StageStats& st = stats[i];
+        st.name = stages_[i].name;
+        BoundedQueue<T>& in = *queues[i];
+        T item;
+        while (true) {
+          auto wait_start = Clock::now();
+          if (!in.Pop(item)) {
+            break;
+          }
+          auto start = Clock::now();
+          st.idle_seconds +=
+              std::chrono::duration<double>(start - wait_start).count();
+          stages_[i].fn(item);
+          st.busy_seconds +=
+              std::chrono::duration<double>(Clock::now() - start).count();
+          ++st.items;
+          if (i + 1 < queues.size()) {
+            queues[i + 1]->Push(std::move(item));
+          }
+        }
+        if (i + 1 < queues.size()) {
+          queues[i + 1]->Close();
+        }
+      });
+    }
+
+    for (const T& item : items) {
+      queues[0]->Push(item);
+    }
+    queues[0]->Close();
+    for (std::thread& t : threads) {
+      t.join();
+    }
+    return stats;
+  }
+
+ private:
+  struct Stage {
+    std::string name;
+    StageFn fn;
+  };
+
+  size_t queue_depth_;
+  std::vector<Stage> stages_;
+};
+
+}  // namespace cae
+
+#endif  // CAE_PIPELINE_H_
@@ -2,9 +2,13 @@
 #define CAE_REPO_FILESYSTEM_REPO_OMNI_H_
 
 #include "repo_client.h"
+#include "../format/format_factory.h"
+#include "../scale_model.h"
 #include <algorithm>
 #include <iostream>
+#include <string>
 #include <sys/stat.h>
+#include <vector>
 
 // Windows compatibility for S_ISREG macro
 #ifdef _WIN32
@@ -20,7 +24,8 @@ namespace cae {
 
 /**
  * Filesystem repository client implementation
- * Recommends scale based on file size (minimum 64MB per process)
+ * Recommends scale from the history of past runs (see scale_model.h), or
+ * from file size (minimum 64MB per process) until there is one
  */
 class FilesystemRepoClient : public RepoClient {
 private:
@@ -28,19 +33,39 @@ private:
 
 public:
   /**
-   * Recommend scale based on file size
-   * Objective: at least 64MB per process
+   * @param history Run history to learn from; "" uses the size rule only
+   */
+  explicit FilesystemRepoClient(
+      const std::string &history = ScaleModel::DefaultPath()) {
+    if (!history.empty()) {
+      model_.Load(history);
+    }
+  }
+
+  /**
+   * Recommend scale for a read of the median size of past runs
    * @param max_scale Maximum number of processes allowed
    * @param nprocs Output: recommended number of processes
    * @param nthreads Output: recommended number of threads per process
    */
   void RecommendScale(int max_scale, int &nprocs, int &nthreads) override {
-    // For filesystem operations, we typically don't need multiple threads per
-    // process
     nthreads = 1;
-
-    // Default to single process if we can't determine file size
     nprocs = 1;
+    const std::vector<ScaleObservation> &runs = model_.Observations();
+    if (runs.empty()) {
+      return;
+    }
+    std::vector<uint64_t> bytes;
+    for (const ScaleObservation &run : runs) {
+      bytes.push_back(run.bytes);
+    }
+    std::nth_element(bytes.begin(), bytes.begin() + bytes.size() / 2,
+                     bytes.end());
+    if (!model_.Recommend("", "", bytes[bytes.size() / 2], max_scale, nprocs,
+                          nthreads)) {
+      nprocs = 1;
+      nthreads = 1;
+    }
   }
 
   /**
@@ -91,23 +116,38 @@ public:
                              int &nprocs, int &nthreads) {
     size_t file_size = GetFileSize(file_path);
 
-    // Calculate number of processes needed for at least 64MB per process
-    if (file_size <= MIN_BYTES_PER_PROCESS) {
-      nprocs = 1;
-    } else {
-      nprocs = static_cast<int>((file_size + MIN_BYTES_PER_PROCESS - 1) /
-                                MIN_BYTES_PER_PROCESS);
-      nprocs = std::min(nprocs, max_scale);
+    // Past runs of the same format and medium know where reads stop
+    // scaling; without them, at least 64MB per process
+    Format format = Format::kBinary;
+    FormatFactory::DetectFormat(file_path, format);
+    bool learned = model_.Recommend(FormatFactory::Name(format),
+                                    ScaleModel::StorageMedium(file_path),
+                                    file_size, max_scale, nprocs, nthreads);
+    if (!learned) {
+      if (file_size <= MIN_BYTES_PER_PROCESS) {
+        nprocs = 1;
+      } else {
+        nprocs = static_cast<int>((file_size + MIN_BYTES_PER_PROCESS - 1) /
+                                  MIN_BYTES_PER_PROCESS);
+        nprocs = std::min(nprocs, max_scale);
+      }
+
+      // For filesystem operations, single thread per process is usually
+      // optimal
+      nthreads = 1;
     }
 
-    // For filesystem operations, single thread per process is usually optimal
-    nthreads = 1;
-
     std::cout << "Recommended scale for file " << file_path
               << " (size: " << file_size << " bytes): " << nprocs
               << " processes, " << nthreads << " threads per process"
-              << std::endl;
+              << (learned ? " (from run history)" : "") << std::endl;
   }
+
+  /** The run history recommendations are learned from */
+  const ScaleModel &Model() const { return model_; }
+
+private:
+  ScaleModel model_;
 };
 
 } // namespace cae
@@ -0,0 +1,251 @@
+///
+/// scale_model.cc
+///
+#include "scale_model.h"
+#include "format/format_factory.h"
+
+#ifdef __linux__
+#include <sys/statfs.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <sstream>
+
+namespace cae {
+
+namespace {
+
+std::mutex history_mutex;
+
+// Bytes are fitted in GB, so the normal equations stay well scaled
+constexpr double kGigabyte = 1e9;
+
+// Least squares of seconds on the features of the terms in use; terms
+// that come out negative are dropped and the rest refitted
+bool SolveFit(const std::vector<const ScaleObservation*>& obs, ScaleFit& fit) {
+  bool use[3] = {true, true, true};  // c, a, b
+  for (int round = 0; round < 3; ++round) {
+    double m[3][4] = {};  // normal equations with the right-hand side
+    for (const ScaleObservation* o : obs) {
+      int r = o->nprocs * o->nthreads;
+      double gb = static_cast<double>(o->bytes) / kGigabyte;
+      double x[3] = {1.0, gb, gb / r};
+      for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+          m[i][j] += x[i] * x[j];
+        }
+        m[i][3] += x[i] * o->seconds;
+      }
+    }
+    // Terms out of use are pinned to zero
+    for (int i = 0; i < 3; ++i) {
+      if (!use[i]) {
+        for (int j = 0; j < 3; ++j) {
+          m[i][j] = 0.0;
+          m[j][i] = 0.0;
+        }
+        m[i][i] = 1.0;
+        m[i][3] = 0.0;
+      }
+    }
+    // Gaussian elimination with partial pivoting; a term the runs cannot
+    // tell apart from the others (e.g. a when every run read the same
+    // bytes) is dropped
+    double diag[3] = {m[0][0], m[1][1], m[2][2]};
+    bool singular = false;
+    for (int col = 0; col < 3 && !singular; ++col) {
+      int pivot = col;
+      for (int row = col + 1; row < 3; ++row) {
+        if (std::fabs(m[row][col]) > std::fabs(m[pivot][col])) {
+          pivot = row;
+        }
+      }
+      if (std::fabs(m[pivot][col]) <= 1e-12 * diag[col]) {
+        use[col] = false;
+        singular = true;
+        break;
+      }
+      for (int j = 0; j < 4; ++j) {
+        std::swap(m[col][j], m[pivot][j]);
+      }
+      for (int row = 0; row < 3; ++row) {
+        if (row != col) {
+          double f = m[row][col] / m[col][col];
+          for (int j = col; j < 4; ++j) {
+            m[row][j] -= f * m[col][j];
+          }
+        }
+      }
+    }
+    if (singular) {
+      continue;
+    }
+    double coef[3];
+    bool negative = false;
+    for (int i = 0; i < 3; ++i) {
+      coef[i] = use[i] ? m[i][3] / m[i][i] : 0.0;
+      if (use[i] && coef[i] < 0.0) {
+        use[i] = false;
+        negative = true;
+      }
+    }
+    if (!negative) {
+      fit.c = coef[0];
+      fit.a = coef[1] / kGigabyte;
+      fit.b = coef[2] / kGigabyte;
+      fit.observations = obs.size();
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+std::string ScaleModel::DefaultPath() {
+  if (const char* path = std::getenv("OMNI_SCALE_HISTORY")) {
+    return path;
+  }
+  const char* home = std::getenv("HOME");
+  if (home == nullptr || *home == '\0') {
+    return "";
+  }
+  return std::string(home) + "/.wrp/scale_history";
+}
+
+std::string ScaleModel::StorageMedium(const std::string& path) {
+#ifdef __linux__
+  struct statfs fs;
+  if (statfs(path.c_str(), &fs) != 0) {
+    return "unknown";
+  }
+  switch (static_cast<unsigned long>(fs.f_type)) {
+    case 0xEF53: return "ext4";
+    case 0x58465342: return "xfs";
+    case 0x9123683E: return "btrfs";
+    case 0x01021994: return "tmpfs";
+    case 0x6969: return "nfs";
+    case 0x0BD00BD0: return "lustre";
+    case 0x47504653: return "gpfs";
+    case 0x794C7630: return "overlay";
+    default: {
+      char hex[32];
+      std::snprintf(hex, sizeof(hex), "0x%lx",
+                    static_cast<unsigned long>(fs.f_type));
+      return hex;
+    }
+  }
+#else
+  return "unknown";
+#endif
+}
+
+int ScaleModel::Append(const std::string& path, const ScaleObservation& obs) {
+  if (path.empty() || obs.bytes == 0 || obs.seconds <= 0.0) {
+    return 1;
+  }
+  std::ostringstream line;
+  line << (obs.format.empty() ? "-" : obs.format) << '\t'
+       << (obs.medium.empty() ? "-" : obs.medium) << '\t' << obs.bytes << '\t'
+       << obs.nprocs << '\t' << obs.nthreads << '\t' << obs.seconds << '\n';
+
+  std::lock_guard<std::mutex> lock(history_mutex);
+  std::error_code ec;
+  std::filesystem::path parent = std::filesystem::path(path).parent_path();
+  if (!parent.empty()) {
+    std::filesystem::create_directories(parent, ec);
+  }
+  std::ofstream out(path, std::ios::app);
+  out << line.str();
+  out.flush();
+  return out ? 0 : 1;
+}
+
+int ScaleModel::Record(const std::string& file, uint64_t bytes, int nprocs,
+                       int nthreads, double seconds) {
+  ScaleObservation obs;
+  Format format = Format::kBinary;
+  FormatFactory::DetectFormat(file, format);
+  obs.format = FormatFactory::Name(format);
+  obs.medium = StorageMedium(file);
+  obs.bytes = bytes;
+  obs.nprocs = nprocs;
+  obs.nthreads = nthreads;
+  obs.seconds = seconds;
+  return Append(DefaultPath(), obs);
+}
+
+void ScaleModel::Load(const std::string& path) {
+  std::ifstream in(path);
+  std::deque<ScaleObservation> recent;
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream fields(line);
+    ScaleObservation obs;
+    if (!(fields >> obs.format >> obs.medium >> obs.bytes >> obs.nprocs >>
+          obs.nthreads >> obs.seconds) ||
+        obs.nprocs < 1 || obs.nthreads < 1 || obs.seconds <= 0.0) {
+      continue;
+    }
+    recent.push_back(obs);
+    if (recent.size() > kMaxObservations) {
+      recent.pop_front();
+    }
+  }
+  for (const ScaleObservation& obs : recent) {
+    Add(obs);
+  }
+}
+
+void ScaleModel::Add(const ScaleObservation& obs) {
+  observations_.push_back(obs);
+}
+
+bool ScaleModel::Fit(const std::string& format, const std::string& medium,
+                     ScaleFit& fit) const {
+  std::vector<const ScaleObservation*> matched;
+  std::set<int> scales;
+  for (const ScaleObservation& obs : observations_) {
+    if ((format.empty() || obs.format == format) &&
+        (medium.empty() || obs.medium == medium)) {
+      matched.push_back(&obs);
+      scales.insert(obs.nprocs * obs.nthreads);
+    }
+  }
+  // The split between a and b needs runs at two scales at least
+  if (matched.size() < kMinObservations || scales.size() < 2) {
+    return false;
+  }
+  return SolveFit(matched, fit);
+}
+
+bool ScaleModel::Recommend(const std::string& format, const std::string& medium,
+                           uint64_t bytes, int max_scale, int& nprocs,
+                           int& nthreads) const {
+  ScaleFit fit;
+  if (!Fit(format, medium, fit) && !Fit(format, "", fit) &&
+      !Fit("", "", fit)) {
+    return false;
+  }
+  // Readers are processes; the threads of past runs only count as readers
+  nthreads = 1;
+  nprocs = 1;
+  double one = fit.Seconds(bytes, 1);
+  for (int r = 2; r <= max_scale; ++r) {
+    if (one / (r * fit.Seconds(bytes, r)) < kMinEfficiency) {
+      break;
+    }
+    nprocs = r;
+  }
+  return true;
+}
+
+}  // namespace cae
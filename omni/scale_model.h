@@ -0,0 +1,121 @@
+///
+/// scale_model.h
+///
+/// Process counts learned from past runs. Each finished run appends one
+/// observation (format, storage medium, bytes, processes, threads, wall
+/// time) to a history file. Recommendations fit
+///
+///   seconds = c + bytes * (a + b / r),   r = nprocs * nthreads
+///
+/// by least squares with non-negative terms: c is the launch cost, a the
+/// per-byte time no reader can share (the storage limit) and b the time
+/// that divides over readers. The recommended r is the largest whose
+/// parallel efficiency t(1) / (r * t(r)) is still kMinEfficiency, so reads
+/// that plateau early get few processes.
+///
+#ifndef CAE_SCALE_MODEL_H_
+#define CAE_SCALE_MODEL_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cae {
+
+/**
+ * One finished run
+ */
+struct ScaleObservation {
+  std::string format;  // FormatFactory::Name of the file, e.g. "csv"
+  std::string medium;  // filesystem type, e.g. "ext4", "lustre"
+  uint64_t bytes = 0;
+  int nprocs = 1;
+  int nthreads = 1;
+  double seconds = 0.0;
+};
+
+/**
+ * Fitted seconds = c + bytes * (a + b / r)
+ */
+struct ScaleFit {
+  double c = 0.0;
+  double a = 0.0;
+  double b = 0.0;
+  size_t observations = 0;
+
+  double Seconds(uint64_t bytes, int r) const {
+    return c + static_cast<double>(bytes) * (a + b / r);
+  }
+};
+
+/**
+ * History of runs and the scale recommended from it
+ */
+class ScaleModel {
+ public:
+  /** Lowest parallel efficiency a recommendation accepts */
+  static constexpr double kMinEfficiency = 0.75;
+  /** Observations of a format and medium needed before they are used */
+  static constexpr size_t kMinObservations = 3;
+  /** Most recent observations kept when a history is loaded */
+  static constexpr size_t kMaxObservations = 10000;
+
+  /**
+   * History file: $OMNI_SCALE_HISTORY if set (empty disables history),
+   * else ~/.wrp/scale_history
+   */
+  static std::string DefaultPath();
+
+  /** Filesystem type of the file system holding path */
+  static std::string StorageMedium(const std::string& path);
+
+  /**
+   * Append an observation to a history file (creating its directory);
+   * safe to call from concurrent threads
+   * @return 0 on success, 1 if the file cannot be written
+   */
+  static int Append(const std::string& path, const ScaleObservation& obs);
+
+  /**
+   * Append a finished read of a file, with its detected format and
+   * medium, to the DefaultPath() history
+   * @return 0 on success, 1 if history is disabled or cannot be written
+   */
+  static int Record(const std::string& file, uint64_t bytes, int nprocs,
+                    int nthreads, double seconds);
+
+  /**
+   * Load the last kMaxObservations of a history file; a missing file is
+   * an empty history and malformed lines are skipped
+   */
+  void Load(const std::string& path);
+
+  void Add(const ScaleObservation& obs);
+
+  const std::vector<ScaleObservation>& Observations() const {
+    return observations_;
+  }
+
+  /**
+   * Fit the observations of a format and medium ("" matches any)
+   * @return false if they are too few or all at one scale
+   */
+  bool Fit(const std::string& format, const std::string& medium,
+           ScaleFit& fit) const;
+
+  /**
+   * Scale for reading bytes of a format on a medium: the fit of that
+   * format and medium, else of the format, else of every observation
+   * @return false if no fit is possible (callers keep their own rule)
+   */
+  bool Recommend(const std::string& format, const std::string& medium,
+                 uint64_t bytes, int max_scale, int& nprocs,
+                 int& nthreads) const;
+
+ private:
+  std::vector<ScaleObservation> observations_;
+};
+
+}  // namespace cae
+
+#endif  // CAE_SCALE_MODEL_H_
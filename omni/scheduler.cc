@@ -0,0 +1,129 @@
+///
+/// scheduler.cc
+///
+#include "scheduler.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace cae {
+
+NodeScheduler::NodeScheduler(std::vector<std::string> hosts)
+    : hosts_(std::move(hosts)),
+      load_(hosts_.size(), 0.0),
+      heap_(hosts_.size()),
+      position_(hosts_.size()) {
+  // All loads are equal, so index order is already a valid heap
+  for (size_t i = 0; i < hosts_.size(); ++i) {
+    heap_[i] = static_cast<int>(i);
+    position_[i] = i;
+  }
+}
+
+double NodeScheduler::Weight(uint64_t bytes, double seconds) {
+  if (seconds > 0.0) {
+    return seconds;
+  }
+  return kRunSeconds + static_cast<double>(bytes) / kBytesPerSecond;
+}
+
+NodeScheduler::Allocation NodeScheduler::Allocate(int num_nodes,
+                                                  double weight) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Allocation allocation;
+  num_nodes = std::min(std::max(num_nodes, 1), Size());
+  if (num_nodes == 0) {
+    return allocation;
+  }
+  allocation.load = weight / num_nodes;
+
+  // Pop the k least-loaded nodes to the back of the heap, then push them
+  // again with their new load, so the same node is never taken twice
+  size_t live = heap_.size();
+  for (int i = 0; i < num_nodes; ++i) {
+    allocation.nodes.push_back(heap_[0]);
+    Swap(0, --live);
+    SiftDown(0, live);
+  }
+  for (int node : allocation.nodes) {
+    load_[node] += allocation.load;
+  }
+  for (size_t i = live; i < heap_.size(); ++i) {
+    SiftUp(i);
+  }
+  return allocation;
+}
+
+void NodeScheduler::Release(const Allocation& allocation) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (int node : allocation.nodes) {
+    // A lower load only moves a node towards the top; rounding must not
+    // leave an idle node looking busy
+    load_[node] -= allocation.load;
+    if (load_[node] < 1e-9) {
+      load_[node] = 0.0;
+    }
+    SiftUp(position_[node]);
+  }
+}
+
+double NodeScheduler::Load(int node) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return load_[node];
+}
+
+std::string NodeScheduler::HostList(const Allocation& allocation,
+                                    int nprocs) const {
+  std::string list;
+  int k = static_cast<int>(allocation.nodes.size());
+  for (int i = 0; i < k; ++i) {
+    int slots = nprocs / k + (i < nprocs % k ? 1 : 0);
+    if (slots == 0) {
+      break;
+    }
+    if (!list.empty()) {
+      list += ",";
+    }
+    list += hosts_[allocation.nodes[i]] + ":" + std::to_string(slots);
+  }
+  return list;
+}
+
+bool NodeScheduler::Less(int a, int b) const {
+  return load_[a] < load_[b] || (load_[a] == load_[b] && a < b);
+}
+
+void NodeScheduler::Swap(size_t i, size_t j) {
+  std::swap(heap_[i], heap_[j]);
+  position_[heap_[i]] = i;
+  position_[heap_[j]] = j;
+}
+
+void NodeScheduler::SiftUp(size_t i) {
+  while (i > 0) {
+    size_t parent = (i - 1) / 2;
+    if (!Less(heap_[i], heap_[parent])) {
+      break;
+    }
+    Swap(i, parent);
+    i = parent;
+  }
+}
+
+void NodeScheduler::SiftDown(size_t i, size_t size) {
+  for (;;) {
+    size_t best = i;
+    for (size_t child = 2 * i + 1; child <= 2 * i + 2; ++child) {
+      if (child < size && Less(heap_[child], heap_[best])) {
+        best = child;
+      }
+    }
+    if (best == i) {
+      return;
+    }
+    Swap(i, best);
+    i = best;
+  }
+}
+
+}  // namespace cae
@@ -0,0 +1,82 @@
+///
+/// scheduler.h
+///
+/// Placement of concurrent job runs on the hosts of a hostfile. Each node
+/// carries a load in expected busy seconds; a run takes the least-loaded
+/// nodes, adds its share of work to them and gives it back when it ends.
+/// Nodes sit in an indexed min-heap, so a run costs O(k log n) for k nodes
+/// instead of a sort of every node.
+///
+#ifndef CAE_SCHEDULER_H_
+#define CAE_SCHEDULER_H_
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cae {
+
+/**
+ * Least-loaded placement of runs on hosts, safe to share between threads
+ */
+class NodeScheduler {
+ public:
+  /** Fixed cost of one run on a node: launch and wire-up */
+  static constexpr double kRunSeconds = 1.0;
+  /** Read rate assumed for a run without a runtime estimate */
+  static constexpr double kBytesPerSecond = 500e6;
+
+  /**
+   * Nodes a run holds and the load it added to each of them
+   */
+  struct Allocation {
+    std::vector<int> nodes;
+    double load = 0.0;
+  };
+
+  explicit NodeScheduler(std::vector<std::string> hosts);
+
+  /**
+   * Expected busy seconds of a run: its runtime estimate if it has one,
+   * else the launch cost plus its bytes at kBytesPerSecond
+   */
+  static double Weight(uint64_t bytes, double seconds = 0.0);
+
+  /**
+   * Take the num_nodes least-loaded distinct nodes (ties to the lower
+   * index) and add an equal share of weight to each
+   */
+  Allocation Allocate(int num_nodes, double weight);
+
+  /** Give back the load of a finished run */
+  void Release(const Allocation& allocation);
+
+  /** Current load of a node */
+  double Load(int node) const;
+
+  /** Number of nodes */
+  int Size() const { return static_cast<int>(hosts_.size()); }
+
+  /**
+   * mpirun --host list for nprocs processes on the nodes of an allocation,
+   * e.g. "n1:2,n2:1"
+   */
+  std::string HostList(const Allocation& allocation, int nprocs) const;
+
+ private:
+  bool Less(int a, int b) const;
+  void Swap(size_t i, size_t j);
+  void SiftUp(size_t i);
+  void SiftDown(size_t i, size_t size);
+
+  std::vector<std::string> hosts_;
+  std::vector<double> load_;
+  std::vector<int> heap_;         // node indices, least-loaded first
+  std::vector<size_t> position_;  // of each node in heap_
+  mutable std::mutex mutex_;
+};
+
+}  // namespace cae
+
+#endif  // CAE_SCHEDULER_H_
@@ -0,0 +1,162 @@
+///
+/// sha256.cc
+///
+#include "sha256.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace cae {
+
+static const uint32_t kRound[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+static inline uint32_t Rotr(uint32_t x, int n) {
+  return (x >> n) | (x << (32 - n));
+}
+
+void Sha256::Reset() {
+  static const uint32_t kInit[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372,
+                                    0xa54ff53a, 0x510e527f, 0x9b05688c,
+                                    0x1f83d9ab, 0x5be0cd19};
+  std::memcpy(state_, kInit, sizeof(state_));
+  length_ = 0;
+  used_ = 0;
+}
+
+void Sha256::Block(const uint8_t* p) {
+  uint32_t w[64];
+  for (int i = 0; i < 16; ++i) {
+    w[i] = (uint32_t(p[4 * i]) << 24) | (uint32_t(p[4 * i + 1]) << 16) |
+           (uint32_t(p[4 * i + 2]) << 8) | uint32_t(p[4 * i + 3]);
+  }
+  for (int i = 16; i < 64; ++i) {
+    uint32_t s0 = Rotr(w[i - 15], 7) ^ Rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    uint32_t s1 = Rotr(w[i - 2], 17) ^ Rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+
+  uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+  uint32_t e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+  for (int i = 0; i < 64; ++i) {
+    uint32_t s1 = Rotr(e, 6) ^ Rotr(e, 11) ^ Rotr(e, 25);
+    uint32_t ch = (e & f) ^ (~e & g);
+    uint32_t t1 = h + s1 + ch + kRound[i] + w[i];
+    uint32_t s0 = Rotr(a, 2) ^ Rotr(a, 13) ^ Rotr(a, 22);
+    uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+    uint32_t t2 = s0 + maj;
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+  state_[0] += a;
+  state_[1] += b;
+  state_[2] += c;
+  state_[3] += d;
+  state_[4] += e;
+  state_[5] += f;
+  state_[6] += g;
+  state_[7] += h;
+}
+
+void Sha256::Update(const void* data, size_t nbyte) {
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  length_ += nbyte;
+  if (used_ > 0) {
+    size_t take = std::min(nbyte, sizeof(buffer_) - used_);
+    std::memcpy(buffer_ + used_, p, take);
+    used_ += take;
+    p += take;
+    nbyte -= take;
+    if (used_ < sizeof(buffer_)) {
+      return;
+    }
+    Block(buffer_);
+    used_ = 0;
+  }
+  while (nbyte >= sizeof(buffer_)) {
+    Block(p);
+    p += sizeof(buffer_);
+    nbyte -= sizeof(buffer_);
+  }
+  std::memcpy(buffer_, p, nbyte);
+  used_ = nbyte;
+}
+
+Sha256::Digest Sha256::Final() {
+  uint64_t bits = length_ * 8;
+  uint8_t pad[72] = {0x80};
+  size_t pad_len = (used_ < 56) ? 56 - used_ : 120 - used_;
+  for (int i = 0; i < 8; ++i) {
+    pad[pad_len + i] = uint8_t(bits >> (56 - 8 * i));
+  }
+  Update(pad, pad_len + 8);
+
+  Digest digest;
+  for (int i = 0; i < 8; ++i) {
+    digest[4 * i] = uint8_t(state_[i] >> 24);
+    digest[4 * i + 1] = uint8_t(state_[i] >> 16);
+    digest[4 * i + 2] = uint8_t(state_[i] >> 8);
+    digest[4 * i + 3] = uint8_t(state_[i]);
+  }
+  Reset();
+  return digest;
+}
+
+std::string Sha256::ToHex(const Digest& digest) {
+  static const char kHex[] = "0123456789abcdef";
+  std::string hex(64, '0');
+  for (size_t i = 0; i < digest.size(); ++i) {
+    hex[2 * i] = kHex[digest[i] >> 4];
+    hex[2 * i + 1] = kHex[digest[i] & 0xf];
+  }
+  return hex;
+}
+
+std::string Sha256::Hex(const void* data, size_t nbyte) {
+  Sha256 sha;
+  sha.Update(data, nbyte);
+  return ToHex(sha.Final());
+}
+
+std::string Sha256HexFile(const std::string& file_path) {
+  std::ifstream ifs(file_path, std::ios::binary);
+  if (!ifs.is_open()) {
+    throw std::runtime_error("Error: calculating SHA256 - cannot open " +
+                             file_path);
+  }
+  Sha256 sha;
+  std::vector<char> chunk(1 << 20);
+  while (ifs) {
+    ifs.read(chunk.data(), chunk.size());
+    std::streamsize n = ifs.gcount();
+    if (n > 0) {
+      sha.Update(chunk.data(), static_cast<size_t>(n));
+    }
+  }
+  if (ifs.bad()) {
+    throw std::runtime_error("Error: calculating SHA256 - cannot read " +
+                             file_path);
+  }
+  return Sha256::ToHex(sha.Final());
+}
+
+}  // namespace cae
@@ -0,0 +1,52 @@
+///
+/// sha256.h
+///
+/// Portable SHA-256 (FIPS 180-4) so digests do not depend on POCO.
+///
+#ifndef CAE_SHA256_H_
+#define CAE_SHA256_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace cae {
+
+/**
+ * Incremental SHA-256
+ */
+class Sha256 {
+ public:
+  using Digest = std::array<uint8_t, 32>;
+
+  Sha256() { Reset(); }
+
+  void Reset();
+  void Update(const void* data, size_t nbyte);
+  Digest Final();
+
+  /** Hex digest of a byte range */
+  static std::string Hex(const void* data, size_t nbyte);
+
+  /** Lowercase hex encoding of a digest */
+  static std::string ToHex(const Digest& digest);
+
+ private:
+  void Block(const uint8_t* block);
+
+  uint32_t state_[8];
+  uint64_t length_;  // bytes hashed so far
+  uint8_t buffer_[64];
+  size_t used_;      // bytes pending in buffer_
+};
+
+/**
+ * Hex SHA-256 of a file, read in large chunks
+ * @throws std::runtime_error if the file cannot be read
+ */
+std::string Sha256HexFile(const std::string& file_path);
+
+}  // namespace cae
+
+#endif  // CAE_SHA256_H_
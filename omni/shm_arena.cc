@@ -0,0 +1,538 @@
+///
+/// shm_arena.cc
+///
+#include "shm_arena.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cae {
+
+namespace {
+
+constexpr uint64_t kMagic = 0x414e4552415f4d4fULL;  // "OM_ARENA"
+constexpr uint32_t kVersion = 2;
+constexpr size_t kMinBlock = 64;
+constexpr uint32_t kClassesPerDoubling = 4;
+constexpr uint32_t kClasses = 40 * kClassesPerDoubling;
+constexpr uint32_t kMaxRegions = 1024;
+constexpr size_t kHugePage = 2 << 20;
+constexpr uint64_t kOffsetMask = (1ULL << 40) - 1;
+
+enum : uint8_t { kEmpty = 0, kUsed = 1, kTombstone = 2 };
+
+size_t RoundUp(size_t n, size_t align) {
+  return (n + align - 1) / align * align;
+}
+
+// FNV-1a
+uint64_t Hash(const std::string& key) {
+  uint64_t h = 0xcbf29ce484222325ULL;
+  for (unsigned char c : key) {
+    h = (h ^ c) * 0x100000001b3ULL;
+  }
+  return h;
+}
+
+// Four classes per power of two: class 4k + j holds blocks of
+// (4 + j) / 4 * (kMinBlock << k) bytes, so a block wastes under 20%
+size_t ClassSize(uint32_t cls) {
+  return (kMinBlock << (cls / kClassesPerDoubling)) / kClassesPerDoubling *
+         (kClassesPerDoubling + cls % kClassesPerDoubling);
+}
+
+// Smallest class holding nbyte bytes
+uint32_t ClassOf(size_t nbyte) {
+  uint32_t cls = 0;
+  while (ClassSize(cls) < nbyte) {
+    ++cls;
+  }
+  return cls;
+}
+
+// Names with a directory part are files (hugetlbfs); others are shm objects
+bool IsFilePath(const std::string& name) {
+  return name.find('/', 1) != std::string::npos;
+}
+
+std::string Normalize(const std::string& name) {
+  if (name.empty() || name[0] == '/') {
+    return name;
+  }
+  return "/" + name;
+}
+
+int OpenObject(const std::string& path, int flags) {
+  if (IsFilePath(path)) {
+    return open(path.c_str(), flags, 0600);
+  }
+  return shm_open(path.c_str(), flags, 0600);
+}
+
+int UnlinkObject(const std::string& path) {
+  return IsFilePath(path) ? unlink(path.c_str()) : shm_unlink(path.c_str());
+}
+
+}  // namespace
+
+struct ArenaHeader {
+  std::atomic<uint64_t> magic;  // published last by the creator
+  uint32_t version;
+  uint32_t regions;             // data regions created so far
+  uint64_t region_size;
+  uint64_t index_capacity;
+  uint64_t top;                 // bump offset in the newest region
+  uint64_t entries;
+  uint64_t tombstones;
+  uint64_t bytes_used;
+  uint64_t free_heads[kClasses];  // (region << 40) | offset, 0 if empty
+  pthread_mutex_t mutex;
+};
+
+struct ArenaEntry {
+  uint8_t state;
+  uint8_t cls;
+  uint16_t name_len;
+  uint32_t region;
+  uint64_t offset;
+  uint64_t nbyte;
+  char name[ShmArena::kMaxName + 1];
+};
+
+static_assert(sizeof(ArenaEntry) == 256, "index entries are 256 bytes");
+
+namespace {
+
+size_t IndexOffset() { return RoundUp(sizeof(ArenaHeader), 64); }
+
+size_t HeaderSize(uint64_t capacity) {
+  return RoundUp(IndexOffset() + capacity * sizeof(ArenaEntry), kHugePage);
+}
+
+ArenaEntry* Entries(ArenaHeader* header) {
+  return reinterpret_cast<ArenaEntry*>(reinterpret_cast<unsigned char*>(header) +
+                                       IndexOffset());
+}
+
+}  // namespace
+
+/** Holds the arena mutex, recovering it if its owner died. */
+class ShmArena::Lock {
+ public:
+  explicit Lock(ArenaHeader* header) : mutex_(&header->mutex) {
+    if (pthread_mutex_lock(mutex_) == EOWNERDEAD) {
+      pthread_mutex_consistent(mutex_);
+    }
+  }
+  ~Lock() { pthread_mutex_unlock(mutex_); }
+
+ private:
+  pthread_mutex_t* mutex_;
+};
+
+unsigned char* ShmArena::MapObject(const std::string& path, size_t size,
+                                   bool create, std::string& error) {
+  int fd = OpenObject(path, O_RDWR | (create ? O_CREAT : 0));
+  if (fd < 0) {
+    error = "cannot open " + path + ": " + strerror(errno);
+    return nullptr;
+  }
+  if (create && ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    error = "cannot size " + path + ": " + strerror(errno);
+    close(fd);
+    return nullptr;
+  }
+  void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    error = "cannot map " + path + ": " + strerror(errno);
+    return nullptr;
+  }
+#ifdef MADV_HUGEPAGE
+  // Back large regions with transparent huge pages where shmem allows it
+  madvise(addr, size, MADV_HUGEPAGE);
+#endif
+  return static_cast<unsigned char*>(addr);
+}
+
+std::unique_ptr<ShmArena> ShmArena::Open(const Options& options,
+                                         std::string& error) {
+  std::unique_ptr<ShmArena> arena(new ShmArena());
+  arena->name_ = Normalize(options.name);
+  if (arena->name_.size() < 2) {
+    error = "empty arena name";
+    return nullptr;
+  }
+
+  int fd = OpenObject(arena->name_, O_RDWR | O_CREAT | O_EXCL);
+  if (fd >= 0) {
+    // We created it: size, initialize, then publish the magic number
+    uint64_t capacity = options.index_capacity ? options.index_capacity : 1;
+    size_t size = HeaderSize(capacity);
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+      error = "cannot size " + arena->name_ + ": " + strerror(errno);
+      close(fd);
+      UnlinkObject(arena->name_);
+      return nullptr;
+    }
+    void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+      error = "cannot map " + arena->name_ + ": " + strerror(errno);
+      UnlinkObject(arena->name_);
+      return nullptr;
+    }
+    ArenaHeader* header = static_cast<ArenaHeader*>(addr);
+    header->version = kVersion;
+    header->regions = 0;
+    header->region_size =
+        RoundUp(options.region_size ? options.region_size : kHugePage,
+                kHugePage);
+    header->index_capacity = capacity;
+    header->top = 0;
+    header->entries = 0;
+    header->tombstones = 0;
+    header->bytes_used = 0;
+    std::memset(header->free_heads, 0, sizeof(header->free_heads));
+
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&header->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    header->magic.store(kMagic, std::memory_order_release);
+    arena->header_ = header;
+    arena->header_size_ = size;
+    return arena;
+  }
+  if (errno != EEXIST) {
+    error = "cannot create " + arena->name_ + ": " + strerror(errno);
+    return nullptr;
+  }
+
+  // Attach to an existing arena, waiting briefly for its creator
+  fd = OpenObject(arena->name_, O_RDWR);
+  if (fd < 0) {
+    error = "cannot open " + arena->name_ + ": " + strerror(errno);
+    return nullptr;
+  }
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (true) {
+    struct stat st;
+    if (fstat(fd, &st) == 0 &&
+        static_cast<size_t>(st.st_size) >= sizeof(ArenaHeader)) {
+      size_t size = static_cast<size_t>(st.st_size);
+      void* addr =
+          mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      if (addr == MAP_FAILED) {
+        error = "cannot map " + arena->name_ + ": " + strerror(errno);
+        close(fd);
+        return nullptr;
+      }
+      ArenaHeader* header = static_cast<ArenaHeader*>(addr);
+      if (header->magic.load(std::memory_order_acquire) == kMagic) {
+        close(fd);
+        if (header->version != kVersion ||
+            HeaderSize(header->index_capacity) > size) {
+          munmap(addr, size);
+          error = arena->name_ + " is not a compatible arena";
+          return nullptr;
+        }
+        arena->header_ = header;
+        arena->header_size_ = size;
+        return arena;
+      }
+      munmap(addr, size);
+    }
+    if (std::chrono::steady_clock::now() > deadline) {
+      close(fd);
+      error = arena->name_ + " was never initialized";
+      return nullptr;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+int ShmArena::Destroy(const std::string& name) {
+  std::string base = Normalize(name);
+  std::string error;
+  std::unique_ptr<ShmArena> arena;
+  int fd = OpenObject(base, O_RDWR);
+  if (fd < 0) {
+    return -1;
+  }
+  close(fd);
+  arena = Open(Options{base}, error);
+  uint32_t regions = arena ? arena->header_->regions : 0;
+  arena.reset();
+  for (uint32_t k = 1; k <= regions; ++k) {
+    UnlinkObject(base + "." + std::to_string(k));
+  }
+  return UnlinkObject(base) == 0 ? 0 : -1;
+}
+
+ShmArena::~ShmArena() {
+  if (header_ != nullptr) {
+    size_t region_size = header_->region_size;
+    for (unsigned char* region : regions_) {
+      if (region != nullptr) {
+        munmap(region, region_size);
+      }
+    }
+    munmap(header_, header_size_);
+  }
+}
+
+size_t ShmArena::BlockSize(size_t nbyte) {
+  return ClassSize(ClassOf(nbyte));
+}
+
+std::string ShmArena::RegionPath(uint32_t region) const {
+  return name_ + "." + std::to_string(region);
+}
+
+unsigned char* ShmArena::Region(uint32_t region) {
+  if (region == 0 || region > header_->regions) {
+    return nullptr;
+  }
+  if (regions_.size() <= region) {
+    regions_.resize(region + 1, nullptr);
+  }
+  if (regions_[region] == nullptr) {
+    // Created by another process since we last looked
+    std::string error;
+    regions_[region] = MapObject(RegionPath(region), header_->region_size,
+                                 false, error);
+  }
+  return regions_[region];
+}
+
+ArenaEntry* ShmArena::Probe(const std::string& key, bool insert) {
+  ArenaEntry* entries = Entries(header_);
+  uint64_t capacity = header_->index_capacity;
+  uint64_t start = Hash(key) % capacity;
+  ArenaEntry* reuse = nullptr;
+  for (uint64_t i = 0; i < capacity; ++i) {
+    ArenaEntry* e = &entries[(start + i) % capacity];
+    if (e->state == kEmpty) {
+      if (!insert) {
+        return nullptr;
+      }
+      return reuse != nullptr ? reuse : e;
+    }
+    if (e->state == kTombstone) {
+      if (reuse == nullptr) {
+        reuse = e;
+      }
+      continue;
+    }
+    if (e->name_len == key.size() &&
+        std::memcmp(e->name, key.data(), key.size()) == 0) {
+      return e;
+    }
+  }
+  return insert ? reuse : nullptr;
+}
+
+int ShmArena::Allocate(size_t nbyte, uint32_t& cls, uint32_t& region,
+                       uint64_t& offset) {
+  size_t block = BlockSize(nbyte);
+  if (block > header_->region_size) {
+    return -1;
+  }
+  cls = ClassOf(block);
+
+  uint64_t head = header_->free_heads[cls];
+  if (head != 0) {
+    region = static_cast<uint32_t>(head >> 40);
+    offset = head & kOffsetMask;
+    unsigned char* base = Region(region);
+    if (base == nullptr) {
+      return -1;
+    }
+    std::memcpy(&header_->free_heads[cls], base + offset, sizeof(uint64_t));
+    header_->bytes_used += block;
+    return 0;
+  }
+
+  if (header_->regions == 0 || header_->top + block > header_->region_size) {
+    if (header_->regions >= kMaxRegions) {
+      return -1;
+    }
+    uint32_t next = header_->regions + 1;
+    std::string error;
+    unsigned char* base =
+        MapObject(RegionPath(next), header_->region_size, true, error);
+    if (base == nullptr) {
+      return -1;
+    }
+    if (regions_.size() <= next) {
+      regions_.resize(next + 1, nullptr);
+    }
+    regions_[next] = base;
+    if (header_->regions > 0) {
+      // The rest of the old region goes on the free lists in the largest
+      // blocks that fit; less than kMinBlock bytes is left over
+      uint64_t top = header_->top;
+      while (header_->region_size - top >= kMinBlock) {
+        uint32_t tail = ClassOf(header_->region_size - top);
+        if (ClassSize(tail) > header_->region_size - top) {
+          --tail;
+        }
+        PushFree(tail, header_->regions, top);
+        top += ClassSize(tail);
+      }
+    }
+    header_->regions = next;
+    header_->top = 0;
+  }
+  region = header_->regions;
+  offset = header_->top;
+  header_->top += block;
+  header_->bytes_used += block;
+  return 0;
+}
+
+void ShmArena::PushFree(uint32_t cls, uint32_t region, uint64_t offset) {
+  unsigned char* base = Region(region);
+  if (base == nullptr) {
+    return;
+  }
+  // The free list is threaded through the first word of each free block
+  std::memcpy(base + offset, &header_->free_heads[cls], sizeof(uint64_t));
+  header_->free_heads[cls] = (static_cast<uint64_t>(region) << 40) | offset;
+}
+
+void ShmArena::Free(uint32_t cls, uint32_t region, uint64_t offset) {
+  PushFree(cls, region, offset);
+  header_->bytes_used -= ClassSize(cls);
+}
+
+bool ShmArena::IndexFull() const {
+  // Keep at least 10% of the slots empty so probe chains stay short
+  return (header_->entries + header_->tombstones + 1) * 10 >
+         header_->index_capacity * 9;
+}
+
+void ShmArena::Rehash() {
+  ArenaEntry* entries = Entries(header_);
+  uint64_t capacity = header_->index_capacity;
+  std::vector<ArenaEntry> live;
+  live.reserve(header_->entries);
+  for (uint64_t i = 0; i < capacity; ++i) {
+    if (entries[i].state == kUsed) {
+      live.push_back(entries[i]);
+    }
+  }
+  std::memset(entries, 0, capacity * sizeof(ArenaEntry));
+  header_->tombstones = 0;
+  for (const ArenaEntry& entry : live) {
+    *Probe(std::string(entry.name, entry.name_len), true) = entry;
+  }
+}
+
+int ShmArena::Put(const std::string& key, const void* data, size_t nbyte) {
+  if (key.empty() || key.size() > kMaxName) {
+    return -1;
+  }
+  Lock lock(header_);
+  ArenaEntry* e = Probe(key, true);
+  if ((e == nullptr || (e->state == kEmpty && IndexFull())) &&
+      header_->tombstones > 0) {
+    Rehash();
+    e = Probe(key, true);
+  }
+  if (e == nullptr) {
+    return -1;
+  }
+  bool replace = e->state == kUsed;
+  if (replace && ClassOf(nbyte) == e->cls) {
+    // Same size class: overwrite in place
+    unsigned char* base = Region(e->region);
+    if (base == nullptr) {
+      return -1;
+    }
+    std::memcpy(base + e->offset, data, nbyte);
+    e->nbyte = nbyte;
+    return 0;
+  }
+  if (!replace && e->state == kEmpty && IndexFull()) {
+    return -1;
+  }
+
+  uint32_t cls;
+  uint32_t region;
+  uint64_t offset;
+  if (Allocate(nbyte, cls, region, offset) != 0) {
+    return -1;
+  }
+  std::memcpy(Region(region) + offset, data, nbyte);
+  if (replace) {
+    Free(e->cls, e->region, e->offset);
+  } else {
+    if (e->state == kTombstone) {
+      --header_->tombstones;
+    }
+    ++header_->entries;
+    std::memcpy(e->name, key.data(), key.size());
+    e->name[key.size()] = '\0';
+    e->name_len = static_cast<uint16_t>(key.size());
+  }
+  e->cls = static_cast<uint8_t>(cls);
+  e->region = region;
+  e->offset = offset;
+  e->nbyte = nbyte;
+  e->state = kUsed;
+  return 0;
+}
+
+bool ShmArena::Find(const std::string& key, const unsigned char*& data,
+                    size_t& nbyte) {
+  Lock lock(header_);
+  ArenaEntry* e = Probe(key, false);
+  if (e == nullptr) {
+    return false;
+  }
+  unsigned char* base = Region(e->region);
+  if (base == nullptr) {
+    return false;
+  }
+  data = base + e->offset;
+  nbyte = e->nbyte;
+  return true;
+}
+
+int ShmArena::Remove(const std::string& key) {
+  Lock lock(header_);
+  ArenaEntry* e = Probe(key, false);
+  if (e == nullptr) {
+    return -1;
+  }
+  Free(e->cls, e->region, e->offset);
+  e->state = kTombstone;
+  --header_->entries;
+  ++header_->tombstones;
+  return 0;
+}
+
+ShmArena::Stats ShmArena::GetStats() {
+  Lock lock(header_);
+  Stats stats;
+  stats.regions = header_->regions;
+  stats.entries = header_->entries;
+  stats.bytes_used = header_->bytes_used;
+  return stats;
+}
+
+}  // namespace cae
@@ -0,0 +1,111 @@
+///
+/// shm_arena.h
+///
+/// Node-local shared-memory arena for small buffers. Instead of one file
+/// and one mapping per buffer, buffers are carved out of a few large
+/// shared regions by a slab allocator with four size classes per power of
+/// two. A name-to-block index lives in the same shared memory, so any
+/// process on the node finds and reads a buffer with a single hash lookup
+/// and no open/mmap per access.
+///
+/// Layout: the header object (e.g. /dev/shm/omni_arena) holds the header,
+/// a process-shared robust mutex, the per-class free lists and the index.
+/// Data regions are separate objects (<name>.1, <name>.2, ...) created on
+/// demand. A name containing a directory (e.g. /dev/hugepages/omni) is
+/// opened as a file instead, which places the arena on hugetlbfs.
+///
+#ifndef CAE_SHM_ARENA_H_
+#define CAE_SHM_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cae {
+
+struct ArenaHeader;
+struct ArenaEntry;
+
+/**
+ * Shared-memory slab arena with a built-in name index
+ */
+class ShmArena {
+ public:
+  struct Options {
+    std::string name = "/omni_arena";  // shm object or hugetlbfs path
+    size_t region_size = 256 << 20;   // bytes per data region
+    size_t index_capacity = 1 << 16;  // index slots, fixed at creation
+  };
+
+  struct Stats {
+    size_t regions = 0;     // data regions created
+    size_t entries = 0;     // live buffers
+    size_t bytes_used = 0;  // bytes in allocated blocks
+  };
+
+  /** Longest buffer name the index can hold */
+  static constexpr size_t kMaxName = 231;
+
+  /**
+   * Attach to the arena, creating it if it does not exist. Options other
+   * than the name only apply when the arena is created.
+   * @return nullptr on failure, with the reason in error
+   */
+  static std::unique_ptr<ShmArena> Open(const Options& options,
+                                        std::string& error);
+
+  /** Unlink the arena and all its regions. */
+  static int Destroy(const std::string& name);
+
+  ~ShmArena();
+
+  /**
+   * Store a copy of data under key, replacing any previous buffer
+   * @return 0 on success, -1 if the name is too long, the buffer is larger
+   *         than a region, or the index or arena is full
+   */
+  int Put(const std::string& key, const void* data, size_t nbyte);
+
+  /**
+   * Look up a buffer. On success data points into the shared mapping and
+   * stays valid until the buffer is replaced or removed.
+   */
+  bool Find(const std::string& key, const unsigned char*& data,
+            size_t& nbyte);
+
+  /** Remove a buffer and return its block to the free list. */
+  int Remove(const std::string& key);
+
+  Stats GetStats();
+
+  /** Block size used for a buffer of nbyte bytes */
+  static size_t BlockSize(size_t nbyte);
+
+ private:
+  ShmArena() = default;
+
+  class Lock;
+
+  unsigned char* Region(uint32_t region);
+  unsigned char* MapObject(const std::string& path, size_t size, bool create,
+                           std::string& error);
+  std::string RegionPath(uint32_t region) const;
+  ArenaEntry* Probe(const std::string& key, bool insert);
+  bool IndexFull() const;
+  void Rehash();  // drop tombstones from the index
+  int Allocate(size_t nbyte, uint32_t& cls, uint32_t& region,
+               uint64_t& offset);
+  void PushFree(uint32_t cls, uint32_t region, uint64_t offset);
+  void Free(uint32_t cls, uint32_t region, uint64_t offset);
+
+  std::string name_;
+  ArenaHeader* header_ = nullptr;
+  size_t header_size_ = 0;
+  std::vector<unsigned char*> regions_;  // local mappings, [0] unused
+};
+
+}  // namespace cae
+
+#endif  // CAE_SHM_ARENA_H_
@@ -0,0 +1,205 @@
+///
+/// stats.cc
+///
+#include "stats.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace cae {
+
+namespace {
+
+std::string JsonEscape(const std::string& s) {
+  std::string out;
+  for (char c : s) {
+    switch (c) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buf[8];
+          std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+          out += buf;
+        } else {
+          out += c;
+        }
+    }
+  }
+  return out;
+}
+
+// Prometheus label values escape backslash, quote and newline the same way
+std::string Labels(const StatsRegistry::Key& key, const std::string& rank) {
+  std::string labels = "{stage=\"" + JsonEscape(key.first) + "\"";
+  if (!key.second.empty()) {
+    labels += ",backend=\"" + JsonEscape(key.second) + "\"";
+  }
+  if (!rank.empty()) {
+    labels += "," + rank;
+  }
+  return labels + "}";
+}
+
+}  // namespace
+
+StatsRegistry& StatsRegistry::Global() {
+  static StatsRegistry registry;
+  return registry;
+}
+
+void StatsRegistry::Record(const std::string& stage,
+                           const std::string& backend, double seconds,
+                           uint64_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  StageTotals& t = totals_[Key(stage, backend)];
+  ++t.calls;
+  t.seconds += seconds;
+  if (seconds > t.max_seconds) {
+    t.max_seconds = seconds;
+  }
+  t.bytes += bytes;
+}
+
+void StatsRegistry::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  totals_.clear();
+  start_ = std::chrono::steady_clock::now();
+}
+
+double StatsRegistry::WallSeconds() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start_)
+      .count();
+}
+
+void StatsRegistry::SetRank(int rank, const std::string& host) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  rank_labels_ = "rank=\"" + std::to_string(rank) + "\"";
+  if (!host.empty()) {
+    rank_labels_ += ",host=\"" + JsonEscape(host) + "\"";
+  }
+}
+
+std::map<StatsRegistry::Key, StageTotals> StatsRegistry::Snapshot() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return totals_;
+}
+
+std::string StatsRegistry::ToJson() {
+  std::map<Key, StageTotals> totals = Snapshot();
+  double wall = WallSeconds();
+  std::ostringstream os;
+  os.precision(9);
+  os << "{\n  \"wall_seconds\": " << wall << ",\n  \"stages\": [";
+  bool first = true;
+  for (const auto& entry : totals) {
+    const StageTotals& t = entry.second;
+    os << (first ? "\n" : ",\n") << "    {\"stage\": \""
+       << JsonEscape(entry.first.first) << "\"";
+    if (!entry.first.second.empty()) {
+      os << ", \"backend\": \"" << JsonEscape(entry.first.second) << "\"";
+    }
+    os << ", \"calls\": " << t.calls << ", \"seconds\": " << t.seconds
+       << ", \"max_seconds\": " << t.max_seconds << ", \"bytes\": " << t.bytes
+       << "}";
+    first = false;
+  }
+  os << (first ? "]\n}\n" : "\n  ]\n}\n");
+  return os.str();
+}
+
+std::string StatsRegistry::ToPrometheus() {
+  std::map<Key, StageTotals> totals = Snapshot();
+  double wall = WallSeconds();
+  std::string rank;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rank = rank_labels_;
+  }
+  std::ostringstream os;
+  os.precision(9);
+  os << "# HELP omni_wall_seconds Wall time of the last wrp command.\n"
+     << "# TYPE omni_wall_seconds gauge\n"
+     << "omni_wall_seconds" << (rank.empty() ? "" : "{" + rank + "}") << " "
+     << wall << "\n";
+
+  struct Series {
+    const char* name;
+    const char* type;
+    const char* help;
+  };
+  const Series series[] = {
+      {"omni_stage_calls_total", "counter", "Number of times a stage ran."},
+      {"omni_stage_seconds_total", "counter", "Time spent in a stage."},
+      {"omni_stage_seconds_max", "gauge", "Longest single run of a stage."},
+      {"omni_stage_bytes_total", "counter", "Bytes handled by a stage."},
+  };
+  for (size_t i = 0; i < sizeof(series) / sizeof(series[0]); ++i) {
+    os << "# HELP " << series[i].name << " " << series[i].help << "\n"
+       << "# TYPE " << series[i].name << " " << series[i].type << "\n";
+    for (const auto& entry : totals) {
+      const StageTotals& t = entry.second;
+      os << series[i].name << Labels(entry.first, rank) << " ";
+      switch (i) {
+        case 0: os << t.calls; break;
+        case 1: os << t.seconds; break;
+        case 2: os << t.max_seconds; break;
+        default: os << t.bytes; break;
+      }
+      os << "\n";
+    }
+  }
+  return os.str();
+}
+
+int StatsRegistry::Write(const std::string& format, const std::string& path) {
+  std::string text;
+  if (format == "json") {
+    text = ToJson();
+  } else if (format == "prom") {
+    text = ToPrometheus();
+  } else {
+    std::cerr << "Error: invalid stats format - " << format << std::endl;
+    return 1;
+  }
+  if (path == "-") {
+    std::cout << text << std::flush;
+    return 0;
+  }
+
+  std::string tmp = path + ".tmp";
+  std::ofstream out(tmp, std::ios::trunc);
+  out << text;
+  out.close();
+  if (!out || std::rename(tmp.c_str(), path.c_str()) != 0) {
+    std::remove(tmp.c_str());
+    std::cerr << "Error: could not write stats to '" << path << "'"
+              << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+bool ParseStatsSpec(const std::string& spec, std::string& format,
+                    std::string& path) {
+  size_t colon = spec.find(':');
+  format = spec.substr(0, colon);
+  if (format == "json") {
+    path = "wrp_stats.json";
+  } else if (format == "prom") {
+    path = "wrp.prom";
+  } else {
+    return false;
+  }
+  if (colon != std::string::npos) {
+    path = spec.substr(colon + 1);
+  }
+  return !path.empty();
+}
+
+}  // namespace cae
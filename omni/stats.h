@@ -0,0 +1,123 @@
+///
+/// stats.h
+///
+/// Lightweight instrumentation for wrp. Stages record monotonic-clock spans
+/// and byte counts into a process-wide registry, which is written out as
+/// JSON or in the Prometheus text exposition format (for the node_exporter
+/// textfile collector) when wrp exits.
+///
+#ifndef CAE_STATS_H_
+#define CAE_STATS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace cae {
+
+/**
+ * Accumulated totals of one stage (and backend, if any)
+ */
+struct StageTotals {
+  uint64_t calls = 0;
+  double seconds = 0.0;
+  double max_seconds = 0.0;
+  uint64_t bytes = 0;
+};
+
+/**
+ * Thread-safe registry of stage totals
+ */
+class StatsRegistry {
+ public:
+  using Key = std::pair<std::string, std::string>;  // stage, backend
+
+  /** The process-wide registry */
+  static StatsRegistry& Global();
+
+  /** Recording is off until enabled, so spans cost nothing by default. */
+  void Enable() { enabled_ = true; }
+  bool Enabled() const { return enabled_; }
+
+  void Record(const std::string& stage, const std::string& backend,
+              double seconds, uint64_t bytes);
+  void Reset();
+
+  std::map<Key, StageTotals> Snapshot();
+  double WallSeconds();  // since construction or the last Reset()
+
+  /**
+   * Label every Prometheus series with this rank, and host if not empty,
+   * so one collector can read the files of several ranks side by side
+   */
+  void SetRank(int rank, const std::string& host);
+
+  std::string ToJson();
+  std::string ToPrometheus();
+
+  /**
+   * Write the stats to a file, atomically (temporary file + rename) so
+   * collectors never see a partial file
+   * @param format "json" or "prom"
+   * @param path Output file, or "-" for stdout
+   * @return 0 on success
+   */
+  int Write(const std::string& format, const std::string& path);
+
+ private:
+  StatsRegistry() : start_(std::chrono::steady_clock::now()) {}
+
+  std::atomic<bool> enabled_{false};
+  std::chrono::steady_clock::time_point start_;
+  std::mutex mutex_;
+  std::map<Key, StageTotals> totals_;
+  std::string rank_labels_;  // rank="0",host="n1" once SetRank is called
+};
+
+/**
+ * Times a stage from construction to destruction
+ */
+class StatSpan {
+ public:
+  explicit StatSpan(std::string stage)
+      : enabled_(StatsRegistry::Global().Enabled()), stage_(std::move(stage)) {
+    if (enabled_) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+  ~StatSpan() {
+    if (enabled_) {
+      double seconds = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start_)
+                           .count();
+      StatsRegistry::Global().Record(stage_, backend_, seconds, bytes_);
+    }
+  }
+  StatSpan(const StatSpan&) = delete;
+  StatSpan& operator=(const StatSpan&) = delete;
+
+  void AddBytes(uint64_t nbyte) { bytes_ += nbyte; }
+  void SetBackend(const std::string& backend) { backend_ = backend; }
+
+ private:
+  bool enabled_;
+  std::string stage_;
+  std::string backend_;
+  uint64_t bytes_ = 0;
+  std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * Parse a --stats value: "json", "prom", "json:<file>" or "prom:<file>"
+ * @return false if the format is unknown
+ */
+bool ParseStatsSpec(const std::string& spec, std::string& format,
+                    std::string& path);
+
+}  // namespace cae
+
+#endif  // CAE_STATS_H_
@@ -0,0 +1,187 @@
+///
+/// stream.cc
+///
+#include "stream.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#endif
+
+namespace cae {
+
+namespace {
+
+// Largest single kernel transfer; sendfile caps a call near 2 GiB anyway
+constexpr uint64_t kMaxChunk = 1ULL << 30;
+
+#ifdef __linux__
+// Returns 1 if the kernel path is unsupported for these descriptors and
+// nothing was copied yet, so the caller can try the next method.
+int SendfileRange(int in_fd, uint64_t offset, uint64_t nbyte, int out_fd) {
+  off_t off = static_cast<off_t>(offset);
+  uint64_t left = nbyte;
+  while (left > 0) {
+    ssize_t n = sendfile(out_fd, in_fd, &off,
+                         static_cast<size_t>(std::min(left, kMaxChunk)));
+    if (n < 0) {
+      if (errno == EINTR || errno == EAGAIN) {
+        continue;
+      }
+      if ((errno == EINVAL || errno == ENOSYS) && left == nbyte) {
+        return 1;
+      }
+      return -1;
+    }
+    if (n == 0) {
+      errno = EIO;  // source shorter than the range
+      return -1;
+    }
+    left -= static_cast<uint64_t>(n);
+  }
+  return 0;
+}
+
+int SpliceRange(int in_fd, uint64_t offset, uint64_t nbyte, int out_fd) {
+  struct stat st;
+  if (fstat(out_fd, &st) != 0 || !S_ISFIFO(st.st_mode)) {
+    return 1;
+  }
+  loff_t off = static_cast<loff_t>(offset);
+  uint64_t left = nbyte;
+  while (left > 0) {
+    ssize_t n = splice(in_fd, &off, out_fd, nullptr,
+                       static_cast<size_t>(std::min(left, kMaxChunk)),
+                       SPLICE_F_MOVE);
+    if (n < 0) {
+      if (errno == EINTR || errno == EAGAIN) {
+        continue;
+      }
+      if ((errno == EINVAL || errno == ENOSYS) && left == nbyte) {
+        return 1;
+      }
+      return -1;
+    }
+    if (n == 0) {
+      errno = EIO;
+      return -1;
+    }
+    left -= static_cast<uint64_t>(n);
+  }
+  return 0;
+}
+#endif
+
+int ReadWriteRange(int in_fd, uint64_t offset, uint64_t nbyte, int out_fd) {
+  std::vector<char> chunk(1 << 20);
+#ifdef _WIN32
+  if (_lseeki64(in_fd, static_cast<__int64>(offset), SEEK_SET) < 0) {
+    return -1;
+  }
+#endif
+  uint64_t left = nbyte;
+  while (left > 0) {
+    size_t want = static_cast<size_t>(
+        std::min<uint64_t>(left, static_cast<uint64_t>(chunk.size())));
+#ifdef _WIN32
+    int n = _read(in_fd, chunk.data(), static_cast<unsigned int>(want));
+#else
+    ssize_t n = pread(in_fd, chunk.data(), want,
+                      static_cast<off_t>(offset + (nbyte - left)));
+#endif
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    if (n == 0) {
+      errno = EIO;
+      return -1;
+    }
+    if (WriteFully(out_fd, chunk.data(), static_cast<size_t>(n)) != 0) {
+      return -1;
+    }
+    left -= static_cast<uint64_t>(n);
+  }
+  return 0;
+}
+
+}  // namespace
+
+bool ParseRange(const std::string& spec, uint64_t& offset, uint64_t& nbyte) {
+  size_t colon = spec.find(':');
+  if (colon == std::string::npos || colon == 0) {
+    return false;
+  }
+  std::string off = spec.substr(0, colon);
+  std::string len = spec.substr(colon + 1);
+  auto digits = [](const std::string& s) {
+    return !s.empty() &&
+           std::all_of(s.begin(), s.end(),
+                       [](char c) { return c >= '0' && c <= '9'; });
+  };
+  if (!digits(off) || (!len.empty() && !digits(len))) {
+    return false;
+  }
+  errno = 0;
+  offset = std::strtoull(off.c_str(), nullptr, 10);
+  nbyte = len.empty() ? kToEnd : std::strtoull(len.c_str(), nullptr, 10);
+  return errno == 0;
+}
+
+int WriteFully(int fd, const void* data, size_t nbyte) {
+  const char* p = static_cast<const char*>(data);
+  while (nbyte > 0) {
+#ifdef _WIN32
+    int n = _write(fd, p, static_cast<unsigned int>(
+                              std::min<size_t>(nbyte, 1 << 30)));
+#else
+    ssize_t n = write(fd, p, nbyte);
+#endif
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    p += n;
+    nbyte -= static_cast<size_t>(n);
+  }
+  return 0;
+}
+
+int CopyFileRange(int in_fd, uint64_t offset, uint64_t nbyte, int out_fd,
+                  std::string& method) {
+  if (nbyte == 0) {
+    method = "copy";
+    return 0;
+  }
+#ifdef __linux__
+  method = "sendfile";
+  int rc = SendfileRange(in_fd, offset, nbyte, out_fd);
+  if (rc <= 0) {
+    return rc;
+  }
+  method = "splice";
+  rc = SpliceRange(in_fd, offset, nbyte, out_fd);
+  if (rc <= 0) {
+    return rc;
+  }
+#endif
+  method = "copy";
+  return ReadWriteRange(in_fd, offset, nbyte, out_fd);
+}
+
+}  // namespace cae
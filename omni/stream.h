@@ -0,0 +1,50 @@
+///
+/// stream.h
+///
+/// Copying buffer bytes to a file descriptor. On Linux the kernel moves the
+/// bytes directly (sendfile, or splice into a pipe), so they never pass
+/// through user space; elsewhere a read/write loop is used.
+///
+#ifndef CAE_STREAM_H_
+#define CAE_STREAM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+namespace cae {
+
+/** Length meaning "up to the end of the buffer" */
+constexpr uint64_t kToEnd = std::numeric_limits<uint64_t>::max();
+
+/**
+ * Parse a byte range given as "offset:length"
+ * @param spec Range text; an empty length ("4096:") reads to the end
+ * @param offset First byte
+ * @param nbyte Number of bytes, or kToEnd
+ * @return false if spec is malformed
+ */
+bool ParseRange(const std::string& spec, uint64_t& offset, uint64_t& nbyte);
+
+/**
+ * Write all nbyte bytes, retrying short writes
+ * @return 0 on success, -1 on error (errno is set)
+ */
+int WriteFully(int fd, const void* data, size_t nbyte);
+
+/**
+ * Copy a byte range of one file to another descriptor
+ * @param in_fd Source file, opened for reading
+ * @param offset First byte of the source to copy
+ * @param nbyte Number of bytes to copy
+ * @param out_fd Destination (regular file, pipe or socket)
+ * @param method Set to "sendfile", "splice" or "copy"
+ * @return 0 on success, -1 on error (errno is set)
+ */
+int CopyFileRange(int in_fd, uint64_t offset, uint64_t nbyte, int out_fd,
+                  std::string& method);
+
+}  // namespace cae
+
+#endif  // CAE_STREAM_H_
@@ -0,0 +1,31 @@
+/*
+ * lambda_plugin.c - sample in-process OMNI lambda.
+ *
+ * Build as a shared object and reference it from an OMNI file:
+ *
+ *   run: ./libomni_lambda_upper.so:omni_upper
+ */
+#include <ctype.h>
+#include <stdlib.h>
+
+#include "omni_lambda.h"
+
+OMNI_LAMBDA_EXPORT int omni_upper(const omni_lambda_input* in,
+                                  const omni_lambda_output* out) {
+  if (in->abi_version != OMNI_LAMBDA_ABI_VERSION) {
+    return 1;
+  }
+  if (in->nbyte == 0) {
+    return 0;
+  }
+  unsigned char* upper = (unsigned char*)malloc(in->nbyte);
+  if (upper == NULL) {
+    return 1;
+  }
+  for (size_t i = 0; i < in->nbyte; i++) {
+    upper[i] = (unsigned char)toupper(in->data[i]);
+  }
+  int rc = out->write(out->ctx, upper, in->nbyte);
+  free(upper);
+  return rc;
+}
@@ -0,0 +1,154 @@
+///
+/// test_arrow.cc - Unit tests for the Parquet and Feather format clients
+///
+#include "format/arrow_format_client.h"
+#include "format/format_factory.h"
+#include <cmath>
+#include <iostream>
+#include <string>
+
+// Test result tracking
+int tests_passed = 0;
+int tests_failed = 0;
+
+// Directory holding the A46_xx sample files
+std::string data_dir = "../data";
+
+#define TEST(name) \
+  std::cout << "Running test: " << #name << "..." << std::endl; \
+  if (test_##name()) { \
+    tests_passed++; \
+    std::cout << "  PASSED" << std::endl; \
+  } else { \
+    tests_failed++; \
+    std::cout << "  FAILED" << std::endl; \
+  }
+
+bool read(cae::ArrowFormatClient::Kind kind, const std::string& file,
+          cae::ColumnProjection projection, cae::ColumnTable& table,
+          std::string& error) {
+  cae::ArrowFormatClient client(kind, projection);
+  return client.Read(data_dir + "/" + file, table, error) == 0;
+}
+
+// The sample strain data: 3327 rows of three float columns
+bool check_sample(const cae::ColumnTable& table) {
+  if (table.rows != 3327 || table.columns.size() != 3 ||
+      table.names[0] != "X'[mm]") {
+    return false;
+  }
+  for (const std::vector<double>& column : table.columns) {
+    if (column.size() != table.rows) {
+      return false;
+    }
+  }
+  return table.columns[0][0] == 0.0 &&
+         std::fabs(table.columns[1][0] - 0.85) < 1e-9;
+}
+
+bool test_Parquet_all_columns() {
+  cae::ColumnTable table;
+  std::string error;
+  return read(cae::ArrowFormatClient::Kind::kParquet, "A46_xx.parquet", {},
+              table, error) &&
+         check_sample(table);
+}
+
+bool test_Feather_all_columns() {
+  cae::ColumnTable table;
+  std::string error;
+  return read(cae::ArrowFormatClient::Kind::kFeather, "A46_xx.feather", {},
+              table, error) &&
+         check_sample(table);
+}
+
+bool test_Projection() {
+  // Only the named column is decoded, in the requested order
+  cae::ColumnProjection projection;
+  projection.columns = {" Z'[mm]", "X'[mm]"};
+  for (auto kind : {cae::ArrowFormatClient::Kind::kParquet,
+                    cae::ArrowFormatClient::Kind::kFeather}) {
+    cae::ColumnTable table;
+    std::string error;
+    std::string file = kind == cae::ArrowFormatClient::Kind::kParquet
+                           ? "A46_xx.parquet"
+                           : "A46_xx.feather";
+    if (!read(kind, file, projection, table, error) ||
+        table.columns.size() != 2 || table.names[0] != " Z'[mm]" ||
+        table.rows != 3327 || std::fabs(table.columns[0][0] - 0.85) > 1e-9) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool test_Row_groups() {
+  cae::ColumnProjection projection;
+  projection.row_groups = {0};
+  cae::ColumnTable table;
+  std::string error;
+  if (!read(cae::ArrowFormatClient::Kind::kParquet, "A46_xx.parquet",
+            projection, table, error) ||
+      table.rows == 0 || table.rows > 3327) {
+    return false;
+  }
+  projection.row_groups = {1000};
+  return !read(cae::ArrowFormatClient::Kind::kParquet, "A46_xx.parquet",
+               projection, table, error) &&
+         error.find("out of range") != std::string::npos;
+}
+
+bool test_Errors() {
+  cae::ColumnProjection projection;
+  projection.columns = {"missing"};
+  cae::ColumnTable table;
+  std::string error;
+  if (read(cae::ArrowFormatClient::Kind::kParquet, "A46_xx.parquet",
+           projection, table, error) ||
+      error != "no column 'missing'") {
+    return false;
+  }
+  // A CSV file is neither Parquet nor Arrow IPC
+  return !read(cae::ArrowFormatClient::Kind::kParquet, "A46_xx.csv", {},
+               table, error) &&
+         !read(cae::ArrowFormatClient::Kind::kFeather, "A46_xx.csv", {},
+               table, error);
+}
+
+bool test_Factory() {
+  auto parquet = cae::FormatFactory::Get("parquet");
+  auto feather = cae::FormatFactory::Get("feather");
+  return dynamic_cast<cae::ArrowFormatClient*>(parquet.get()) != nullptr &&
+         dynamic_cast<cae::ArrowFormatClient*>(feather.get()) != nullptr;
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1) {
+    data_dir = argv[1];
+  }
+  std::cout << "========================================" << std::endl;
+  std::cout << "  Parquet and Feather Client Unit Tests" << std::endl;
+  std::cout << "========================================" << std::endl << std::endl;
+
+  TEST(Parquet_all_columns);
+  TEST(Feather_all_columns);
+  TEST(Projection);
+  TEST(Row_groups);
+  TEST(Errors);
+  TEST(Factory);
+
+  // Summary
+  std::cout << std::endl << "========================================" << std::endl;
+  std::cout << "Test Summary:" << std::endl;
+  std::cout << "  Passed: " << tests_passed << std::endl;
+  std::cout << "  Failed: " << tests_failed << std::endl;
+  std::cout << "========================================" << std::endl;
+
+  if (tests_failed == 0) {
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+  } else {
+    std::cout << "Some tests failed." << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,173 @@
+///
+/// test_codec.cc - Unit tests for framed compression and the buffer catalog
+///
+#include "catalog.h"
+#include "codec.h"
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Test result tracking
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name) \
+  std::cout << "Running test: " << #name << "..." << std::endl; \
+  if (test_##name()) { \
+    tests_passed++; \
+    std::cout << "  PASSED" << std::endl; \
+  } else { \
+    tests_failed++; \
+    std::cout << "  FAILED" << std::endl; \
+  }
+
+// Compressible test data: repeated CSV-like rows
+std::vector<unsigned char> make_data(size_t n) {
+  const std::string row = "1.000000, 0.850000, -21.409763, 42\n";
+  std::vector<unsigned char> data(n);
+  for (size_t i = 0; i < n; ++i) {
+    data[i] = row[i % row.size()] + (i / 4096) % 3;
+  }
+  return data;
+}
+
+bool roundtrip(cae::Codec codec) {
+  std::vector<unsigned char> data = make_data(1000003);
+  std::vector<unsigned char> packed;
+  cae::FrameIndex index;
+  // Small frames so the buffer spans many parallel frames
+  if (cae::CompressFrames(codec, data.data(), data.size(), 65536, 4, packed,
+                          index) != 0) {
+    return false;
+  }
+  if (index.Frames() != (data.size() + 65535) / 65536) {
+    return false;
+  }
+  std::vector<unsigned char> out(data.size());
+  if (cae::DecompressFrames(index, packed.data(), packed.size(), out.data(),
+                            4) != 0) {
+    return false;
+  }
+  if (out != data) {
+    return false;
+  }
+  // Random access across a frame boundary
+  std::vector<unsigned char> range;
+  if (cae::DecompressRange(index, packed.data(), packed.size(), 65530, 100,
+                           range) != 0) {
+    return false;
+  }
+  return range == std::vector<unsigned char>(data.begin() + 65530,
+                                             data.begin() + 65630);
+}
+
+bool test_ParseCodec() {
+  cae::Codec codec;
+  return cae::ParseCodec("ZSTD", codec) && codec == cae::Codec::kZstd &&
+         cae::ParseCodec("lz4", codec) && codec == cae::Codec::kLz4 &&
+         cae::ParseCodec("", codec) && codec == cae::Codec::kNone &&
+         !cae::ParseCodec("brotli", codec) &&
+         cae::CodecName(cae::Codec::kLz4) == "lz4";
+}
+
+bool test_None_roundtrip() { return roundtrip(cae::Codec::kNone); }
+
+bool test_Zstd_roundtrip() {
+  if (!cae::CodecAvailable(cae::Codec::kZstd)) {
+    std::cout << "  (zstd not built, skipped)" << std::endl;
+    return true;
+  }
+  return roundtrip(cae::Codec::kZstd);
+}
+
+bool test_Lz4_roundtrip() {
+  if (!cae::CodecAvailable(cae::Codec::kLz4)) {
+    std::cout << "  (lz4 not built, skipped)" << std::endl;
+    return true;
+  }
+  return roundtrip(cae::Codec::kLz4);
+}
+
+bool test_Corrupt_index() {
+  std::vector<unsigned char> data = make_data(1000);
+  std::vector<unsigned char> packed;
+  cae::FrameIndex index;
+  if (cae::CompressFrames(cae::Codec::kNone, data.data(), data.size(), 256, 1,
+                          packed, index) != 0) {
+    return false;
+  }
+  index.offsets.pop_back();
+  std::vector<unsigned char> out(data.size());
+  return cae::DecompressFrames(index, packed.data(), packed.size(), out.data(),
+                               1) != 0;
+}
+
+bool test_Catalog_roundtrip() {
+  // Work in a scratch directory so the build tree's catalog is untouched
+  fs::path cwd = fs::current_path();
+  fs::path scratch = fs::temp_directory_path() / "omni_test_codec";
+  fs::remove_all(scratch);
+  fs::create_directories(scratch);
+  fs::current_path(scratch);
+
+  cae::BufferMeta meta;
+  if (cae::ReadBufferMeta("test/codec", meta) != 1) {
+    fs::current_path(cwd);
+    return false;
+  }
+  meta.name = "test/codec";
+  meta.tags = "a,b";
+  meta.backend = "file";
+  meta.size = 300;
+  meta.stored_size = 120;
+  meta.frames.codec = cae::Codec::kZstd;
+  meta.frames.frame_size = 128;
+  meta.frames.raw_size = 300;
+  meta.frames.offsets = {0, 40, 80, 120};
+  if (cae::WriteBufferMeta(meta) != 0) {
+    fs::current_path(cwd);
+    return false;
+  }
+  cae::BufferMeta back;
+  bool ok = cae::ReadBufferMeta("test/codec", back) == 0 &&
+            back.name == meta.name && back.tags == meta.tags &&
+            back.backend == "file" && back.size == 300 &&
+            back.stored_size == 120 &&
+            back.frames.codec == cae::Codec::kZstd &&
+            back.frames.frame_size == 128 && back.frames.raw_size == 300 &&
+            back.frames.offsets == meta.frames.offsets;
+  fs::current_path(cwd);
+  fs::remove_all(scratch);
+  return ok;
+}
+
+int main() {
+  std::cout << "========================================" << std::endl;
+  std::cout << "  Codec Unit Tests" << std::endl;
+  std::cout << "========================================" << std::endl << std::endl;
+
+  TEST(ParseCodec);
+  TEST(None_roundtrip);
+  TEST(Zstd_roundtrip);
+  TEST(Lz4_roundtrip);
+  TEST(Corrupt_index);
+  TEST(Catalog_roundtrip);
+
+  // Summary
+  std::cout << std::endl << "========================================" << std::endl;
+  std::cout << "Test Summary:" << std::endl;
+  std::cout << "  Passed: " << tests_passed << std::endl;
+  std::cout << "  Failed: " << tests_failed << std::endl;
+  std::cout << "========================================" << std::endl;
+
+  if (tests_failed == 0) {
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+  } else {
+    std::cout << "Some tests failed." << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,216 @@
+///
+/// test_csv.cc - Unit tests for the numeric CSV format client
+///
+#include "format/csv_format_client.h"
+#include "format/format_factory.h"
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+// Test result tracking
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name) \
+  std::cout << "Running test: " << #name << "..." << std::endl; \
+  if (test_##name()) { \
+    tests_passed++; \
+    std::cout << "  PASSED" << std::endl; \
+  } else { \
+    tests_failed++; \
+    std::cout << "  FAILED" << std::endl; \
+  }
+
+bool parse(const std::string& text, bool header, cae::ColumnTable& table,
+           std::string& error, char delimiter = ',') {
+  cae::CsvFormatClient csv(delimiter);
+  return csv.Parse(text.data(), text.size(), header, table, error) == 0;
+}
+
+bool test_Header_and_values() {
+  // The sample strain data: header, blanks after commas
+  std::string text =
+      "X'[mm], Z'[mm], Smoothed_Strain[um/m]\n"
+      "0.000000, 0.850000, -21.409763\n"
+      "0.000000, 1.700000, -1.5e3\n";
+  cae::ColumnTable table;
+  std::string error;
+  return parse(text, true, table, error) && table.rows == 2 &&
+         table.names.size() == 3 && table.names[0] == "X'[mm]" &&
+         table.names[2] == "Smoothed_Strain[um/m]" &&
+         table.columns[1][1] == 1.7 && table.columns[2][0] == -21.409763 &&
+         table.columns[2][1] == -1500.0;
+}
+
+bool test_No_header() {
+  // A numeric first row is data; a header is only looked for at offset 0
+  cae::ColumnTable table;
+  std::string error;
+  bool numeric = parse("1,2\n3,4", true, table, error) && table.rows == 2 &&
+                 table.names[1] == "c1" && table.columns[0][1] == 3.0;
+  bool mid_file = !parse("a,b\n1,2\n", false, table, error) &&
+                  error.find("line 1") != std::string::npos;
+  return numeric && mid_file;
+}
+
+bool test_Fields() {
+  // CRLF, quotes, '+', empty fields and blank lines; longer than one SIMD
+  // block so both scan paths run
+  std::string text =
+      "\"1.25\",+2,\r\n"
+      "\n"
+      "  3 ,\t4e-2\t, 123456789012.5\r\n";
+  cae::ColumnTable table;
+  std::string error;
+  return parse(text, false, table, error) && table.rows == 2 &&
+         table.columns[0][0] == 1.25 && table.columns[1][0] == 2.0 &&
+         std::isnan(table.columns[2][0]) && table.columns[0][1] == 3.0 &&
+         table.columns[1][1] == 0.04 && table.columns[2][1] == 123456789012.5;
+}
+
+bool test_Errors() {
+  cae::ColumnTable table;
+  std::string ragged;
+  std::string text;
+  bool ok = !parse("1,2\n3\n", false, table, ragged) &&
+            ragged == "line 2 has 1 fields, expected 2" &&
+            !parse("1,2\n3,x\n", false, table, text) &&
+            text.find("line 2") != std::string::npos;
+  return ok;
+}
+
+bool test_Delimiter() {
+  cae::ColumnTable table;
+  std::string error;
+  return parse("a;b\n1.5;2\n", true, table, error, ';') &&
+         table.columns[0][0] == 1.5 &&
+         !parse("a;b\n1.5;2\n", true, table, error, ',');
+}
+
+bool test_Parallel_chunks() {
+  // Over kMinChunk per thread, so four threads each parse a piece
+  std::string text = "t,v\n";
+  size_t rows = 0;
+  while (text.size() < 4 * cae::CsvFormatClient::kMinChunk + 1000) {
+    text += std::to_string(rows) + "," + std::to_string(rows % 977) + ".25\n";
+    ++rows;
+  }
+  cae::CsvFormatClient serial(',', 1);
+  cae::CsvFormatClient parallel(',', 4);
+  cae::ColumnTable one;
+  cae::ColumnTable four;
+  std::string error;
+  if (serial.Parse(text.data(), text.size(), true, one, error) != 0 ||
+      parallel.Parse(text.data(), text.size(), true, four, error) != 0) {
+    return false;
+  }
+  bool same = one.rows == rows && four.rows == rows &&
+              four.names == one.names && four.columns == one.columns;
+
+  // A bad row in a later chunk is reported at its line in the whole text
+  std::string bad = text;
+  size_t at = bad.rfind("\n", bad.size() - 2) + 1;
+  bad.insert(at, "1,2,3\n");
+  bool located = parallel.Parse(bad.data(), bad.size(), true, four, error) == 1 &&
+                 error == "line " + std::to_string(rows + 1) +
+                              " has 3 fields, expected 2";
+  return same && located;
+}
+
+bool test_PackColumns() {
+  cae::ColumnTable table;
+  std::string error;
+  parse("1,2\n3,4\n5,6\n", false, table, error);
+  std::vector<unsigned char> bytes;
+  cae::PackColumns(table, bytes);
+  double values[6];
+  if (bytes.size() != sizeof(values)) {
+    return false;
+  }
+  std::memcpy(values, bytes.data(), bytes.size());
+  return values[0] == 1 && values[1] == 3 && values[2] == 5 &&
+         values[3] == 2 && values[5] == 6;
+}
+
+bool test_SelectColumns() {
+  cae::ColumnTable table;
+  std::string error;
+  parse("a,b,c\n1,2,3\n4,5,6\n", true, table, error);
+  if (!cae::SelectColumns({"c", "a"}, table, error) ||
+      table.names != std::vector<std::string>{"c", "a"} ||
+      table.columns[0][1] != 6 || table.columns[1][0] != 1 ||
+      table.rows != 2) {
+    return false;
+  }
+  return !cae::SelectColumns({"b"}, table, error) && error == "no column 'b'";
+}
+
+bool test_Import_partitions() {
+  // Byte partitions of a file parse to whole rows that add up
+  std::string text = "t,v\n";
+  for (int i = 0; i < 500; ++i) {
+    text += std::to_string(i) + "," + std::to_string(i * 0.5) + "\n";
+  }
+  fs::path path = fs::temp_directory_path() / "omni_test_csv.csv";
+  std::ofstream(path, std::ios::binary | std::ios::trunc) << text;
+  size_t rows = 0;
+  double sum = 0.0;
+  bool named = false;
+  for (int i = 0; i < 4; ++i) {
+    cae::FormatContext ctx;
+    ctx.filename_ = path.string();
+    ctx.offset_ = text.size() * i / 4;
+    ctx.size_ = text.size() * (i + 1) / 4 - ctx.offset_;
+    auto client = cae::FormatFactory::Get("csv");
+    auto* csv = dynamic_cast<cae::CsvFormatClient*>(client.get());
+    if (csv == nullptr) {
+      return false;
+    }
+    csv->Import(ctx);
+    const cae::ColumnTable& table = csv->Table();
+    rows += table.rows;
+    named = named || (i == 0 && table.names[0] == "t");
+    for (double v : table.columns.empty() ? std::vector<double>()
+                                          : table.columns[0]) {
+      sum += v;
+    }
+  }
+  fs::remove(path);
+  return named && rows == 500 && sum == 499.0 * 500 / 2;
+}
+
+int main() {
+  std::cout << "========================================" << std::endl;
+  std::cout << "  CSV Format Client Unit Tests" << std::endl;
+  std::cout << "========================================" << std::endl << std::endl;
+
+  TEST(Header_and_values);
+  TEST(No_header);
+  TEST(Fields);
+  TEST(Errors);
+  TEST(Delimiter);
+  TEST(Parallel_chunks);
+  TEST(PackColumns);
+  TEST(SelectColumns);
+  TEST(Import_partitions);
+
+  // Summary
+  std::cout << std::endl << "========================================" << std::endl;
+  std::cout << "Test Summary:" << std::endl;
+  std::cout << "  Passed: " << tests_passed << std::endl;
+  std::cout << "  Failed: " << tests_failed << std::endl;
+  std::cout << "========================================" << std::endl;
+
+  if (tests_failed == 0) {
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+  } else {
+    std::cout << "Some tests failed." << std::endl;
+    return 1;
+  }
+}
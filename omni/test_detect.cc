@@ -0,0 +1,149 @@
+///
+/// test_detect.cc - Unit tests for magic-byte format detection
+///
+#include "format/binary_file_omni.h"
+#include "format/csv_format_client.h"
+#include "format/format_factory.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+// Test result tracking
+int tests_passed = 0;
+int tests_failed = 0;
+
+// Directory holding the A46_xx sample files
+std::string data_dir = "../data";
+
+#define TEST(name) \
+  std::cout << "Running test: " << #name << "..." << std::endl; \
+  if (test_##name()) { \
+    tests_passed++; \
+    std::cout << "  PASSED" << std::endl; \
+  } else { \
+    tests_failed++; \
+    std::cout << "  FAILED" << std::endl; \
+  }
+
+cae::Format sniff(const std::string& head) {
+  return cae::FormatFactory::Sniff(
+      reinterpret_cast<const unsigned char*>(head.data()), head.size());
+}
+
+bool test_Magic() {
+  std::string hdf5("\x89HDF\r\n\x1a\n\0\0", 10);
+  std::string user_block = std::string(512, '\0') + hdf5;
+  return sniff(hdf5) == cae::Format::kHDF5 &&
+         sniff(user_block) == cae::Format::kHDF5 &&
+         sniff("PAR1\x15\x04") == cae::Format::kParquet &&
+         sniff("ARROW1\0\0") == cae::Format::kFeather &&
+         sniff("\x1f\x8b\x08\x00") == cae::Format::kGzip &&
+         sniff("\x28\xb5\x2f\xfd\x04") == cae::Format::kZstd &&
+         sniff(std::string("ab\0cd\n", 6)) == cae::Format::kBinary &&
+         sniff("") == cae::Format::kBinary;
+}
+
+bool test_Text() {
+  // Numeric rows with a constant field count are CSV, with or without a
+  // header; anything else with newlines is lines
+  return sniff("a,b\n1,2\n3.5,-4e2\n") == cae::Format::kCsv &&
+         sniff("1,2\r\n3,4\r\n\r\n5,6") == cae::Format::kCsv &&
+         sniff("a,b\n1,2\n3,4,5\n") == cae::Format::kLines &&
+         sniff("name,city\nann,oslo\n") == cae::Format::kLines &&
+         sniff("1\n2\n3\n") == cae::Format::kLines &&
+         sniff("no newline") == cae::Format::kBinary;
+}
+
+bool test_Truncated_record() {
+  // A head cut off mid-record ignores the partial last record
+  std::string text = "x,y\n";
+  while (text.size() < cae::FormatFactory::kSniffBytes) {
+    text += "1.25,2.5\n";
+  }
+  text.resize(cae::FormatFactory::kSniffBytes);
+  text.back() = ',';
+  return sniff(text) == cae::Format::kCsv;
+}
+
+bool test_Sample_files() {
+  struct Case {
+    const char* file;
+    cae::Format format;
+  } cases[] = {{"A46_xx.csv", cae::Format::kCsv},
+               {"A46_xx.parquet", cae::Format::kParquet},
+               {"A46_xx.feather", cae::Format::kFeather},
+               {"A46_xx.h5", cae::Format::kHDF5}};
+  for (const Case& c : cases) {
+    cae::Format format;
+    if (!cae::FormatFactory::DetectFormat(data_dir + "/" + c.file, format) ||
+        format != c.format) {
+      std::cout << "  " << c.file << ": "
+                << cae::FormatFactory::Name(format) << std::endl;
+      return false;
+    }
+  }
+  cae::Format format;
+  return !cae::FormatFactory::DetectFormat(data_dir + "/missing", format) &&
+         !cae::FormatFactory::DetectFormat(data_dir, format);
+}
+
+bool test_Cache_follows_changes() {
+  fs::path path = fs::temp_directory_path() / "omni_test_detect.dat";
+  std::ofstream(path, std::ios::binary | std::ios::trunc) << "a,b\n1,2\n";
+  cae::Format first;
+  cae::Format second;
+  if (!cae::FormatFactory::DetectFormat(path.string(), first)) {
+    return false;
+  }
+  // Same path, new content and size: detected again, not served stale
+  std::ofstream(path, std::ios::binary | std::ios::trunc) << "PAR1 not csv";
+  bool ok = cae::FormatFactory::DetectFormat(path.string(), second);
+  fs::remove(path);
+  return ok && first == cae::Format::kCsv && second == cae::Format::kParquet;
+}
+
+bool test_Detect_client() {
+  auto csv = cae::FormatFactory::Detect(data_dir + "/A46_xx.csv");
+  auto parquet = cae::FormatFactory::Detect(data_dir + "/A46_xx.parquet");
+  bool parquet_ok =
+      cae::FormatFactory::Available(cae::Format::kParquet)
+          ? parquet != nullptr
+          : dynamic_cast<cae::BinaryFileOmni*>(parquet.get()) != nullptr;
+  return dynamic_cast<cae::CsvFormatClient*>(csv.get()) != nullptr &&
+         parquet_ok &&
+         cae::FormatFactory::Detect(data_dir + "/missing") == nullptr;
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1) {
+    data_dir = argv[1];
+  }
+  std::cout << "========================================" << std::endl;
+  std::cout << "  Format Detection Unit Tests" << std::endl;
+  std::cout << "========================================" << std::endl << std::endl;
+
+  TEST(Magic);
+  TEST(Text);
+  TEST(Truncated_record);
+  TEST(Sample_files);
+  TEST(Cache_follows_changes);
+  TEST(Detect_client);
+
+  // Summary
+  std::cout << std::endl << "========================================" << std::endl;
+  std::cout << "Test Summary:" << std::endl;
+  std::cout << "  Passed: " << tests_passed << std::endl;
+  std::cout << "  Failed: " << tests_failed << std::endl;
+  std::cout << "========================================" << std::endl;
+
+  if (tests_failed == 0) {
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+  } else {
+    std::cout << "Some tests failed." << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,125 @@
+///
+/// test_digest.cc - Unit tests for SHA-256 and cached buffer digests
+///
+#include "catalog.h"
+#include "sha256.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+// Test result tracking
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name) \
+  std::cout << "Running test: " << #name << "..." << std::endl; \
+  if (test_##name()) { \
+    tests_passed++; \
+    std::cout << "  PASSED" << std::endl; \
+  } else { \
+    tests_failed++; \
+    std::cout << "  FAILED" << std::endl; \
+  }
+
+bool test_Empty() {
+  return cae::Sha256::Hex("", 0) ==
+         "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855";
+}
+
+bool test_Abc() {
+  return cae::Sha256::Hex("abc", 3) ==
+         "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad";
+}
+
+bool test_Million_a_chunked() {
+  // Odd chunk sizes exercise the partial-block path
+  std::string chunk(997, 'a');
+  cae::Sha256 sha;
+  size_t left = 1000000;
+  while (left > 0) {
+    size_t n = left < chunk.size() ? left : chunk.size();
+    sha.Update(chunk.data(), n);
+    left -= n;
+  }
+  return cae::Sha256::ToHex(sha.Final()) ==
+         "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0";
+}
+
+bool test_File_matches_memory() {
+  fs::path file = fs::temp_directory_path() / "omni_test_digest.bin";
+  std::string data(3 * 1024 * 1024 + 17, '\0');
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<char>(i * 31 + 7);
+  }
+  {
+    std::ofstream out(file, std::ios::binary);
+    out.write(data.data(), data.size());
+  }
+  bool ok = cae::Sha256HexFile(file.string()) ==
+            cae::Sha256::Hex(data.data(), data.size());
+  fs::remove(file);
+  return ok;
+}
+
+bool test_Catalog_digest() {
+  // Work in a scratch directory so the build tree's catalog is untouched
+  fs::path cwd = fs::current_path();
+  fs::path scratch = fs::temp_directory_path() / "omni_test_digest";
+  fs::remove_all(scratch);
+  fs::create_directories(scratch);
+  fs::current_path(scratch);
+
+  {
+    std::ofstream out("buf", std::ios::binary);
+    out << "hello";
+  }
+  cae::BufferMeta meta;
+  meta.name = "buf";
+  meta.backend = "file";
+  meta.size = 5;
+  meta.stored_size = 5;
+  bool ok = cae::StatBufferFile("buf", meta.file_size, meta.mtime) &&
+            meta.file_size == 5 && !cae::StatBufferFile("nope", meta.file_size,
+                                                        meta.mtime);
+  meta.file_size = 5;
+  meta.digest = cae::Sha256HexFile("buf");
+  ok = ok && cae::WriteBufferMeta(meta) == 0;
+
+  cae::BufferMeta back;
+  ok = ok && cae::ReadBufferMeta("buf", back) == 0 &&
+       back.digest == meta.digest && back.file_size == 5 &&
+       back.mtime == meta.mtime;
+  fs::current_path(cwd);
+  fs::remove_all(scratch);
+  return ok;
+}
+
+int main() {
+  std::cout << "========================================" << std::endl;
+  std::cout << "  Digest Unit Tests" << std::endl;
+  std::cout << "========================================" << std::endl << std::endl;
+
+  TEST(Empty);
+  TEST(Abc);
+  TEST(Million_a_chunked);
+  TEST(File_matches_memory);
+  TEST(Catalog_digest);
+
+  // Summary
+  std::cout << std::endl << "========================================" << std::endl;
+  std::cout << "Test Summary:" << std::endl;
+  std::cout << "  Passed: " << tests_passed << std::endl;
+  std::cout << "  Failed: " << tests_failed << std::endl;
+  std::cout << "========================================" << std::endl;
+
+  if (tests_failed == 0) {
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+  } else {
+    std::cout << "Some tests failed." << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,186 @@
+///
+/// test_job_plan.cc - Unit tests for compiled job plans
+///
+#include "job_plan.h"
+#include "omni_processing.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+// Test result tracking
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name) \
+  std::cout << "Running test: " << #name << "..." << std::endl; \
+  if (test_##name()) { \
+    tests_passed++; \
+    std::cout << "  PASSED" << std::endl; \
+  } else { \
+    tests_failed++; \
+    std::cout << "  FAILED" << std::endl; \
+  }
+
+// A job directory with one data file and a job of two entries
+fs::path make_job(fs::path &yaml) {
+  fs::path dir = fs::temp_directory_path() / "omni_test_job_plan";
+  fs::remove_all(dir);
+  fs::create_directories(dir / "in");
+  std::ofstream(dir / "in" / "a.csv") << "x,y\n1,2\n";
+  yaml = dir / "job.yml";
+  std::ofstream(yaml) << "name: plan_job\n"
+                         "max_scale: 3\n"
+                         "data:\n"
+                         "- path: " << (dir / "in" / "a.csv").string() << "\n"
+                         "  offset: 4\n"
+                         "  size: 100\n"
+                         "  hash: abc\n"
+                         "  block: auto\n"
+                         "  description:\n"
+                         "    - csv\n"
+                         "- path: " << (dir / "in").string() << "/**/*.csv\n"
+                         "  format: auto\n";
+  return dir;
+}
+
+bool same(const OmniJobConfig &a, const OmniJobConfig &b) {
+  if (a.name != b.name || a.max_scale != b.max_scale ||
+      a.data_entries.size() != b.data_entries.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.data_entries.size(); ++i) {
+    const OmniJobConfig::DataEntry &x = a.data_entries[i];
+    const OmniJobConfig::DataEntry &y = b.data_entries[i];
+    if (x.paths != y.paths || x.pattern != y.pattern || x.range != y.range ||
+        x.offset != y.offset || x.size != y.size ||
+        x.description != y.description || x.hash != y.hash ||
+        x.block != y.block || x.format != y.format) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool test_Round_trip() {
+  fs::path yaml;
+  fs::path dir = make_job(yaml);
+  OmniJobConfig parsed = ParseOmniFile(yaml.string());
+  std::string path = (dir / "job.yml.plan").string();
+  bool written = cae::WriteJobPlan(path, "key", parsed) == 0;
+  OmniJobConfig loaded;
+  bool read = cae::ReadJobPlan(path, "key", loaded) == 0;
+  // A plan under another key is stale
+  OmniJobConfig other;
+  bool stale = cae::ReadJobPlan(path, "other", other) != 0;
+  fs::remove_all(dir);
+  return written && read && stale && same(parsed, loaded) &&
+         loaded.data_entries.size() == 2 &&
+         loaded.data_entries[1].pattern.find("**") != std::string::npos;
+}
+
+bool test_Malformed() {
+  fs::path yaml;
+  fs::path dir = make_job(yaml);
+  OmniJobConfig parsed = ParseOmniFile(yaml.string());
+  std::string path = (dir / "job.yml.plan").string();
+  cae::WriteJobPlan(path, "key", parsed);
+  // Cut short, or with bytes after the config
+  std::uintmax_t size = fs::file_size(path);
+  fs::resize_file(path, size - 3);
+  OmniJobConfig config;
+  bool truncated = cae::ReadJobPlan(path, "key", config) != 0;
+  cae::WriteJobPlan(path, "key", parsed);
+  std::ofstream(path, std::ios::app) << "x";
+  bool trailing = cae::ReadJobPlan(path, "key", config) != 0;
+  bool missing = cae::ReadJobPlan((dir / "none").string(), "key", config) != 0;
+  fs::remove_all(dir);
+  return truncated && trailing && missing;
+}
+
+bool test_LoadJob_cache() {
+  fs::path yaml;
+  fs::path dir = make_job(yaml);
+  unsetenv("OMNI_PLAN_DIR");
+  fs::path plan = dir / "job.yml.plan";
+  OmniJobConfig first = cae::LoadJob(yaml.string());
+  bool compiled = fs::exists(plan);
+  OmniJobConfig second = cae::LoadJob(yaml.string());
+  // A changed job file compiles a new plan
+  std::string key = cae::JobPlanKey(yaml.string());
+  std::ofstream(yaml, std::ios::app) << "# edited\n";
+  bool rekeyed = cae::JobPlanKey(yaml.string()) != key;
+  OmniJobConfig third = cae::LoadJob(yaml.string());
+  OmniJobConfig cached;
+  bool recompiled =
+      cae::ReadJobPlan(plan.string(), cae::JobPlanKey(yaml.string()),
+                       cached) == 0;
+  fs::remove_all(dir);
+  return compiled && same(first, second) && rekeyed && same(first, third) &&
+         recompiled && same(first, cached);
+}
+
+bool test_Plan_dir() {
+  fs::path yaml;
+  fs::path dir = make_job(yaml);
+  setenv("OMNI_PLAN_DIR", (dir / "plans").string().c_str(), 1);
+  bool elsewhere = cae::JobPlanPath(yaml.string()) ==
+                   (dir / "plans" / "job.yml.plan").string();
+  cae::LoadJob(yaml.string());
+  bool written = fs::exists(dir / "plans" / "job.yml.plan") &&
+                 !fs::exists(dir / "job.yml.plan");
+  // Disabled: nothing is written
+  setenv("OMNI_PLAN_DIR", "", 1);
+  bool disabled = cae::JobPlanPath(yaml.string()).empty();
+  fs::remove_all(dir / "plans");
+  cae::LoadJob(yaml.string());
+  bool none = !fs::exists(dir / "plans") && !fs::exists(dir / "job.yml.plan");
+  unsetenv("OMNI_PLAN_DIR");
+  fs::remove_all(dir);
+  return elsewhere && written && disabled && none;
+}
+
+bool test_Unresolved_not_cached() {
+  // An entry whose file does not exist yet would resolve differently
+  // once it does
+  fs::path yaml;
+  fs::path dir = make_job(yaml);
+  unsetenv("OMNI_PLAN_DIR");
+  std::ofstream(yaml) << "name: later\n"
+                         "data:\n"
+                         "- path: " << (dir / "later.csv").string() << "\n";
+  cae::LoadJob(yaml.string());
+  bool uncached = !fs::exists(dir / "job.yml.plan");
+  fs::remove_all(dir);
+  return uncached;
+}
+
+int main() {
+  std::cout << "========================================" << std::endl;
+  std::cout << "  Job Plan Unit Tests" << std::endl;
+  std::cout << "========================================" << std::endl << std::endl;
+
+  TEST(Round_trip);
+  TEST(Malformed);
+  TEST(LoadJob_cache);
+  TEST(Plan_dir);
+  TEST(Unresolved_not_cached);
+
+  // Summary
+  std::cout << std::endl << "========================================" << std::endl;
+  std::cout << "Test Summary:" << std::endl;
+  std::cout << "  Passed: " << tests_passed << std::endl;
+  std::cout << "  Failed: " << tests_failed << std::endl;
+  std::cout << "========================================" << std::endl;
+
+  if (tests_failed == 0) {
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+  } else {
+    std::cout << "Some tests failed." << std::endl;
+    return 1;
+  }
+}
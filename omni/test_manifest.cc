@@ -0,0 +1,151 @@
+///
+/// test_manifest.cc - Unit tests for the per-job ingest manifest
+///
+#include "manifest.h"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+// Test result tracking
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name) \
+  std::cout << "Running test: " << #name << "..." << std::endl; \
+  if (test_##name()) { \
+    tests_passed++; \
+    std::cout << "  PASSED" << std::endl; \
+  } else { \
+    tests_failed++; \
+    std::cout << "  FAILED" << std::endl; \
+  }
+
+fs::path make_dir() {
+  fs::path dir = fs::temp_directory_path() / "omni_test_manifest";
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+  return dir;
+}
+
+void write(const fs::path &file, const std::string &text) {
+  std::ofstream(file, std::ios::binary | std::ios::trunc) << text;
+}
+
+// Move a file's mtime without touching its content
+void touch(const fs::path &file) {
+  fs::last_write_time(file,
+                      fs::last_write_time(file) + std::chrono::seconds(5));
+}
+
+bool test_New_and_unchanged() {
+  fs::path dir = make_dir();
+  fs::path file = dir / "a.csv";
+  write(file, "x,y\n1,2\n");
+  cae::IngestManifest manifest;
+  bool fresh = !manifest.Unchanged(file.string(), 0, 0);
+  bool recorded = manifest.Record(file.string(), 0, 0) == 0;
+  bool same = manifest.Unchanged(file.string(), 0, 0);
+  // Another range of the same file has not been read yet
+  bool other_range = !manifest.Unchanged(file.string(), 0, 4);
+  bool missing = manifest.Record((dir / "none").string(), 0, 0) != 0;
+  fs::remove_all(dir);
+  return fresh && recorded && same && other_range && missing &&
+         manifest.Size() == 1;
+}
+
+bool test_Changed_content() {
+  fs::path dir = make_dir();
+  fs::path file = dir / "a.csv";
+  write(file, "x,y\n1,2\n");
+  cae::IngestManifest manifest;
+  manifest.Record(file.string(), 0, 0);
+  // Same size, new bytes and mtime: read again
+  write(file, "x,y\n3,4\n");
+  touch(file);
+  bool same_size = !manifest.Unchanged(file.string(), 0, 0);
+  write(file, "x,y\n1,2\n3,4\n");
+  bool grown = !manifest.Unchanged(file.string(), 0, 0);
+  fs::remove_all(dir);
+  return same_size && grown;
+}
+
+bool test_Touched_and_renamed() {
+  fs::path dir = make_dir();
+  fs::path file = dir / "a.csv";
+  write(file, "x,y\n1,2\n");
+  cae::IngestManifest manifest;
+  manifest.Record(file.string(), 0, 0);
+  // A new mtime over the same content is refreshed, not read again
+  touch(file);
+  bool touched = manifest.Unchanged(file.string(), 0, 0);
+  // A rename keeps the inode: the entry moves to the new name
+  fs::path renamed = dir / "b.csv";
+  fs::rename(file, renamed);
+  bool moved = manifest.Unchanged(renamed.string(), 0, 0);
+  fs::remove_all(dir);
+  return touched && moved && manifest.Size() == 1;
+}
+
+bool test_Save_and_load() {
+  fs::path dir = make_dir();
+  fs::path file = dir / "name with spaces.csv";
+  write(file, "x,y\n1,2\n");
+  fs::path path = dir / "manifests" / "job.manifest";
+  cae::IngestManifest manifest;
+  manifest.Record(file.string(), 16, 1024);
+  bool saved = manifest.Save(path.string()) == 0;
+  std::ofstream(path, std::ios::app) << "garbage line\n";
+
+  cae::IngestManifest loaded;
+  loaded.Load(path.string());
+  cae::IngestManifest empty;
+  empty.Load((dir / "none.manifest").string());
+  bool same = loaded.Unchanged(file.string(), 16, 1024);
+  fs::remove_all(dir);
+  return saved && loaded.Size() == 1 && same && empty.Size() == 0;
+}
+
+bool test_Default_path() {
+  setenv("OMNI_MANIFEST_DIR", "/tmp/manifests", 1);
+  bool dir = cae::IngestManifest::DefaultPath("nightly/ingest") ==
+             "/tmp/manifests/nightly_ingest.manifest";
+  setenv("OMNI_MANIFEST_DIR", "", 1);
+  bool disabled = cae::IngestManifest::DefaultPath("nightly").empty();
+  unsetenv("OMNI_MANIFEST_DIR");
+  setenv("HOME", "/home/user", 1);
+  bool home = cae::IngestManifest::DefaultPath("nightly") ==
+              "/home/user/.wrp/manifests/nightly.manifest";
+  return dir && disabled && home;
+}
+
+int main() {
+  std::cout << "========================================" << std::endl;
+  std::cout << "  Ingest Manifest Unit Tests" << std::endl;
+  std::cout << "========================================" << std::endl << std::endl;
+
+  TEST(New_and_unchanged);
+  TEST(Changed_content);
+  TEST(Touched_and_renamed);
+  TEST(Save_and_load);
+  TEST(Default_path);
+
+  // Summary
+  std::cout << std::endl << "========================================" << std::endl;
+  std::cout << "Test Summary:" << std::endl;
+  std::cout << "  Passed: " << tests_passed << std::endl;
+  std::cout << "  Failed: " << tests_failed << std::endl;
+  std::cout << "========================================" << std::endl;
+
+  if (tests_failed == 0) {
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+  } else {
+    std::cout << "Some tests failed." << std::endl;
+    return 1;
+  }
+}
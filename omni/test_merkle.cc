@@ -0,0 +1,153 @@
+///
+/// test_merkle.cc - Unit tests for Merkle-tree hashing
+///
+#include "merkle.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Test result tracking
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name) \
+  std::cout << "Running test: " << #name << "..." << std::endl; \
+  if (test_##name()) { \
+    tests_passed++; \
+    std::cout << "  PASSED" << std::endl; \
+  } else { \
+    tests_failed++; \
+    std::cout << "  FAILED" << std::endl; \
+  }
+
+const fs::path kFile = fs::temp_directory_path() / "omni_test_merkle.bin";
+
+std::string make_file(size_t n) {
+  std::string data(n, '\0');
+  for (size_t i = 0; i < n; ++i) {
+    data[i] = static_cast<char>((i * 31) % 251);
+  }
+  std::ofstream out(kFile, std::ios::binary | std::ios::trunc);
+  out.write(data.data(), data.size());
+  return data;
+}
+
+bool test_Leaf_is_domain_separated() {
+  // SHA-256 of the single byte 0x00
+  return cae::Sha256::ToHex(cae::MerkleLeaf(nullptr, 0)) ==
+             "6e340b9cffb37a989ca544e6bb780a2c78901d3fb33738768511a30617afa01d" &&
+         cae::MerkleLeaf("a", 1) != cae::MerkleParent(cae::MerkleLeaf("", 0),
+                                                      cae::MerkleLeaf("", 0));
+}
+
+bool test_Root_shape() {
+  cae::Sha256::Digest a = cae::MerkleLeaf("a", 1);
+  cae::Sha256::Digest b = cae::MerkleLeaf("b", 1);
+  cae::Sha256::Digest c = cae::MerkleLeaf("c", 1);
+  // The unpaired leaf moves up unchanged
+  return cae::MerkleRoot({a}) == a &&
+         cae::MerkleRoot({a, b}) == cae::MerkleParent(a, b) &&
+         cae::MerkleRoot({a, b, c}) ==
+             cae::MerkleParent(cae::MerkleParent(a, b), c) &&
+         cae::MerkleRoot({}) == cae::MerkleLeaf(nullptr, 0);
+}
+
+bool test_LeafCount() {
+  return cae::MerkleLeafCount(0, 10) == 1 && cae::MerkleLeafCount(10, 10) == 1 &&
+         cae::MerkleLeafCount(11, 10) == 2 &&
+         cae::MerkleLeafCount(3 << 20) == 3;
+}
+
+bool test_File_root() {
+  std::string data = make_file(1000);
+  // Range [100, 1000) in 256-byte leaves: 256, 256, 256, 132
+  std::vector<cae::Sha256::Digest> leaves;
+  for (size_t off = 100; off < 1000; off += 256) {
+    size_t n = std::min<size_t>(256, 1000 - off);
+    leaves.push_back(cae::MerkleLeaf(data.data() + off, n));
+  }
+  std::string expected =
+      std::string("merkle:") + cae::Sha256::ToHex(cae::MerkleRoot(leaves));
+  return leaves.size() == 4 &&
+         cae::MerkleRootFile(kFile.string(), 100, 900, 256) == expected;
+}
+
+bool test_Split_hashing_matches() {
+  // Leaves hashed in separate runs, as ranks do, give the same root
+  make_file(5000);
+  std::vector<cae::Sha256::Digest> leaves;
+  size_t total = cae::MerkleLeafCount(5000, 512);
+  size_t runs[] = {3, 0, 4, total - 7};
+  size_t first = 0;
+  for (size_t count : runs) {
+    if (cae::MerkleHashLeaves(kFile.string(), 0, 5000, first, count, 512,
+                              leaves) != 0) {
+      return false;
+    }
+    first += count;
+  }
+  return std::string("merkle:") + cae::Sha256::ToHex(cae::MerkleRoot(leaves)) ==
+         cae::MerkleRootFile(kFile.string(), 0, 5000, 512);
+}
+
+bool test_Stripe_leaves_match() {
+  // Stripes of whole leaves hashed from memory, as a striped put does,
+  // give the root of the range
+  std::string data = make_file(5000);
+  std::vector<cae::Sha256::Digest> leaves;
+  size_t cuts[] = {0, 1024, 1024, 4096, 5000};
+  for (size_t i = 0; i + 1 < 5; ++i) {
+    std::vector<cae::Sha256::Digest> stripe =
+        cae::MerkleLeaves(data.data() + cuts[i], cuts[i + 1] - cuts[i], 512);
+    leaves.insert(leaves.end(), stripe.begin(), stripe.end());
+  }
+  return leaves.size() == cae::MerkleLeafCount(5000, 512) &&
+         cae::MerkleLeaves(data.data(), 0, 512).empty() &&
+         std::string("merkle:") + cae::Sha256::ToHex(cae::MerkleRoot(leaves)) ==
+             cae::MerkleRootFile(kFile.string(), 0, 5000, 512);
+}
+
+bool test_Short_file_throws() {
+  make_file(100);
+  try {
+    cae::MerkleRootFile(kFile.string(), 0, 200, 64);
+  } catch (const std::runtime_error&) {
+    return cae::IsMerkleHash("merkle:00") && !cae::IsMerkleHash("00merkle:");
+  }
+  return false;
+}
+
+int main() {
+  std::cout << "========================================" << std::endl;
+  std::cout << "  Merkle Unit Tests" << std::endl;
+  std::cout << "========================================" << std::endl << std::endl;
+
+  TEST(Leaf_is_domain_separated);
+  TEST(Root_shape);
+  TEST(LeafCount);
+  TEST(File_root);
+  TEST(Split_hashing_matches);
+  TEST(Stripe_leaves_match);
+  TEST(Short_file_throws);
+  fs::remove(kFile);
+
+  // Summary
+  std::cout << std::endl << "========================================" << std::endl;
+  std::cout << "Test Summary:" << std::endl;
+  std::cout << "  Passed: " << tests_passed << std::endl;
+  std::cout << "  Failed: " << tests_failed << std::endl;
+  std::cout << "========================================" << std::endl;
+
+  if (tests_failed == 0) {
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+  } else {
+    std::cout << "Some tests failed." << std::endl;
+    return 1;
+  }
+}
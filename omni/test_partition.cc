@@ -0,0 +1,171 @@
+///
+/// test_partition.cc - Unit tests for rank partitioning of byte ranges
+///
+#include "partition.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Test result tracking
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name) \
+  std::cout << "Running test: " << #name << "..." << std::endl; \
+  if (test_##name()) { \
+    tests_passed++; \
+    std::cout << "  PASSED" << std::endl; \
+  } else { \
+    tests_failed++; \
+    std::cout << "  FAILED" << std::endl; \
+  }
+
+// Slices must tile [offset, offset + nbyte) in rank order
+bool covers(uint64_t offset, uint64_t nbyte, int nranks) {
+  uint64_t next = offset;
+  uint64_t smallest = nbyte;
+  uint64_t largest = 0;
+  for (int rank = 0; rank < nranks; ++rank) {
+    cae::Slice s = cae::PartitionRange(offset, nbyte, rank, nranks);
+    if (s.offset != next) {
+      return false;
+    }
+    next += s.nbyte;
+    smallest = s.nbyte < smallest ? s.nbyte : smallest;
+    largest = s.nbyte > largest ? s.nbyte : largest;
+  }
+  return next == offset + nbyte && largest - smallest <= 1;
+}
+
+bool test_Even_split() {
+  cae::Slice s = cae::PartitionRange(100, 4096, 2, 4);
+  return s.offset == 100 + 2048 && s.nbyte == 1024 && covers(100, 4096, 4);
+}
+
+bool test_Uneven_split() {
+  // 10 bytes over 4 ranks: 3, 3, 2, 2
+  cae::Slice first = cae::PartitionRange(0, 10, 0, 4);
+  cae::Slice last = cae::PartitionRange(0, 10, 3, 4);
+  return first.nbyte == 3 && last.offset == 8 && last.nbyte == 2 &&
+         covers(7, 106922, 3) && covers(0, 1, 1);
+}
+
+bool test_More_ranks_than_bytes() {
+  cae::Slice idle = cae::PartitionRange(0, 3, 5, 8);
+  return covers(0, 3, 8) && idle.nbyte == 0 && idle.offset == 3;
+}
+
+bool test_Invalid_rank() {
+  cae::Slice s = cae::PartitionRange(0, 100, 4, 4);
+  return s.nbyte == 0 && cae::PartitionRange(0, 100, 0, 0).nbyte == 0;
+}
+
+// Aligned slices tile the range with every inner boundary on a block
+bool aligned(uint64_t offset, uint64_t nbyte, uint64_t block, int nranks) {
+  uint64_t next = offset;
+  for (int rank = 0; rank < nranks; ++rank) {
+    cae::Slice s = cae::PartitionAligned(offset, nbyte, block, rank, nranks);
+    if (s.offset != next) {
+      return false;
+    }
+    if (s.offset != offset && s.offset != offset + nbyte &&
+        s.offset % block != 0) {
+      return false;
+    }
+    next += s.nbyte;
+  }
+  return next == offset + nbyte;
+}
+
+bool test_Aligned_split() {
+  // 10 blocks of 4 KiB over 4 ranks: 3, 3, 2, 2 blocks
+  cae::Slice second = cae::PartitionAligned(0, 40960, 4096, 1, 4);
+  cae::Slice last = cae::PartitionAligned(0, 40960, 4096, 3, 4);
+  return second.offset == 12288 && second.nbyte == 12288 &&
+         last.offset == 32768 && last.nbyte == 8192 &&
+         aligned(0, 40960, 4096, 4) && aligned(0, 40960 + 17, 4096, 3);
+}
+
+bool test_Aligned_unaligned_range() {
+  // [1000, 11000) touches blocks 0, 1 and 2 of 4 KiB: boundaries at 4096
+  // and 8192, never inside a block
+  cae::Slice first = cae::PartitionAligned(1000, 10000, 4096, 0, 3);
+  cae::Slice last = cae::PartitionAligned(1000, 10000, 4096, 2, 3);
+  return first.offset == 1000 && first.nbyte == 3096 && last.offset == 8192 &&
+         last.nbyte == 2808 && aligned(1000, 10000, 4096, 3) &&
+         aligned(4095, 1 << 20, 4096, 7) && aligned(5, 3, 4096, 2);
+}
+
+bool test_Aligned_fewer_blocks_than_ranks() {
+  cae::Slice idle = cae::PartitionAligned(0, 8192, 4096, 3, 4);
+  return aligned(0, 8192, 4096, 4) && idle.nbyte == 0 &&
+         idle.offset == 8192 &&
+         cae::PartitionAligned(0, 0, 4096, 0, 2).nbyte == 0;
+}
+
+bool test_Aligned_byte_fallback() {
+  cae::Slice a = cae::PartitionAligned(7, 106922, 0, 1, 3);
+  cae::Slice b = cae::PartitionRange(7, 106922, 1, 3);
+  cae::Slice c = cae::PartitionAligned(7, 106922, 1, 1, 3);
+  return a.offset == b.offset && a.nbyte == b.nbyte && c.offset == b.offset &&
+         c.nbyte == b.nbyte;
+}
+
+bool test_DetectBlockSize() {
+  std::filesystem::path file =
+      std::filesystem::temp_directory_path() / "omni_test_partition.bin";
+  std::ofstream(file) << "x";
+  uint64_t block = cae::DetectBlockSize(file.string());
+  std::filesystem::remove(file);
+  return block > 0 && cae::DetectBlockSize("/nonexistent/omni") == 0;
+}
+
+bool test_ParseByteSize() {
+  uint64_t n = 0;
+  return cae::ParseByteSize("4096", n) && n == 4096 &&
+         cae::ParseByteSize("64K", n) && n == 65536 &&
+         cae::ParseByteSize("4M", n) && n == 4194304 &&
+         cae::ParseByteSize("1G", n) && n == 1073741824 &&
+         cae::ParseByteSize("0", n) && n == 0 &&
+         !cae::ParseByteSize("", n) && !cae::ParseByteSize("-1", n) &&
+         !cae::ParseByteSize("4X", n) && !cae::ParseByteSize("auto", n);
+}
+
+bool test_StripeName() {
+  return cae::StripeName("cae", 0) == "cae.0" &&
+         cae::StripeName("a/b", 12) == "a/b.12";
+}
+
+int main() {
+  std::cout << "========================================" << std::endl;
+  std::cout << "  Partition Unit Tests" << std::endl;
+  std::cout << "========================================" << std::endl << std::endl;
+
+  TEST(Even_split);
+  TEST(Uneven_split);
+  TEST(More_ranks_than_bytes);
+  TEST(Invalid_rank);
+  TEST(Aligned_split);
+  TEST(Aligned_unaligned_range);
+  TEST(Aligned_fewer_blocks_than_ranks);
+  TEST(Aligned_byte_fallback);
+  TEST(DetectBlockSize);
+  TEST(ParseByteSize);
+  TEST(StripeName);
+
+  // Summary
+  std::cout << std::endl << "========================================" << std::endl;
+  std::cout << "Test Summary:" << std::endl;
+  std::cout << "  Passed: " << tests_passed << std::endl;
+  std::cout << "  Failed: " << tests_failed << std::endl;
+  std::cout << "========================================" << std::endl;
+
+  if (tests_failed == 0) {
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+  } else {
+    std::cout << "Some tests failed." << std::endl;
+    return 1;
+  }
+}
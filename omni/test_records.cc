@@ -0,0 +1,202 @@
+///
+/// test_records.cc - Unit tests for record-boundary splitting
+///
+#include "format/lines_file_omni.h"
+#include "format/record_splitter.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+// Test result tracking
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name) \
+  std::cout << "Running test: " << #name << "..." << std::endl; \
+  if (test_##name()) { \
+    tests_passed++; \
+    std::cout << "  PASSED" << std::endl; \
+  } else { \
+    tests_failed++; \
+    std::cout << "  FAILED" << std::endl; \
+  }
+
+std::string write_file(const std::string& name, const std::string& text) {
+  fs::path path = fs::temp_directory_path() / name;
+  std::ofstream(path, std::ios::binary | std::ios::trunc) << text;
+  return path.string();
+}
+
+// Every split point in [0, size] must give ranges that tile the records
+// and each start just after a delimiter outside quotes
+bool splits_whole(const std::string& path, const std::string& text,
+                  const cae::RecordOptions& options, int parts) {
+  uint64_t size = text.size();
+  uint64_t next = 0;
+  for (int i = 0; i < parts; ++i) {
+    uint64_t offset = size * i / parts;
+    uint64_t nbyte = size * (i + 1) / parts - offset;
+    cae::RecordRange range;
+    if (cae::AlignToRecords(path, offset, nbyte, options, range) != 0) {
+      return false;
+    }
+    if (i == 0) {
+      next = options.header ? range.header_nbyte : 0;
+    }
+    if (range.offset != next && range.nbyte != 0) {
+      return false;
+    }
+    if (range.nbyte != 0) {
+      next = range.offset + range.nbyte;
+    }
+  }
+  return next == size;
+}
+
+bool test_FindRecordEnd() {
+  // Long enough for the vector loop and the scalar tail
+  std::string text = "a,\"b\nc\",d,eeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeee\nf";
+  bool in_quotes = false;
+  const char* hit = cae::FindRecordEnd(text.data(), text.data() + text.size(),
+                                       '\n', '"', in_quotes);
+  bool quoted = hit == text.data() + text.find("e\nf") + 1 && !in_quotes;
+  in_quotes = false;
+  hit = cae::FindRecordEnd(text.data(), text.data() + text.size(), '\n', '\0',
+                           in_quotes);
+  return quoted && hit == text.data() + 4;
+}
+
+bool test_CountByte() {
+  std::string text(1000, 'x');
+  text[0] = text[16] = text[999] = '"';
+  return cae::CountByte(text.data(), text.size(), '"') == 3 &&
+         cae::CountByte(text.data(), 15, '"') == 1 &&
+         cae::CountByte(text.data(), 0, '"') == 0;
+}
+
+bool test_Boundaries() {
+  std::string text = "id,v\n1,10\n2,20\n3,30\n";
+  std::string path = write_file("omni_test_records.csv", text);
+  cae::RecordOptions options;
+  uint64_t at_start = 1;
+  uint64_t mid = 0;
+  uint64_t on_record = 0;
+  uint64_t past = 0;
+  bool ok = cae::RecordBoundary(path, 0, text.size(), options, at_start) == 0 &&
+            cae::RecordBoundary(path, 6, text.size(), options, mid) == 0 &&
+            cae::RecordBoundary(path, 10, text.size(), options, on_record) == 0 &&
+            cae::RecordBoundary(path, 19, text.size(), options, past) == 0;
+  fs::remove(path);
+  return ok && at_start == 0 && mid == 10 && on_record == 10 &&
+         past == text.size();
+}
+
+bool test_Quoted_split() {
+  // Quoted fields with embedded newlines and escaped quotes
+  std::string text = "name,note\n";
+  for (int i = 0; i < 200; ++i) {
+    text += std::to_string(i) + ",\"line one\nline \"\"two\"\"\"\n";
+  }
+  std::string path = write_file("omni_test_records_quoted.csv", text);
+  cae::RecordOptions options;
+  options.quote = '"';
+  bool ok = true;
+  for (int parts = 1; parts <= 9 && ok; ++parts) {
+    ok = splits_whole(path, text, options, parts);
+  }
+  // Ignoring quotes would split inside the quoted field
+  cae::RecordRange range;
+  cae::AlignToRecords(path, 15, 100, options, range);
+  ok = ok && text.compare(range.offset, 3, "1,\"") == 0;
+  options.quote = '\0';
+  cae::AlignToRecords(path, 15, 100, options, range);
+  ok = ok && text.compare(range.offset, 3, "lin") == 0;
+  fs::remove(path);
+  return ok;
+}
+
+bool test_Quote_fallback() {
+  // Every quote sits next to a separator, delimiter or quote, so none
+  // tells the state locally and the quotes before a boundary are counted
+  std::string text;
+  for (int i = 0; i < 100; ++i) {
+    text += "\"\",\",\n,\"\n";
+  }
+  std::string path = write_file("omni_test_records_fallback.csv", text);
+  cae::RecordOptions options;
+  options.quote = '"';
+  bool ok = true;
+  for (int parts = 1; parts <= 9 && ok; ++parts) {
+    ok = splits_whole(path, text, options, parts);
+  }
+  fs::remove(path);
+  return ok;
+}
+
+bool test_Header_skipped() {
+  std::string text = "id,v\n1,10\n2,20\n3,30";
+  std::string path = write_file("omni_test_records_header.csv", text);
+  cae::RecordOptions options;
+  options.header = true;
+  cae::RecordRange first;
+  cae::RecordRange second;
+  bool ok = cae::AlignToRecords(path, 0, 10, options, first) == 0 &&
+            cae::AlignToRecords(path, 10, 100, options, second) == 0 &&
+            splits_whole(path, text, options, 4);
+  fs::remove(path);
+  return ok && first.header_nbyte == 5 && first.offset == 5 &&
+         first.nbyte == 5 && second.offset == 10 &&
+         second.nbyte == text.size() - 10;
+}
+
+bool test_LinesFileOmni_counts() {
+  std::string text = "a\n\"b\nb\"\nc\nd";  // 4 records, no final newline
+  std::string path = write_file("omni_test_records_lines.txt", text);
+  size_t total = 0;
+  for (int i = 0; i < 3; ++i) {
+    cae::FormatContext ctx;
+    ctx.filename_ = path;
+    ctx.offset_ = text.size() * i / 3;
+    ctx.size_ = text.size() * (i + 1) / 3 - ctx.offset_;
+    cae::RecordOptions options;
+    options.quote = '"';
+    cae::LinesFileOmni lines(options);
+    lines.Import(ctx);
+    total += lines.Records();
+  }
+  fs::remove(path);
+  return total == 4;
+}
+
+int main() {
+  std::cout << "========================================" << std::endl;
+  std::cout << "  Record Splitter Unit Tests" << std::endl;
+  std::cout << "========================================" << std::endl << std::endl;
+
+  TEST(FindRecordEnd);
+  TEST(CountByte);
+  TEST(Boundaries);
+  TEST(Quoted_split);
+  TEST(Quote_fallback);
+  TEST(Header_skipped);
+  TEST(LinesFileOmni_counts);
+
+  // Summary
+  std::cout << std::endl << "========================================" << std::endl;
+  std::cout << "Test Summary:" << std::endl;
+  std::cout << "  Passed: " << tests_passed << std::endl;
+  std::cout << "  Failed: " << tests_failed << std::endl;
+  std::cout << "========================================" << std::endl;
+
+  if (tests_failed == 0) {
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+  } else {
+    std::cout << "Some tests failed." << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,199 @@
+///
+/// test_scale_model.cc - Unit tests for process counts learned from run history
+///
+#include "repo/filesystem_repo_omni.h"
+#include "scale_model.h"
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+// Test result tracking
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name) \
+  std::cout << "Running test: " << #name << "..." << std::endl; \
+  if (test_##name()) { \
+    tests_passed++; \
+    std::cout << "  PASSED" << std::endl; \
+  } else { \
+    tests_failed++; \
+    std::cout << "  FAILED" << std::endl; \
+  }
+
+constexpr uint64_t kGB = 1000000000ULL;
+
+// Runs of a format that take c + bytes * (a + b / nprocs) seconds
+void add_runs(cae::ScaleModel& model, const std::string& format, double c,
+              double a, double b) {
+  for (uint64_t gb : {1, 4, 16}) {
+    for (int nprocs : {1, 2, 4, 8, 16}) {
+      cae::ScaleObservation obs;
+      obs.format = format;
+      obs.medium = "lustre";
+      obs.bytes = gb * kGB;
+      obs.nprocs = nprocs;
+      obs.seconds = c + obs.bytes * (a + b / nprocs);
+      model.Add(obs);
+    }
+  }
+}
+
+bool near(double x, double y) {
+  return std::fabs(x - y) <= 1e-6 * std::fabs(y) + 1e-12;
+}
+
+bool test_Fit_recovers_terms() {
+  cae::ScaleModel model;
+  add_runs(model, "binary", 0.5, 1e-10, 4e-9);
+  cae::ScaleFit fit;
+  return model.Fit("binary", "lustre", fit) && fit.observations == 15 &&
+         near(fit.c, 0.5) && near(fit.a, 1e-10) && near(fit.b, 4e-9);
+}
+
+bool test_Plateau_gets_few_processes() {
+  // Storage-bound: a large shared per-byte term, so extra readers soon
+  // stop paying for themselves
+  cae::ScaleModel model;
+  add_runs(model, "csv", 0.1, 2e-9, 6e-9);
+  int nprocs = 0;
+  int nthreads = 0;
+  if (!model.Recommend("csv", "lustre", 8 * kGB, 64, nprocs, nthreads)) {
+    return false;
+  }
+  return nprocs == 2 && nthreads == 1;
+}
+
+bool test_Scalable_reads_get_many() {
+  cae::ScaleModel model;
+  add_runs(model, "binary", 0.1, 1e-12, 4e-9);
+  int nprocs = 0;
+  int nthreads = 0;
+  bool capped = model.Recommend("binary", "lustre", 64 * kGB, 32, nprocs,
+                                nthreads) &&
+                nprocs == 32;
+  // A small file is all launch cost: one process
+  bool small = model.Recommend("binary", "lustre", 1000000, 32, nprocs,
+                               nthreads) &&
+               nprocs == 1;
+  return capped && small;
+}
+
+bool test_Fallbacks() {
+  cae::ScaleModel model;
+  int nprocs = 0;
+  int nthreads = 0;
+  // Empty history, or runs all at one scale, cannot be fitted
+  if (model.Recommend("csv", "ext4", kGB, 8, nprocs, nthreads)) {
+    return false;
+  }
+  for (int i = 0; i < 5; ++i) {
+    cae::ScaleObservation obs;
+    obs.format = "csv";
+    obs.medium = "ext4";
+    obs.bytes = (i + 1) * kGB;
+    obs.nprocs = 4;
+    obs.seconds = 1.0 + i;
+    model.Add(obs);
+  }
+  if (model.Recommend("csv", "ext4", kGB, 8, nprocs, nthreads)) {
+    return false;
+  }
+  // Another format's runs on another medium still teach something
+  add_runs(model, "parquet", 0.1, 1e-12, 4e-9);
+  return model.Recommend("csv", "ext4", 64 * kGB, 8, nprocs, nthreads) &&
+         nprocs > 1;
+}
+
+bool test_History_file() {
+  fs::path path = fs::temp_directory_path() / "omni_test_scale" / "history";
+  fs::remove_all(path.parent_path());
+  cae::ScaleObservation obs;
+  obs.format = "csv";
+  obs.medium = "ext4";
+  obs.bytes = 1234;
+  obs.nprocs = 3;
+  obs.nthreads = 2;
+  obs.seconds = 0.25;
+  bool appended = cae::ScaleModel::Append(path.string(), obs) == 0 &&
+                  cae::ScaleModel::Append(path.string(), obs) == 0;
+  std::ofstream(path, std::ios::app) << "garbage line\n";
+  // Runs that read nothing are not history
+  obs.bytes = 0;
+  bool skipped = cae::ScaleModel::Append(path.string(), obs) != 0;
+
+  cae::ScaleModel model;
+  model.Load(path.string());
+  cae::ScaleModel missing;
+  missing.Load((path.parent_path() / "none").string());
+  fs::remove_all(path.parent_path());
+  return appended && skipped && model.Observations().size() == 2 &&
+         model.Observations()[1].nthreads == 2 &&
+         model.Observations()[1].seconds == 0.25 &&
+         missing.Observations().empty();
+}
+
+bool test_Repo_client() {
+  fs::path path = fs::temp_directory_path() / "omni_test_scale_history";
+  fs::path file = fs::temp_directory_path() / "omni_test_scale.bin";
+  fs::remove(path);
+  std::ofstream(file, std::ios::binary) << std::string(4096, 'x');
+
+  // Without history, the 64MB rule: one process for a small file
+  cae::FilesystemRepoClient plain("");
+  int nprocs = 0;
+  int nthreads = 0;
+  plain.RecommendScaleForFile(file.string(), 16, nprocs, nthreads);
+  bool rule = nprocs == 1 && nthreads == 1;
+
+  // With history that says this medium scales, a large read gets spread
+  std::string medium = cae::ScaleModel::StorageMedium(file.string());
+  for (uint64_t gb : {1, 4, 16}) {
+    for (int n : {1, 2, 4, 8}) {
+      cae::ScaleObservation obs;
+      obs.format = "binary";
+      obs.medium = medium;
+      obs.bytes = gb * kGB;
+      obs.nprocs = n;
+      obs.seconds = 0.1 + obs.bytes * (1e-12 + 4e-9 / n);
+      cae::ScaleModel::Append(path.string(), obs);
+    }
+  }
+  cae::FilesystemRepoClient learned(path.string());
+  learned.RecommendScale(16, nprocs, nthreads);
+  fs::remove(path);
+  fs::remove(file);
+  return rule && learned.Model().Observations().size() == 12 && nprocs == 16;
+}
+
+int main() {
+  std::cout << "========================================" << std::endl;
+  std::cout << "  Scale Model Unit Tests" << std::endl;
+  std::cout << "========================================" << std::endl << std::endl;
+
+  TEST(Fit_recovers_terms);
+  TEST(Plateau_gets_few_processes);
+  TEST(Scalable_reads_get_many);
+  TEST(Fallbacks);
+  TEST(History_file);
+  TEST(Repo_client);
+
+  // Summary
+  std::cout << std::endl << "========================================" << std::endl;
+  std::cout << "Test Summary:" << std::endl;
+  std::cout << "  Passed: " << tests_passed << std::endl;
+  std::cout << "  Failed: " << tests_failed << std::endl;
+  std::cout << "========================================" << std::endl;
+
+  if (tests_failed == 0) {
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+  } else {
+    std::cout << "Some tests failed." << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,166 @@
+///
+/// test_scheduler.cc - Unit tests for least-loaded placement of job runs
+///
+#include "scheduler.h"
+#include <algorithm>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Test result tracking
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name) \
+  std::cout << "Running test: " << #name << "..." << std::endl; \
+  if (test_##name()) { \
+    tests_passed++; \
+    std::cout << "  PASSED" << std::endl; \
+  } else { \
+    tests_failed++; \
+    std::cout << "  FAILED" << std::endl; \
+  }
+
+std::vector<std::string> hosts(int n) {
+  std::vector<std::string> names;
+  for (int i = 0; i < n; ++i) {
+    names.push_back("n" + std::to_string(i));
+  }
+  return names;
+}
+
+bool test_Least_loaded() {
+  cae::NodeScheduler scheduler(hosts(4));
+  auto a = scheduler.Allocate(2, 2.0);
+  auto b = scheduler.Allocate(2, 2.0);
+  auto c = scheduler.Allocate(1, 5.0);
+  // Idle nodes first, lowest index on ties; never the same node twice
+  return a.nodes == std::vector<int>{0, 1} &&
+         b.nodes == std::vector<int>{2, 3} && c.nodes == std::vector<int>{0} &&
+         scheduler.Load(0) == 6.0 && scheduler.Load(3) == 1.0;
+}
+
+bool test_Release() {
+  cae::NodeScheduler scheduler(hosts(3));
+  auto a = scheduler.Allocate(3, 3.0);
+  auto b = scheduler.Allocate(1, 1.0);
+  scheduler.Release(a);
+  // Node 0 still runs b, so the next run goes to node 1
+  auto c = scheduler.Allocate(1, 1.0);
+  scheduler.Release(b);
+  scheduler.Release(c);
+  return c.nodes == std::vector<int>{1} && scheduler.Load(0) == 0.0 &&
+         scheduler.Load(1) == 0.0 && scheduler.Load(2) == 0.0;
+}
+
+bool test_Byte_weighting() {
+  // One large run outweighs several small ones
+  cae::NodeScheduler scheduler(hosts(2));
+  double big = cae::NodeScheduler::Weight(10ULL << 30);
+  double small = cae::NodeScheduler::Weight(1 << 20);
+  scheduler.Allocate(1, big);
+  for (int i = 0; i < 5; ++i) {
+    if (scheduler.Allocate(1, small).nodes != std::vector<int>{1}) {
+      return false;
+    }
+  }
+  // A runtime estimate replaces the byte estimate
+  return cae::NodeScheduler::Weight(10ULL << 30, 0.5) == 0.5 &&
+         small > cae::NodeScheduler::kRunSeconds;
+}
+
+bool test_Many_nodes() {
+  // Loads stay in heap order over many mixed allocations and releases
+  cae::NodeScheduler scheduler(hosts(37));
+  std::vector<cae::NodeScheduler::Allocation> held;
+  for (int i = 0; i < 200; ++i) {
+    auto allocation = scheduler.Allocate(1 + i % 5, 1.0 + (i * 7) % 11);
+    std::set<int> distinct(allocation.nodes.begin(), allocation.nodes.end());
+    if (distinct.size() != allocation.nodes.size()) {
+      return false;
+    }
+    // The chosen nodes were no busier than any other before this run
+    double chosen = 0.0;
+    for (int node : allocation.nodes) {
+      chosen = std::max(chosen, scheduler.Load(node) - allocation.load);
+    }
+    for (int node = 0; node < scheduler.Size(); ++node) {
+      if (!distinct.count(node) && scheduler.Load(node) < chosen - 1e-9) {
+        return false;
+      }
+    }
+    held.push_back(allocation);
+    if (i % 3 == 0) {
+      scheduler.Release(held[i / 2]);
+      held[i / 2].nodes.clear();
+    }
+  }
+  for (const auto& allocation : held) {
+    scheduler.Release(allocation);
+  }
+  for (int node = 0; node < scheduler.Size(); ++node) {
+    if (scheduler.Load(node) != 0.0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool test_Host_list() {
+  cae::NodeScheduler scheduler(hosts(4));
+  auto a = scheduler.Allocate(3, 1.0);
+  auto none = cae::NodeScheduler(std::vector<std::string>()).Allocate(2, 1.0);
+  return scheduler.HostList(a, 5) == "n0:2,n1:2,n2:1" &&
+         scheduler.HostList(a, 2) == "n0:1,n1:1" && none.nodes.empty();
+}
+
+bool test_Threads() {
+  cae::NodeScheduler scheduler(hosts(8));
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&scheduler] {
+      for (int i = 0; i < 1000; ++i) {
+        scheduler.Release(scheduler.Allocate(1 + i % 3, 1.0));
+      }
+    });
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+  for (int node = 0; node < scheduler.Size(); ++node) {
+    if (scheduler.Load(node) != 0.0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main() {
+  std::cout << "========================================" << std::endl;
+  std::cout << "  Node Scheduler Unit Tests" << std::endl;
+  std::cout << "========================================" << std::endl << std::endl;
+
+  TEST(Least_loaded);
+  TEST(Release);
+  TEST(Byte_weighting);
+  TEST(Many_nodes);
+  TEST(Host_list);
+  TEST(Threads);
+
+  // Summary
+  std::cout << std::endl << "========================================" << std::endl;
+  std::cout << "Test Summary:" << std::endl;
+  std::cout << "  Passed: " << tests_passed << std::endl;
+  std::cout << "  Failed: " << tests_failed << std::endl;
+  std::cout << "========================================" << std::endl;
+
+  if (tests_failed == 0) {
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+  } else {
+    std::cout << "Some tests failed." << std::endl;
+    return 1;
+  }
+}
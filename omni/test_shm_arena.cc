@@ -0,0 +1,236 @@
+///
+/// test_shm_arena.cc - Unit tests for the shared-memory slab arena
+///
+#include "shm_arena.h"
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Test result tracking
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name) \
+  std::cout << "Running test: " << #name << "..." << std::endl; \
+  if (test_##name()) { \
+    tests_passed++; \
+    std::cout << "  PASSED" << std::endl; \
+  } else { \
+    tests_failed++; \
+    std::cout << "  FAILED" << std::endl; \
+  }
+
+// Fresh arena with a per-process name so parallel runs do not collide
+std::unique_ptr<cae::ShmArena> open_arena(const std::string& tag,
+                                          size_t region_size = 4 << 20,
+                                          size_t capacity = 1024) {
+  cae::ShmArena::Options options;
+  options.name = "/omni_test_arena_" + tag + "_" + std::to_string(getpid());
+  options.region_size = region_size;
+  options.index_capacity = capacity;
+  cae::ShmArena::Destroy(options.name);
+  std::string error;
+  auto arena = cae::ShmArena::Open(options, error);
+  if (!arena) {
+    std::cout << "  open failed: " << error << std::endl;
+  }
+  return arena;
+}
+
+std::string arena_name(const std::string& tag) {
+  return "/omni_test_arena_" + tag + "_" + std::to_string(getpid());
+}
+
+bool find_equals(cae::ShmArena& arena, const std::string& key,
+                 const std::string& expected) {
+  const unsigned char* data = nullptr;
+  size_t nbyte = 0;
+  return arena.Find(key, data, nbyte) && nbyte == expected.size() &&
+         std::memcmp(data, expected.data(), nbyte) == 0;
+}
+
+bool test_Put_find() {
+  auto arena = open_arena("put");
+  if (!arena) {
+    return false;
+  }
+  const unsigned char* data = nullptr;
+  size_t nbyte = 0;
+  bool ok = !arena->Find("cae", data, nbyte) &&
+            arena->Put("cae", "hello", 5) == 0 &&
+            find_equals(*arena, "cae", "hello") &&
+            arena->GetStats().entries == 1;
+  arena.reset();
+  cae::ShmArena::Destroy(arena_name("put"));
+  return ok;
+}
+
+bool test_Replace_and_remove() {
+  auto arena = open_arena("replace");
+  if (!arena) {
+    return false;
+  }
+  std::string big(5000, 'x');
+  bool ok = arena->Put("k", "abc", 3) == 0 &&
+            arena->Put("k", "xyz", 3) == 0 && find_equals(*arena, "k", "xyz") &&
+            arena->Put("k", big.data(), big.size()) == 0 &&
+            find_equals(*arena, "k", big) && arena->GetStats().entries == 1 &&
+            arena->GetStats().bytes_used == cae::ShmArena::BlockSize(5000);
+  const unsigned char* data = nullptr;
+  size_t nbyte = 0;
+  ok = ok && arena->Remove("k") == 0 && !arena->Find("k", data, nbyte) &&
+       arena->Remove("k") != 0 && arena->GetStats().bytes_used == 0;
+  arena.reset();
+  cae::ShmArena::Destroy(arena_name("replace"));
+  return ok;
+}
+
+bool test_Free_list_reuse() {
+  auto arena = open_arena("reuse");
+  if (!arena) {
+    return false;
+  }
+  std::string value(100, 'a');
+  const unsigned char* first = nullptr;
+  const unsigned char* second = nullptr;
+  size_t nbyte = 0;
+  bool ok = arena->Put("a", value.data(), value.size()) == 0 &&
+            arena->Find("a", first, nbyte) && arena->Remove("a") == 0 &&
+            arena->Put("b", value.data(), value.size()) == 0 &&
+            arena->Find("b", second, nbyte) && first == second;
+  arena.reset();
+  cae::ShmArena::Destroy(arena_name("reuse"));
+  return ok;
+}
+
+bool test_Region_growth() {
+  auto arena = open_arena("grow", 2 << 20);
+  if (!arena) {
+    return false;
+  }
+  std::string mb(1 << 20, 'm');
+  std::string huge(3 << 20, 'h');
+  bool ok = true;
+  for (int i = 0; i < 3; ++i) {
+    ok = ok && arena->Put("m" + std::to_string(i), mb.data(), mb.size()) == 0;
+  }
+  ok = ok && arena->GetStats().regions == 2 &&
+       find_equals(*arena, "m2", mb) &&
+       arena->Put("huge", huge.data(), huge.size()) != 0;
+  arena.reset();
+  cae::ShmArena::Destroy(arena_name("grow"));
+  return ok;
+}
+
+bool test_Region_tail_reused() {
+  // 1.5 MiB leaves 0.5 MiB of the first region when 1 MiB needs a second
+  // one; that tail takes the next 0.5 MiB buffer
+  auto arena = open_arena("tail", 2 << 20);
+  if (!arena) {
+    return false;
+  }
+  std::string large(3 << 19, 'l');
+  std::string mb(1 << 20, 'm');
+  std::string half(500000, 'h');
+  const unsigned char* first = nullptr;
+  const unsigned char* tail = nullptr;
+  size_t nbyte = 0;
+  bool ok = arena->Put("l", large.data(), large.size()) == 0 &&
+            arena->Put("m", mb.data(), mb.size()) == 0 &&
+            arena->Put("h", half.data(), half.size()) == 0 &&
+            arena->Find("l", first, nbyte) && arena->Find("h", tail, nbyte) &&
+            tail == first + large.size() && arena->GetStats().regions == 2 &&
+            find_equals(*arena, "h", half);
+  arena.reset();
+  cae::ShmArena::Destroy(arena_name("tail"));
+  return ok;
+}
+
+bool test_Size_classes() {
+  // Four classes per power of two
+  return cae::ShmArena::BlockSize(1) == 64 &&
+         cae::ShmArena::BlockSize(65) == 80 &&
+         cae::ShmArena::BlockSize(100) == 112 &&
+         cae::ShmArena::BlockSize(113) == 128 &&
+         cae::ShmArena::BlockSize(5000) == 5120 &&
+         cae::ShmArena::BlockSize(3 << 19) == (3 << 19);
+}
+
+bool test_Index_full() {
+  auto arena = open_arena("full", 2 << 20, 8);
+  if (!arena) {
+    return false;
+  }
+  int stored = 0;
+  while (stored < 100 &&
+         arena->Put("k" + std::to_string(stored), "v", 1) == 0) {
+    ++stored;
+  }
+  std::string long_name(cae::ShmArena::kMaxName + 1, 'n');
+  bool ok = stored == 7 && arena->Put(long_name, "v", 1) != 0 &&
+            arena->Remove("k0") == 0 && arena->Put("again", "v", 1) == 0;
+  arena.reset();
+  cae::ShmArena::Destroy(arena_name("full"));
+  return ok;
+}
+
+bool test_Other_process() {
+  auto arena = open_arena("fork");
+  if (!arena) {
+    return false;
+  }
+  arena->Put("parent", "from parent", 11);
+  pid_t pid = fork();
+  if (pid == 0) {
+    // Attach by name only, like an unrelated consumer would
+    cae::ShmArena::Options options;
+    options.name = "/omni_test_arena_fork_" + std::to_string(getppid());
+    std::string error;
+    auto child = cae::ShmArena::Open(options, error);
+    bool ok = child && find_equals(*child, "parent", "from parent");
+    std::string big(3 << 20, 'c');  // forces a new region
+    ok = ok && child->Put("child", big.data(), big.size()) == 0;
+    _exit(ok ? 0 : 1);
+  }
+  int status = 0;
+  waitpid(pid, &status, 0);
+  bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0 &&
+            find_equals(*arena, "child", std::string(3 << 20, 'c'));
+  arena.reset();
+  cae::ShmArena::Destroy(arena_name("fork"));
+  return ok;
+}
+
+int main() {
+  std::cout << "========================================" << std::endl;
+  std::cout << "  Shared-Memory Arena Unit Tests" << std::endl;
+  std::cout << "========================================" << std::endl << std::endl;
+
+  TEST(Put_find);
+  TEST(Replace_and_remove);
+  TEST(Free_list_reuse);
+  TEST(Region_growth);
+  TEST(Region_tail_reused);
+  TEST(Size_classes);
+  TEST(Index_full);
+  TEST(Other_process);
+
+  // Summary
+  std::cout << std::endl << "========================================" << std::endl;
+  std::cout << "Test Summary:" << std::endl;
+  std::cout << "  Passed: " << tests_passed << std::endl;
+  std::cout << "  Failed: " << tests_failed << std::endl;
+  std::cout << "========================================" << std::endl;
+
+  if (tests_failed == 0) {
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+  } else {
+    std::cout << "Some tests failed." << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,149 @@
+///
+/// test_stats.cc - Unit tests for per-stage instrumentation
+///
+#include "stats.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Test result tracking
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name) \
+  std::cout << "Running test: " << #name << "..." << std::endl; \
+  if (test_##name()) { \
+    tests_passed++; \
+    std::cout << "  PASSED" << std::endl; \
+  } else { \
+    tests_failed++; \
+    std::cout << "  FAILED" << std::endl; \
+  }
+
+bool contains(const std::string& text, const std::string& part) {
+  return text.find(part) != std::string::npos;
+}
+
+bool test_Disabled_records_nothing() {
+  cae::StatsRegistry& stats = cae::StatsRegistry::Global();
+  {
+    cae::StatSpan span("read");
+    span.AddBytes(10);
+  }
+  return !stats.Enabled() && stats.Snapshot().empty();
+}
+
+bool test_Spans_accumulate() {
+  cae::StatsRegistry& stats = cae::StatsRegistry::Global();
+  stats.Enable();
+  stats.Reset();
+  // Concurrent spans, as pipeline stages record from their own threads
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([] {
+      cae::StatSpan span("put");
+      span.SetBackend("file");
+      span.AddBytes(100);
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    });
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+  { cae::StatSpan span("read"); }
+  auto totals = stats.Snapshot();
+  const cae::StageTotals& put = totals[{"put", "file"}];
+  const cae::StageTotals& read = totals[{"read", ""}];
+  return totals.size() == 2 && put.calls == 4 && put.bytes == 400 &&
+         put.seconds >= 0.008 && put.max_seconds >= 0.002 &&
+         put.max_seconds <= put.seconds && read.calls == 1 && read.bytes == 0;
+}
+
+bool test_Json() {
+  std::string json = cae::StatsRegistry::Global().ToJson();
+  return contains(json, "\"wall_seconds\": ") &&
+         contains(json, "{\"stage\": \"put\", \"backend\": \"file\", "
+                        "\"calls\": 4, ") &&
+         contains(json, "\"bytes\": 400}") &&
+         contains(json, "{\"stage\": \"read\", \"calls\": 1, ");
+}
+
+bool test_Prometheus() {
+  std::string prom = cae::StatsRegistry::Global().ToPrometheus();
+  return contains(prom, "# TYPE omni_stage_seconds_total counter\n") &&
+         contains(prom, "omni_stage_calls_total{stage=\"put\",backend=\"file\"} 4\n") &&
+         contains(prom, "omni_stage_bytes_total{stage=\"put\",backend=\"file\"} 400\n") &&
+         contains(prom, "omni_stage_calls_total{stage=\"read\"} 1\n");
+}
+
+bool test_ParseStatsSpec() {
+  std::string format;
+  std::string path;
+  return cae::ParseStatsSpec("json", format, path) && format == "json" &&
+         path == "wrp_stats.json" &&
+         cae::ParseStatsSpec("prom:/tmp/x.prom", format, path) &&
+         format == "prom" && path == "/tmp/x.prom" &&
+         !cae::ParseStatsSpec("xml", format, path) &&
+         !cae::ParseStatsSpec("json:", format, path);
+}
+
+bool test_Write_file() {
+  fs::path file = fs::temp_directory_path() / "omni_test_stats.prom";
+  fs::remove(file);
+  if (cae::StatsRegistry::Global().Write("prom", file.string()) != 0) {
+    return false;
+  }
+  std::ifstream in(file);
+  std::string text((std::istreambuf_iterator<char>(in)),
+                   std::istreambuf_iterator<char>());
+  bool ok = contains(text, "omni_wall_seconds ") &&
+            !fs::exists(file.string() + ".tmp");
+  fs::remove(file);
+  return ok;
+}
+
+bool test_Rank_labels() {
+  // Runs last: the labels stay on the global registry
+  cae::StatsRegistry::Global().SetRank(3, "node7");
+  std::string prom = cae::StatsRegistry::Global().ToPrometheus();
+  return contains(prom, "omni_wall_seconds{rank=\"3\",host=\"node7\"} ") &&
+         contains(prom, "omni_stage_calls_total{stage=\"put\",backend=\"file\","
+                        "rank=\"3\",host=\"node7\"} 4\n") &&
+         contains(prom, "omni_stage_calls_total{stage=\"read\",rank=\"3\","
+                        "host=\"node7\"} 1\n");
+}
+
+int main() {
+  std::cout << "========================================" << std::endl;
+  std::cout << "  Stats Unit Tests" << std::endl;
+  std::cout << "========================================" << std::endl << std::endl;
+
+  TEST(Disabled_records_nothing);
+  TEST(Spans_accumulate);
+  TEST(Json);
+  TEST(Prometheus);
+  TEST(ParseStatsSpec);
+  TEST(Write_file);
+  TEST(Rank_labels);
+
+  // Summary
+  std::cout << std::endl << "========================================" << std::endl;
+  std::cout << "Test Summary:" << std::endl;
+  std::cout << "  Passed: " << tests_passed << std::endl;
+  std::cout << "  Failed: " << tests_failed << std::endl;
+  std::cout << "========================================" << std::endl;
+
+  if (tests_failed == 0) {
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+  } else {
+    std::cout << "Some tests failed." << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,173 @@
+///
+/// test_walk.cc - Unit tests for the parallel directory walker
+///
+#include "walk.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Test result tracking
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name) \
+  std::cout << "Running test: " << #name << "..." << std::endl; \
+  if (test_##name()) { \
+    tests_passed++; \
+    std::cout << "  PASSED" << std::endl; \
+  } else { \
+    tests_failed++; \
+    std::cout << "  FAILED" << std::endl; \
+  }
+
+// A small tree:
+//   root/a.csv root/b.h5 root/.hidden.csv
+//   root/x/c.csv root/x/y/d.csv root/x/y/e.txt root/.git/f.csv
+//   root/x/y/loop -> root
+fs::path make_tree() {
+  fs::path root = fs::temp_directory_path() / "omni_test_walk";
+  fs::remove_all(root);
+  fs::create_directories(root / "x" / "y");
+  fs::create_directories(root / ".git");
+  for (const char *file : {"a.csv", "b.h5", ".hidden.csv", "x/c.csv",
+                           "x/y/d.csv", "x/y/e.txt", ".git/f.csv"}) {
+    std::ofstream(root / file) << "data\n";
+  }
+#ifndef _WIN32
+  // Windows needs extra privileges for symlinks
+  fs::create_directory_symlink(root, root / "x" / "y" / "loop");
+#endif
+  return root;
+}
+
+// Matches relative to root, sorted
+std::vector<std::string> relative(const fs::path &root,
+                                  const std::vector<std::string> &files) {
+  std::vector<std::string> names;
+  for (const std::string &file : files) {
+    names.push_back(fs::path(file).lexically_relative(root).generic_string());
+  }
+  std::sort(names.begin(), names.end());
+  return names;
+}
+
+bool test_MatchGlob() {
+  return cae::MatchGlob("*.csv", "a.csv") && !cae::MatchGlob("*.csv", "a.h5") &&
+         cae::MatchGlob("?.csv", "a.csv") && !cae::MatchGlob("?.csv", "ab.csv") &&
+         cae::MatchGlob("[a-c]*", "b.h5") && !cae::MatchGlob("[a-c]*", "d.h5") &&
+         cae::MatchGlob("[!a]*", "b.h5") && !cae::MatchGlob("[!a]*", "a.h5") &&
+         cae::MatchGlob("a*b*c", "aXbYbZc") && !cae::MatchGlob("a*b*c", "aXbY") &&
+         !cae::MatchGlob("*", ".hidden") && cae::MatchGlob(".*", ".hidden");
+}
+
+bool test_ExpandBraces() {
+  std::vector<std::string> one = cae::ExpandBraces("d/*.{csv,h5}");
+  std::vector<std::string> nested = cae::ExpandBraces("{a,b{1,2}}.x");
+  return one == std::vector<std::string>{"d/*.csv", "d/*.h5"} &&
+         nested == std::vector<std::string>{"a.x", "b1.x", "b2.x"} &&
+         cae::ExpandBraces("{x}.csv") == std::vector<std::string>{"{x}.csv"};
+}
+
+bool test_MatchPath() {
+  std::vector<std::string> segments;
+  std::string root = cae::SplitPattern("/data/run*/x/*.csv", segments);
+  bool ok = root == "/data" &&
+            segments == std::vector<std::string>{"run*", "x", "*.csv"} &&
+            cae::MatchPath("/d/**/*.csv", "/d/a.csv") &&
+            cae::MatchPath("/d/**/*.csv", "/d/x/y/a.csv") &&
+            !cae::MatchPath("/d/**/*.csv", "/d/.git/a.csv") &&
+            !cae::MatchPath("/d/*.csv", "/d/x/a.csv") &&
+            cae::MatchPath("d/**", "d/x/a.h5") &&
+            !cae::MatchPath("d/**", "d") &&
+            !cae::MatchPath("/d/*.csv", "d/a.csv");
+#ifdef _WIN32
+  // Backslashes separate segments too
+  ok = ok && cae::SplitPattern("C:\\data\\*.csv", segments) == "C:/data" &&
+       segments == std::vector<std::string>{"*.csv"} &&
+       cae::MatchPath("C:\\d\\*.csv", "C:/d/a.csv");
+#endif
+  return ok;
+}
+
+bool test_Single_level() {
+  fs::path root = make_tree();
+  std::vector<std::string> csv =
+      relative(root, cae::WalkPattern((root / "*.csv").generic_string()));
+  std::vector<std::string> both =
+      relative(root, cae::WalkPattern((root / "*.{csv,h5}").generic_string()));
+  std::vector<std::string> nested =
+      relative(root, cae::WalkPattern((root / "x/*/d.csv").generic_string()));
+  fs::remove_all(root);
+  return csv == std::vector<std::string>{"a.csv"} &&
+         both == std::vector<std::string>{"a.csv", "b.h5"} &&
+         nested == std::vector<std::string>{"x/y/d.csv"};
+}
+
+bool test_Recursive() {
+  fs::path root = make_tree();
+  // "**" spans zero or more directories, skips hidden ones and does not
+  // follow the loop back to root
+  std::vector<std::string> csv =
+      relative(root, cae::WalkPattern((root / "**/*.csv").generic_string()));
+  std::vector<std::string> all =
+      relative(root, cae::WalkPattern((root / "x/**").generic_string()));
+  fs::remove_all(root);
+  return csv == std::vector<std::string>{"a.csv", "x/c.csv", "x/y/d.csv"} &&
+         all == std::vector<std::string>{"x/c.csv", "x/y/d.csv", "x/y/e.txt"};
+}
+
+bool test_Streaming_threads() {
+  // A wide tree walked by one thread and by several finds the same files,
+  // each reported once
+  fs::path root = fs::temp_directory_path() / "omni_test_walk_wide";
+  fs::remove_all(root);
+  for (int d = 0; d < 20; ++d) {
+    fs::path dir = root / ("d" + std::to_string(d)) / "sub";
+    fs::create_directories(dir);
+    for (int f = 0; f < 10; ++f) {
+      std::ofstream(dir / ("f" + std::to_string(f) + ".bin")) << "x";
+    }
+  }
+  std::string pattern = (root / "**/*.bin").generic_string();
+  std::atomic<size_t> calls{0};
+  size_t matched = cae::DirectoryWalker(4).Walk(
+      pattern, [&](const std::string &) { ++calls; });
+  std::vector<std::string> one = cae::WalkPattern(pattern, 1);
+  std::vector<std::string> many = cae::WalkPattern(pattern, 4);
+  fs::remove_all(root);
+  return matched == 200 && calls == 200 && one.size() == 200 && one == many;
+}
+
+int main() {
+  std::cout << "========================================" << std::endl;
+  std::cout << "  Directory Walker Unit Tests" << std::endl;
+  std::cout << "========================================" << std::endl << std::endl;
+
+  TEST(MatchGlob);
+  TEST(ExpandBraces);
+  TEST(MatchPath);
+  TEST(Single_level);
+  TEST(Recursive);
+  TEST(Streaming_threads);
+
+  // Summary
+  std::cout << std::endl << "========================================" << std::endl;
+  std::cout << "Test Summary:" << std::endl;
+  std::cout << "  Passed: " << tests_passed << std::endl;
+  std::cout << "  Failed: " << tests_failed << std::endl;
+  std::cout << "========================================" << std::endl;
+
+  if (tests_failed == 0) {
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+  } else {
+    std::cout << "Some tests failed." << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,148 @@
+///
+/// test_watch.cc - Unit tests for batches of files landing in watched
+/// directories
+///
+#include "watch.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Test result tracking
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name) \
+  std::cout << "Running test: " << #name << "..." << std::endl; \
+  if (test_##name()) { \
+    tests_passed++; \
+    std::cout << "  PASSED" << std::endl; \
+  } else { \
+    tests_failed++; \
+    std::cout << "  FAILED" << std::endl; \
+  }
+
+fs::path make_dir() {
+  fs::path dir = fs::temp_directory_path() / "omni_test_watch";
+  fs::remove_all(dir);
+  fs::create_directories(dir / "old");
+  return dir;
+}
+
+void write(const fs::path &file) { std::ofstream(file) << "data\n"; }
+
+// Names of the files of the batches that arrive until stop is set
+std::vector<std::string> collect(cae::DirectoryWatcher &watcher,
+                                 const fs::path &root,
+                                 std::atomic<bool> &stop,
+                                 size_t *batches = nullptr) {
+  std::vector<std::string> names;
+  std::vector<cae::WatchMatch> batch;
+  while (watcher.Next(batch, stop)) {
+    for (const cae::WatchMatch &match : batch) {
+      names.push_back(fs::path(match.path).lexically_relative(root).string() +
+                      "#" + std::to_string(match.id));
+    }
+    if (batches != nullptr) {
+      ++*batches;
+    }
+  }
+  std::sort(names.begin(), names.end());
+  return names;
+}
+
+bool test_Landing_files() {
+  fs::path root = make_dir();
+  write(root / "old" / "before.csv");  // there before the watch
+  cae::DirectoryWatcher watcher;
+  std::string error;
+  if (watcher.Add((root / "**" / "*.csv").string(), 7, error) != 0) {
+    std::cerr << error << std::endl;
+    return false;
+  }
+  std::atomic<bool> stop{false};
+  std::thread writer([&]() {
+    write(root / "a.csv");
+    write(root / "b.txt");     // does not match
+    write(root / ".c.csv");    // hidden
+    fs::create_directories(root / "new" / "deeper");
+    write(root / "new" / "deeper" / "d.csv");  // below a new directory
+    write(root / ".e.tmp");
+    fs::rename(root / ".e.tmp", root / "old" / "e.csv");  // moved in
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    stop = true;
+  });
+  std::vector<std::string> names = collect(watcher, root, stop);
+  writer.join();
+  fs::remove_all(root);
+  return names == std::vector<std::string>{"a.csv#7", "new/deeper/d.csv#7",
+                                           "old/e.csv#7"};
+}
+
+bool test_Bursts_batch() {
+  fs::path root = make_dir();
+  // Two files per batch at most, so five matches take three batches; a
+  // pattern added twice under two ids reports each file twice
+  cae::DirectoryWatcher watcher(2);
+  std::string error;
+  if (watcher.Add((root / "*.{csv,h5}").string(), 0, error) != 0 ||
+      watcher.Add((root / "*.h5").string(), 1, error) != 0) {
+    return false;
+  }
+  std::atomic<bool> stop{false};
+  std::thread writer([&]() {
+    for (const char *name : {"1.csv", "2.csv", "3.csv", "4.h5"}) {
+      write(root / name);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    stop = true;
+  });
+  size_t batches = 0;
+  std::vector<std::string> names = collect(watcher, root, stop, &batches);
+  writer.join();
+  fs::remove_all(root);
+  return batches >= 3 &&
+         names == std::vector<std::string>{"1.csv#0", "2.csv#0", "3.csv#0",
+                                           "4.h5#0", "4.h5#1"};
+}
+
+bool test_Missing_root() {
+  cae::DirectoryWatcher watcher;
+  std::string error;
+  std::atomic<bool> stop{true};
+  std::vector<cae::WatchMatch> batch;
+  return watcher.Add("/nonexistent/omni/*.csv", 0, error) != 0 &&
+         !error.empty() && !watcher.Next(batch, stop) && batch.empty();
+}
+
+int main() {
+  std::cout << "========================================" << std::endl;
+  std::cout << "  Directory Watcher Unit Tests" << std::endl;
+  std::cout << "========================================" << std::endl << std::endl;
+
+  TEST(Landing_files);
+  TEST(Bursts_batch);
+  TEST(Missing_root);
+
+  // Summary
+  std::cout << std::endl << "========================================" << std::endl;
+  std::cout << "Test Summary:" << std::endl;
+  std::cout << "  Passed: " << tests_passed << std::endl;
+  std::cout << "  Failed: " << tests_failed << std::endl;
+  std::cout << "========================================" << std::endl;
+
+  if (tests_failed == 0) {
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+  } else {
+    std::cout << "Some tests failed." << std::endl;
+    return 1;
+  }
+}
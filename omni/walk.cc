@@ -0,0 +1,467 @@
+///
+/// walk.cc
+///
+#include "walk.h"
+
+#include <sys/stat.h>
+#ifdef __linux__
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+namespace cae {
+
+namespace {
+
+enum class EntryType { kFile, kDirectory, kOther };
+
+// One directory to read, and the pattern segment its entries must match
+struct WalkTask {
+  std::string dir;
+  size_t segment;
+};
+
+// Path separators; Windows also takes '\\'
+#ifdef _WIN32
+constexpr const char* kSeparators = "/\\";
+#else
+constexpr const char* kSeparators = "/";
+#endif
+
+bool IsSeparator(char c) {
+#ifdef _WIN32
+  return c == '/' || c == '\\';
+#else
+  return c == '/';
+#endif
+}
+
+std::string Join(const std::string& dir, const std::string& name) {
+  if (dir.empty()) {
+    return name;
+  }
+  return IsSeparator(dir.back()) ? dir + name : dir + "/" + name;
+}
+
+EntryType TypeOf(const std::string& path) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) {
+    return EntryType::kOther;
+  }
+  return S_ISREG(st.st_mode)   ? EntryType::kFile
+         : S_ISDIR(st.st_mode) ? EntryType::kDirectory
+                               : EntryType::kOther;
+}
+
+bool SameChar(char a, char b) {
+#ifdef _WIN32
+  return std::tolower(static_cast<unsigned char>(a)) ==
+         std::tolower(static_cast<unsigned char>(b));
+#else
+  return a == b;
+#endif
+}
+
+// Match c against the set starting after '[' at glob[i]; i moves past ']'
+bool MatchSet(const std::string& glob, size_t& i, char c) {
+  bool negate = i < glob.size() && (glob[i] == '!' || glob[i] == '^');
+  if (negate) {
+    ++i;
+  }
+  bool found = false;
+  size_t start = i;
+  while (i < glob.size() && (glob[i] != ']' || i == start)) {
+    char lo = glob[i];
+    char hi = lo;
+    if (i + 2 < glob.size() && glob[i + 1] == '-' && glob[i + 2] != ']') {
+      hi = glob[i + 2];
+      i += 2;
+    }
+    if ((lo <= c && c <= hi) || SameChar(lo, c)) {
+      found = true;
+    }
+    ++i;
+  }
+  ++i;  // past ']'
+  return found != negate;
+}
+
+// Non-empty segments of a path or pattern
+std::vector<std::string> Split(const std::string& path) {
+  std::vector<std::string> segments;
+  size_t start = 0;
+  while (start <= path.size()) {
+    size_t slash = path.find_first_of(kSeparators, start);
+    if (slash == std::string::npos) {
+      slash = path.size();
+    }
+    if (slash > start) {
+      segments.push_back(path.substr(start, slash - start));
+    }
+    start = slash + 1;
+  }
+  return segments;
+}
+
+// Call on_entry(name, type) for every entry of dir but "." and "..";
+// symlinks are typed by their target if follow_links, else kOther
+template <typename F>
+void ListDirectory(const std::string& dir, bool follow_links, F on_entry) {
+  const std::string open_path = dir.empty() ? "." : dir;
+#ifdef __linux__
+  // getdents64 hands back a whole batch of entries with their d_type, so
+  // a directory of a million files costs a few hundred system calls
+  struct Dirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+  };
+  int fd = open(open_path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) {
+    return;
+  }
+  std::vector<uint64_t> buffer(DirectoryWalker::kBatchBytes /
+                               sizeof(uint64_t));
+  char* base = reinterpret_cast<char*>(buffer.data());
+  for (;;) {
+    long n = syscall(SYS_getdents64, fd, base,
+                     buffer.size() * sizeof(uint64_t));
+    if (n <= 0) {
+      break;
+    }
+    for (long pos = 0; pos < n;) {
+      const Dirent64* d = reinterpret_cast<const Dirent64*>(base + pos);
+      pos += d->d_reclen;
+      const char* name = d->d_name;
+      if (name[0] == '.' &&
+          (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+        continue;
+      }
+      EntryType type = EntryType::kOther;
+      bool link = d->d_type == DT_LNK;
+      if (d->d_type == DT_REG) {
+        type = EntryType::kFile;
+      } else if (d->d_type == DT_DIR) {
+        type = EntryType::kDirectory;
+      } else if (d->d_type == DT_UNKNOWN || (link && follow_links)) {
+        struct stat st;
+        if (fstatat(fd, name, &st, link ? 0 : AT_SYMLINK_NOFOLLOW) == 0) {
+          type = S_ISREG(st.st_mode)   ? EntryType::kFile
+                 : S_ISDIR(st.st_mode) ? EntryType::kDirectory
+                                       : EntryType::kOther;
+        }
+      }
+      on_entry(std::string(name), type);
+    }
+  }
+  close(fd);
+#else
+  std::error_code ec;
+  for (std::filesystem::directory_iterator it(open_path, ec), end;
+       !ec && it != end; it.increment(ec)) {
+    bool link = it->is_symlink(ec);
+    EntryType type = EntryType::kOther;
+    if (!link || follow_links) {
+      type = it->is_regular_file(ec)  ? EntryType::kFile
+             : it->is_directory(ec) ? EntryType::kDirectory
+                                      : EntryType::kOther;
+    }
+    on_entry(it->path().filename().string(), type);
+  }
+#endif
+}
+
+}  // namespace
+
+bool HasWildcards(const std::string& pattern) {
+  return pattern.find_first_of("*?[{") != std::string::npos;
+}
+
+std::vector<std::string> ExpandBraces(const std::string& pattern) {
+  // The first complete {...} group, with its top-level commas
+  size_t open = std::string::npos;
+  int depth = 0;
+  std::vector<size_t> commas;
+  for (size_t i = 0; i < pattern.size(); ++i) {
+    char c = pattern[i];
+    if (c == '{') {
+      if (depth++ == 0) {
+        open = i;
+        commas.clear();
+      }
+    } else if (c == ',' && depth == 1) {
+      commas.push_back(i);
+    } else if (c == '}' && depth > 0 && --depth == 0) {
+      if (commas.empty()) {
+        continue;  // "{x}" is literal, as in glob(3)
+      }
+      std::vector<std::string> expanded;
+      std::string head = pattern.substr(0, open);
+      std::string tail = pattern.substr(i + 1);
+      size_t start = open + 1;
+      commas.push_back(i);
+      for (size_t comma : commas) {
+        std::string choice = pattern.substr(start, comma - start);
+        for (const std::string& each : ExpandBraces(head + choice + tail)) {
+          expanded.push_back(each);
+        }
+        start = comma + 1;
+      }
+      return expanded;
+    }
+  }
+  return {pattern};
+}
+
+bool MatchGlob(const std::string& glob, const std::string& name) {
+  if (!name.empty() && name[0] == '.' && (glob.empty() || glob[0] != '.')) {
+    return false;
+  }
+  // Iterative match; on a mismatch, back up to the last '*' and let it
+  // take one more character
+  size_t g = 0;
+  size_t n = 0;
+  size_t star = std::string::npos;
+  size_t resume = 0;
+  while (n < name.size()) {
+    if (g < glob.size() && glob[g] == '*') {
+      star = g++;
+      resume = n;
+      continue;
+    }
+    if (g < glob.size()) {
+      size_t next = g + 1;
+      bool ok = false;
+      if (glob[g] == '?') {
+        ok = true;
+      } else if (glob[g] == '[' &&
+                 glob.find(']', g + 2) != std::string::npos) {
+        ok = MatchSet(glob, next, name[n]);
+      } else {
+        ok = SameChar(glob[g], name[n]);
+      }
+      if (ok) {
+        g = next;
+        ++n;
+        continue;
+      }
+    }
+    if (star == std::string::npos) {
+      return false;
+    }
+    g = star + 1;
+    n = ++resume;
+  }
+  while (g < glob.size() && glob[g] == '*') {
+    ++g;
+  }
+  return g == glob.size();
+}
+
+namespace {
+
+// Match names[j...] against globs[i...]; "**" takes zero or more
+// directories that are not hidden, and a trailing "**" any file below
+bool MatchSegments(const std::vector<std::string>& globs, size_t i,
+                   const std::vector<std::string>& names, size_t j) {
+  if (i == globs.size()) {
+    return j == names.size();
+  }
+  if (globs[i] != "**") {
+    return j < names.size() && MatchGlob(globs[i], names[j]) &&
+           MatchSegments(globs, i + 1, names, j + 1);
+  }
+  if (i + 1 == globs.size()) {
+    if (j == names.size()) {
+      return false;
+    }
+    for (; j < names.size(); ++j) {
+      if (names[j][0] == '.') {
+        return false;
+      }
+    }
+    return true;
+  }
+  if (MatchSegments(globs, i + 1, names, j)) {
+    return true;
+  }
+  return j + 1 < names.size() && names[j][0] != '.' &&
+         MatchSegments(globs, i, names, j + 1);
+}
+
+}  // namespace
+
+std::string SplitPattern(const std::string& pattern,
+                         std::vector<std::string>& segments) {
+  std::vector<std::string> all = Split(pattern);
+  std::string root = !pattern.empty() && IsSeparator(pattern[0]) ? "/" : "";
+  size_t first = 0;
+  while (first + 1 < all.size() && !HasWildcards(all[first])) {
+    root = Join(root, all[first++]);
+  }
+  segments.assign(all.begin() + first, all.end());
+  return root;
+}
+
+bool MatchPath(const std::string& pattern, const std::string& path) {
+  bool absolute = !pattern.empty() && IsSeparator(pattern[0]);
+  if (absolute != (!path.empty() && IsSeparator(path[0]))) {
+    return false;
+  }
+  return MatchSegments(Split(pattern), 0, Split(path), 0);
+}
+
+DirectoryWalker::DirectoryWalker(int nthreads) : nthreads_(nthreads) {
+  if (nthreads_ <= 0) {
+    nthreads_ = static_cast<int>(
+        std::min(8u, std::max(1u, std::thread::hardware_concurrency())));
+  }
+}
+
+size_t DirectoryWalker::Walk(const std::string& pattern,
+                             const Callback& on_match) {
+  std::vector<std::string> segments;
+  std::string root = SplitPattern(pattern, segments);
+  if (segments.empty()) {
+    return 0;
+  }
+
+  std::atomic<size_t> matches{0};
+  auto match = [&](const std::string& path) {
+    ++matches;
+    on_match(path);
+  };
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<WalkTask> tasks;
+  size_t pending = 1;  // queued or being read
+  tasks.push_back({root, 0});
+  auto push = [&](std::vector<WalkTask>& found) {
+    if (found.empty()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      pending += found.size();
+      for (WalkTask& task : found) {
+        tasks.push_back(std::move(task));
+      }
+    }
+    cv.notify_all();
+    found.clear();
+  };
+
+  auto process = [&](const WalkTask& task, std::vector<WalkTask>& found) {
+    const std::string& segment = segments[task.segment];
+    bool last = task.segment + 1 == segments.size();
+    if (segment == "**") {
+      // Zero directories here, or one more level below; a trailing "**"
+      // matches every file of the tree
+      if (!last) {
+        found.push_back({task.dir, task.segment + 1});
+      }
+      ListDirectory(task.dir, false, [&](const std::string& name,
+                                         EntryType type) {
+        if (name[0] == '.') {
+          return;
+        }
+        if (type == EntryType::kDirectory) {
+          found.push_back({Join(task.dir, name), task.segment});
+        } else if (last && type == EntryType::kFile) {
+          match(Join(task.dir, name));
+        }
+      });
+      return;
+    }
+    if (!HasWildcards(segment)) {
+      // A literal name needs no listing of a possibly huge directory
+      std::string path = Join(task.dir, segment);
+      EntryType type = TypeOf(path);
+      if (last && type == EntryType::kFile) {
+        match(path);
+      } else if (!last && type == EntryType::kDirectory) {
+        found.push_back({path, task.segment + 1});
+      }
+      return;
+    }
+    ListDirectory(task.dir, true, [&](const std::string& name,
+                                      EntryType type) {
+      if (!MatchGlob(segment, name)) {
+        return;
+      }
+      if (last && type == EntryType::kFile) {
+        match(Join(task.dir, name));
+      } else if (!last && type == EntryType::kDirectory) {
+        found.push_back({Join(task.dir, name), task.segment + 1});
+      }
+    });
+  };
+
+  auto worker = [&]() {
+    std::vector<WalkTask> found;
+    for (;;) {
+      WalkTask task;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return !tasks.empty() || pending == 0; });
+        if (tasks.empty()) {
+          return;
+        }
+        task = std::move(tasks.front());
+        tasks.pop_front();
+      }
+      process(task, found);
+      push(found);
+      bool done;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = --pending == 0;
+      }
+      if (done) {
+        cv.notify_all();
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 1; i < nthreads_; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (std::thread& t : threads) {
+    t.join();
+  }
+  return matches;
+}
+
+std::vector<std::string> WalkPattern(const std::string& pattern,
+                                     int nthreads) {
+  std::vector<std::string> files;
+  std::mutex mutex;
+  DirectoryWalker walker(nthreads);
+  for (const std::string& each : ExpandBraces(pattern)) {
+    walker.Walk(each, [&](const std::string& path) {
+      std::lock_guard<std::mutex> lock(mutex);
+      files.push_back(path);
+    });
+  }
+  std::sort(files.begin(), files.end());
+  files.erase(std::unique(files.begin(), files.end()), files.end());
+  return files;
+}
+
+}  // namespace cae
@@ -0,0 +1,82 @@
+///
+/// walk.h
+///
+/// Parallel directory walking for file patterns. A pattern is split at '/'
+/// (and '\' on Windows) into segments; each segment is a glob (* ? [set])
+/// matched against one name, and a "**" segment matches any number of
+/// directories. Directories are read in large getdents64 batches and
+/// classified by d_type, so no file is stat'ed unless its filesystem
+/// reports no type or it is a symlink. Several threads share a queue of
+/// directories and hand each match to a callback as soon as it is found,
+/// so callers can start on the first files while a large tree is still
+/// being listed.
+///
+#ifndef CAE_WALK_H_
+#define CAE_WALK_H_
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace cae {
+
+/** Whether a pattern has glob characters (* ? [ or {) */
+bool HasWildcards(const std::string& pattern);
+
+/** Expand {a,b} alternatives: "x.{csv,h5}" is "x.csv" and "x.h5" */
+std::vector<std::string> ExpandBraces(const std::string& pattern);
+
+/**
+ * Match one name against one glob segment. As with the shell, a leading
+ * '.' in the name must be matched by a literal '.'.
+ */
+bool MatchGlob(const std::string& glob, const std::string& name);
+
+/**
+ * Split a pattern (without braces) at '/': the literal directories in
+ * front are its root, returned, and the segments from the first glob on
+ * go to segments. "/data/run?/x/a?.csv" has root "/data" and segments
+ * "run?", "x", "a?.csv".
+ */
+std::string SplitPattern(const std::string& pattern,
+                         std::vector<std::string>& segments);
+
+/**
+ * Whether a path matches a whole pattern (without braces), as the walk
+ * would find it: "**" spans directories that are not hidden
+ */
+bool MatchPath(const std::string& pattern, const std::string& path);
+
+/**
+ * Multi-threaded walk of the regular files matching a pattern
+ */
+class DirectoryWalker {
+ public:
+  /** Bytes of directory entries read per getdents64 call */
+  static constexpr size_t kBatchBytes = 256 * 1024;
+
+  /** Called from walker threads, possibly concurrently, once per match */
+  using Callback = std::function<void(const std::string& path)>;
+
+  /** @param nthreads Walker threads; 0 picks from the hardware (up to 8) */
+  explicit DirectoryWalker(int nthreads = 0);
+
+  /**
+   * Walk every regular file that matches a pattern (without braces);
+   * symlinks are followed, except by "**", so a tree cannot loop
+   * @return the number of matches
+   */
+  size_t Walk(const std::string& pattern, const Callback& on_match);
+
+ private:
+  int nthreads_;
+};
+
+/** All regular files matching a pattern, with braces, sorted */
+std::vector<std::string> WalkPattern(const std::string& pattern,
+                                     int nthreads = 0);
+
+}  // namespace cae
+
+#endif  // CAE_WALK_H_
@@ -0,0 +1,237 @@
+///
+/// watch.cc
+///
+#include "watch.h"
+#include "walk.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+
+namespace cae {
+
+namespace {
+
+// As the walker joins them, so paths compare equal to its matches
+std::string Join(const std::string& dir, const std::string& name) {
+  if (dir.empty()) {
+    return name;
+  }
+  return dir.back() == '/' ? dir + name : dir + "/" + name;
+}
+
+}  // namespace
+
+DirectoryWatcher::DirectoryWatcher(size_t max_batch)
+    : max_batch_(std::max<size_t>(1, max_batch)) {
+#ifdef __linux__
+  fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+}
+
+DirectoryWatcher::~DirectoryWatcher() {
+#ifdef __linux__
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+#endif
+}
+
+int DirectoryWatcher::Add(const std::string& pattern, size_t id,
+                          std::string& error) {
+#ifdef __linux__
+  if (fd_ < 0) {
+    error = std::string("inotify: ") + std::strerror(errno);
+    return 1;
+  }
+  for (const std::string& glob : ExpandBraces(pattern)) {
+    std::vector<std::string> segments;
+    std::string root = SplitPattern(glob, segments);
+    std::error_code ec;
+    if (!std::filesystem::is_directory(root.empty() ? "." : root, ec)) {
+      error = "cannot watch '" + root + "': not a directory";
+      return 1;
+    }
+    // Levels of directories below the root that can hold matches
+    int depth = static_cast<int>(segments.size()) - 1;
+    if (std::find(segments.begin(), segments.end(), "**") != segments.end()) {
+      depth = -1;
+    }
+    patterns_.push_back({glob, id});
+    WatchTree(root, depth, false);
+  }
+  return 0;
+#else
+  (void)pattern;
+  (void)id;
+  error = "watching directories needs inotify (Linux)";
+  return 1;
+#endif
+}
+
+void DirectoryWatcher::WatchTree(const std::string& dir, int depth,
+                                 bool scan) {
+#ifdef __linux__
+  auto known = depth_.find(dir);
+  if (known != depth_.end() &&
+      (known->second < 0 || (depth >= 0 && known->second >= depth))) {
+    return;  // already watched as deep
+  }
+  const std::string open_path = dir.empty() ? "." : dir;
+  int wd = inotify_add_watch(fd_, open_path.c_str(),
+                             IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE |
+                                 IN_ONLYDIR);
+  if (wd < 0) {
+    return;
+  }
+  dirs_[wd] = dir;
+  depth_[dir] = depth;
+
+  // Entries that were there before the watch, or landed while it was
+  // being added
+  std::error_code ec;
+  for (std::filesystem::directory_iterator it(open_path, ec), end;
+       !ec && it != end; it.increment(ec)) {
+    std::string name = it->path().filename().string();
+    if (name[0] == '.' || it->is_symlink(ec)) {
+      continue;
+    }
+    if (depth != 0 && it->is_directory(ec)) {
+      WatchTree(Join(dir, name), depth < 0 ? -1 : depth - 1, scan);
+    } else if (scan && it->is_regular_file(ec)) {
+      Match(Join(dir, name));
+    }
+  }
+#else
+  (void)dir;
+  (void)depth;
+  (void)scan;
+#endif
+}
+
+void DirectoryWatcher::Match(const std::string& path) {
+  for (const Pattern& pattern : patterns_) {
+    if (MatchPath(pattern.glob, path) &&
+        seen_.insert(path + '\0' + std::to_string(pattern.id)).second) {
+      pending_.push_back({path, pattern.id});
+    }
+  }
+}
+
+bool DirectoryWatcher::ReadEvents() {
+#ifdef __linux__
+  alignas(struct inotify_event) char buffer[64 * 1024];
+  for (;;) {
+    ssize_t n = read(fd_, buffer, sizeof(buffer));
+    if (n < 0) {
+      return errno == EAGAIN || errno == EINTR;
+    }
+    for (ssize_t pos = 0; pos < n;) {
+      const struct inotify_event* event =
+          reinterpret_cast<const struct inotify_event*>(buffer + pos);
+      pos += sizeof(struct inotify_event) + event->len;
+      if (event->mask & IN_Q_OVERFLOW) {
+        // Events were dropped: walk every pattern again; files already
+        // ingested are skipped by the job's manifest
+        DirectoryWalker walker;
+        for (const Pattern& pattern : patterns_) {
+          std::vector<std::string> files;
+          walker.Walk(pattern.glob, [&](const std::string& path) {
+            files.push_back(path);
+          });
+          for (const std::string& path : files) {
+            Match(path);
+          }
+        }
+        continue;
+      }
+      auto dir = dirs_.find(event->wd);
+      if (dir == dirs_.end()) {
+        continue;
+      }
+      if (event->mask & IN_IGNORED) {
+        depth_.erase(dir->second);
+        dirs_.erase(dir);
+        continue;
+      }
+      if (event->len == 0 || event->name[0] == '.') {
+        continue;
+      }
+      std::string path = Join(dir->second, event->name);
+      if (event->mask & IN_ISDIR) {
+        int depth = depth_[dir->second];
+        if (depth != 0 && (event->mask & (IN_CREATE | IN_MOVED_TO))) {
+          WatchTree(path, depth < 0 ? -1 : depth - 1, true);
+        }
+      } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+        Match(path);
+      }
+    }
+  }
+#else
+  return false;
+#endif
+}
+
+bool DirectoryWatcher::Next(std::vector<WatchMatch>& batch,
+                            const std::atomic<bool>& stop) {
+  using Clock = std::chrono::steady_clock;
+  batch.clear();
+#ifdef __linux__
+  if (fd_ < 0) {
+    return false;
+  }
+  // Files left over from a full batch are due at once
+  Clock::time_point first = Clock::now() -
+                            std::chrono::milliseconds(kMaxDelayMillis);
+  Clock::time_point last = first;
+  for (;;) {
+    Clock::time_point now = Clock::now();
+    if (!pending_.empty() &&
+        (stop || pending_.size() >= max_batch_ ||
+         now - last >= std::chrono::milliseconds(kQuietMillis) ||
+         now - first >= std::chrono::milliseconds(kMaxDelayMillis))) {
+      size_t n = std::min(pending_.size(), max_batch_);
+      batch.assign(pending_.begin(), pending_.begin() + n);
+      pending_.erase(pending_.begin(), pending_.begin() + n);
+      for (const WatchMatch& match : batch) {
+        seen_.erase(match.path + '\0' + std::to_string(match.id));
+      }
+      return true;
+    }
+    if (stop) {
+      return false;
+    }
+    struct pollfd p = {fd_, POLLIN, 0};
+    int ready = poll(&p, 1, pending_.empty() ? 100 : 20);
+    if (ready < 0 && errno != EINTR) {
+      return false;
+    }
+    if (ready > 0) {
+      size_t before = pending_.size();
+      if (!ReadEvents()) {
+        return false;
+      }
+      if (pending_.size() > before) {
+        last = Clock::now();
+        if (before == 0) {
+          first = last;
+        }
+      }
+    }
+  }
+#else
+  (void)stop;
+  return false;
+#endif
+}
+
+}  // namespace cae
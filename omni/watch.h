@@ -0,0 +1,90 @@
+///
+/// watch.h
+///
+/// Files as they land in watched directories. Each pattern's root and the
+/// directories below it that the pattern can reach are watched with
+/// inotify; directories created later are watched as they appear. A file
+/// is reported once it is closed after writing or moved in, and only if
+/// it matches a pattern. Events are handed out in batches: a batch closes
+/// once no event has come for kQuietMillis, kMaxDelayMillis after its
+/// first file, or at max_batch files, so a burst of drops becomes one
+/// batch without holding back a lone file.
+///
+#ifndef CAE_WATCH_H_
+#define CAE_WATCH_H_
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace cae {
+
+/**
+ * A file that matched a watched pattern
+ */
+struct WatchMatch {
+  std::string path;
+  size_t id;  // as given to Add()
+};
+
+/**
+ * inotify watches on the directories of file patterns (Linux only)
+ */
+class DirectoryWatcher {
+ public:
+  /** Quiet time that closes a batch */
+  static constexpr int kQuietMillis = 200;
+  /** Longest a file waits for its batch to close */
+  static constexpr int kMaxDelayMillis = 2000;
+  /** Default files per batch */
+  static constexpr size_t kMaxBatch = 1024;
+
+  explicit DirectoryWatcher(size_t max_batch = kMaxBatch);
+  ~DirectoryWatcher();
+
+  DirectoryWatcher(const DirectoryWatcher&) = delete;
+  DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+  /**
+   * Watch the directories a pattern (braces allowed) can match files in;
+   * its matches are reported with id
+   * @return 0 on success, 1 with error set if the root cannot be watched
+   */
+  int Add(const std::string& pattern, size_t id, std::string& error);
+
+  /**
+   * Wait for the next batch of matches
+   * @param stop Checked every 100 ms; once set, files already seen are
+   *             returned and then no more
+   * @return false when stopped with nothing left, or on a read error
+   */
+  bool Next(std::vector<WatchMatch>& batch, const std::atomic<bool>& stop);
+
+ private:
+  struct Pattern {
+    std::string glob;  // one alternative of the braces
+    size_t id;
+  };
+
+  // Watch dir and, depth levels down (-1: all), its subdirectories;
+  // files already in a new subdirectory are matched as if they landed
+  void WatchTree(const std::string& dir, int depth, bool scan);
+  void Match(const std::string& path);
+  // Read pending events; false on error
+  bool ReadEvents();
+
+  int fd_ = -1;
+  size_t max_batch_;
+  std::vector<Pattern> patterns_;
+  std::unordered_map<int, std::string> dirs_;   // by watch descriptor
+  std::unordered_map<std::string, int> depth_;  // levels still watched below
+  std::vector<WatchMatch> pending_;
+  std::unordered_set<std::string> seen_;  // paths in pending_
+};
+
+}  // namespace cae
+
+#endif  // CAE_WATCH_H_
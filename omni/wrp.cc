@@ -15,10 +15,11 @@
 #include "repo/filesystem_repo_omni.h"
 #include "repo/repo_factory.h"
 #include "format/dataset_config.h"
+#include "omni_processing.h"
+#include "job_plan.h"
 #ifdef  USE_HDF5
 #include "format/hdf5_dataset_client.h"
 #include <hdf5.h>
-#include "omni_processing.h"
 #endif
 #include <cstdlib>
 #include <iostream>
@@ -113,6 +114,8 @@ typedef SSIZE_T ssize_t;
 #endif
 
 #include "OMNI.h"
+#include "stats.h"
+#include "stream.h"
 
 using namespace cae;
 namespace fs = std::filesystem;
@@ -141,6 +144,29 @@ static void init_aws_sdk() {
 }
 #endif
 
+// True for "get <buffer> --data" without -o, or with "-o -": the buffer's
+// bytes are the command's stdout
+static bool DataToStdout(int argc, char *argv[], int cmd_idx)
+{
+  if (std::string(argv[cmd_idx]) != "get") {
+    return false;
+  }
+  bool data = false;
+  std::string out_path = "-";
+  for (int i = cmd_idx + 2; i < argc; ++i) {
+    std::string opt = argv[i];
+    if (opt == "--data") {
+      data = true;
+    } else if ((opt == "-o" || opt == "--range") && i + 1 < argc) {
+      if (opt == "-o") {
+        out_path = argv[i + 1];
+      }
+      ++i;
+    }
+  }
+  return data && out_path == "-";
+}
+
 int main(int argc, char *argv[])
 {
 #ifdef USE_MPI
@@ -151,11 +177,6 @@ int main(int argc, char *argv[])
   int rank, size;
   MPI_Comm_rank(MPI_COMM_WORLD, &rank);
   MPI_Comm_size(MPI_COMM_WORLD, &size);
-
-  if (rank == 0) {
-    std::cout << "MPI initialized with " << size << " processes" << std::endl;
-    std::cout << "Thread support level: " << mpi_provided << std::endl;
-  }
 #endif
 
 #ifdef USE_AWS
@@ -164,13 +185,21 @@ int main(int argc, char *argv[])
 #endif
 
   if (argc < 2) {
-    std::cerr << "Usage: " << argv[0] << " [-q] <command> [options]" << std::endl;
+    std::cerr << "Usage: " << argv[0] << " [-q] [--stats=<fmt>[:<file>]] <command> [options]" << std::endl;
     std::cerr << "Options:" << std::endl;
     std::cerr << "  -q                 - Quiet mode (suppress standard output)" << std::endl;
+    std::cerr << "  --stats=json|prom[:<file>]" << std::endl;
+    std::cerr << "                     - Write per-stage timings as JSON or Prometheus text" << std::endl;
     std::cerr << "Commands:" << std::endl;
-    std::cerr << "  put <omni.yaml>    - Put data into buffer from YAML config" << std::endl;
+    std::cerr << "  put <omni.yaml>... - Put data into buffer from YAML config(s)" << std::endl;
     std::cerr << "  get <buffer>       - Get data from buffer and create YAML config" << std::endl;
+    std::cerr << "      [--data [-o <file>|-] [--range <offset>:<length>]]" << std::endl;
+    std::cerr << "                     - Stream the buffer bytes instead (default: stdout)" << std::endl;
     std::cerr << "  ls                 - List all buffers" << std::endl;
+    std::cerr << "  job <job.yaml> [hostfile]" << std::endl;
+    std::cerr << "                     - Run every file of the job's data entries concurrently" << std::endl;
+    std::cerr << "  watch <job.yaml> [hostfile]" << std::endl;
+    std::cerr << "                     - Run the job, then each batch of files landing in its directories" << std::endl;
 #ifdef USE_MPI
     MPI_Finalize();
 #endif
@@ -179,19 +208,56 @@ int main(int argc, char *argv[])
 
   // Parse options
   bool quiet = false;
+  std::string stats_format;
+  std::string stats_path;
   int arg_idx = 1;
 
-  if (std::string(argv[1]) == "-q") {
-    quiet = true;
-    arg_idx = 2;
-    if (argc < 3) {
-      std::cerr << "Usage: " << argv[0] << " [-q] <command> [options]" << std::endl;
+  while (arg_idx < argc) {
+    std::string opt = argv[arg_idx];
+    if (opt == "-q") {
+      quiet = true;
+    } else if (opt.rfind("--stats=", 0) == 0) {
+      if (!ParseStatsSpec(opt.substr(8), stats_format, stats_path)) {
+        std::cerr << "Error: invalid stats option - " << opt << std::endl;
 #ifdef USE_MPI
-      MPI_Finalize();
+        MPI_Finalize();
 #endif
-      return 1;
+        return 1;
+      }
+    } else {
+      break;
     }
+    ++arg_idx;
+  }
+  if (arg_idx >= argc) {
+    std::cerr << "Usage: " << argv[0] << " [-q] [--stats=<fmt>[:<file>]] <command> [options]" << std::endl;
+#ifdef USE_MPI
+    MPI_Finalize();
+#endif
+    return 1;
+  }
+  if (!stats_format.empty()) {
+    StatsRegistry::Global().Enable();
+#ifdef USE_MPI
+    if (size > 1) {
+      // The ranks' files land side by side for one collector
+      char host[MPI_MAX_PROCESSOR_NAME];
+      int host_len = 0;
+      MPI_Get_processor_name(host, &host_len);
+      StatsRegistry::Global().SetRank(rank, std::string(host, host_len));
+    }
+#endif
+  }
+  // Streamed data owns stdout; every message goes to stderr instead
+  if (DataToStdout(argc, argv, arg_idx)) {
+    std::cout.rdbuf(std::cerr.rdbuf());
+  }
+#ifdef USE_MPI
+  if (rank == 0 && !quiet) {
+    std::cout << "MPI initialized with " << size << " processes" << std::endl;
+    std::cout << "Thread support level: " << mpi_provided << std::endl;
   }
+#endif
 
   std::string command = argv[arg_idx];
 
@@ -220,30 +286,66 @@ int main(int argc, char *argv[])
 
   cae::OMNI omni;
   omni.SetQuiet(quiet);
+#ifdef USE_MPI
+  // Under mpirun each rank puts its own slice of every descriptor
+  omni.SetPartition(rank, size);
+#endif
 
   // Check for put/get/ls commands
   int result = 0;
   if (command == "put") {
     if (argc < arg_idx + 2) {
-      std::cerr << "Usage: " << argv[0] << " [-q] put <omni.yaml>" << std::endl;
+      std::cerr << "Usage: " << argv[0] << " [-q] put <omni.yaml>..." << std::endl;
 #ifdef USE_MPI
       MPI_Finalize();
 #endif
       return 1;
     }
-    std::string name = argv[arg_idx + 1];
-    result = omni.Put(name);
+    // Several descriptors share one pipeline so their stages overlap.
+    std::vector<std::string> names(argv + arg_idx + 1, argv + argc);
+    result = omni.Put(names);
 
   } else if (command == "get") {
     if (argc < arg_idx + 2) {
-      std::cerr << "Usage: " << argv[0] << " [-q] get <buffer>" << std::endl;
+      std::cerr << "Usage: " << argv[0]
+                << " [-q] get <buffer> [--data [-o <file>|-] [--range <offset>:<length>]]"
+                << std::endl;
 #ifdef USE_MPI
       MPI_Finalize();
 #endif
       return 1;
     }
     std::string name = argv[arg_idx + 1];
-    result = omni.Get(name);
+    bool data = false;
+    std::string out_path = "-";
+    uint64_t offset = 0;
+    uint64_t nbyte = kToEnd;
+    for (int i = arg_idx + 2; i < argc; ++i) {
+      std::string opt = argv[i];
+      if (opt == "--data") {
+        data = true;
+      } else if (opt == "-o" && i + 1 < argc) {
+        out_path = argv[++i];
+      } else if (opt == "--range" && i + 1 < argc) {
+        if (!ParseRange(argv[++i], offset, nbyte)) {
+          std::cerr << "Error: invalid range '" << argv[i]
+                    << "' (expected <offset>:<length>)" << std::endl;
+          result = 1;
+        }
+      } else {
+        std::cerr << "Error: invalid get option - " << opt << std::endl;
+        result = 1;
+      }
+    }
+    if (result == 0 && !data && (out_path != "-" || offset != 0 ||
+                                 nbyte != kToEnd)) {
+      std::cerr << "Error: -o and --range require --data" << std::endl;
+      result = 1;
+    }
+    if (result == 0) {
+      result = data ? omni.StreamData(name, out_path, offset, nbyte)
+                    : omni.Get(name);
+    }
 
   } else if (command == "ls") {
     if (!quiet) {
@@ -251,6 +353,33 @@ int main(int argc, char *argv[])
     }
     result = omni.List();
 
+  } else if (command == "job" || command == "watch") {
+    if (argc < arg_idx + 2 || argc > arg_idx + 3) {
+      std::cerr << "Usage: " << argv[0] << " [-q] " << command
+                << " <job.yaml> [hostfile]" << std::endl;
+#ifdef USE_MPI
+      MPI_Finalize();
+#endif
+      return 1;
+    }
+    std::string hostfile = argc > arg_idx + 2 ? argv[arg_idx + 2] : "";
+#ifdef USE_MPI
+    // The job spawns its own worker ranks; one launcher is enough
+    if (rank == 0)
+#endif
+    {
+      try {
+        OmniJobConfig config = cae::LoadJob(argv[arg_idx + 1]);
+        int failed = command == "watch" ? WatchJob(config, hostfile)
+                                        : RunJob(config, hostfile);
+        result = failed == 0 ? 0 : 1;
+      } catch (const std::exception &e) {
+        std::cerr << "Error: job '" << argv[arg_idx + 1] << "' - " << e.what()
+                  << std::endl;
+        result = 1;
+      }
+    }
+
   } else {
     std::cerr << "Error: invalid command - " << command << std::endl;
 #ifdef USE_MPI
@@ -259,6 +388,23 @@ int main(int argc, char *argv[])
     return 1;
   }
 
+  if (!stats_format.empty()) {
+#ifdef USE_MPI
+    if (size > 1 && stats_path != "-") {
+      // One file per rank: wrp.prom -> wrp.<rank>.prom
+      fs::path p(stats_path);
+      stats_path = (p.parent_path() / (p.stem().string() + "." +
+                                       std::to_string(rank) +
+                                       p.extension().string()))
+                       .string();
+    }
+#endif
+    if (StatsRegistry::Global().Write(stats_format, stats_path) != 0 &&
+        result == 0) {
+      result = 1;
+    }
+  }
+
 #ifdef USE_MPI
   MPI_Finalize();
 #endif
@@ -0,0 +1,345 @@
+///
+/// wrp_bench.cc - Synthetic end-to-end throughput benchmark for OMNI
+///
+/// Generates synthetic sources, then drives OMNI::Put, Get, GetData and
+/// List through every compiled-in storage backend. Each (backend, size, op)
+/// result is printed as one JSON object per line with throughput, p50/p99
+/// latency and the peak RSS of the whole process so far.
+///
+/// Usage: wrp_bench [--sizes 4K,64K,1M] [--count N] [--format csv|bin]
+///                  [--backends all|b1,b2] [--ops put,get,data,ls]
+///                  [--dir scratch] [--out results.jsonl] [--keep]
+///
+#include "OMNI.h"
+#include "partition.h"
+#ifdef USE_SHM_ARENA
+#include "shm_arena.h"
+#endif
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct BenchConfig {
+  std::vector<size_t> sizes = {4096, 65536, 1 << 20};
+  size_t count = 100;
+  std::string format = "csv";
+  std::vector<std::string> backends;  // empty: all compiled in
+  std::vector<std::string> ops = {"put", "get", "data", "ls"};
+  std::string dir;
+  std::string out = "-";
+  bool keep = false;
+};
+
+std::vector<std::string> Split(const std::string& s) {
+  std::vector<std::string> parts;
+  std::stringstream ss(s);
+  std::string part;
+  while (std::getline(ss, part, ',')) {
+    if (!part.empty()) {
+      parts.push_back(part);
+    }
+  }
+  return parts;
+}
+
+int Usage(const char* prog) {
+  std::cerr << "Usage: " << prog
+            << " [--sizes 4K,64K,1M] [--count N] [--format csv|bin]"
+            << std::endl
+            << "       [--backends all|b1,b2] [--ops put,get,data,ls]"
+            << " [--dir scratch] [--out file|-] [--keep]" << std::endl;
+  return 1;
+}
+
+// Synthetic source of exactly nbyte bytes
+int WriteSource(const std::string& path, const std::string& format,
+                size_t nbyte) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (format == "csv") {
+    // Rows shaped like the sample strain data
+    std::string text;
+    text.reserve(nbyte + 64);
+    for (size_t i = 0; text.size() < nbyte; ++i) {
+      text += std::to_string(i) + ", " + std::to_string((i * 7919) % 1000) +
+              ".500000, -" + std::to_string((i * 104729) % 100) + ".125000\n";
+    }
+    out.write(text.data(), static_cast<std::streamsize>(nbyte));
+  } else if (format == "bin") {
+    // xorshift64: incompressible bytes
+    uint64_t x = 0x9e3779b97f4a7c15ULL;
+    std::vector<char> block(nbyte);
+    for (size_t i = 0; i < nbyte; ++i) {
+      x ^= x << 13;
+      x ^= x >> 7;
+      x ^= x << 17;
+      block[i] = static_cast<char>(x);
+    }
+    out.write(block.data(), static_cast<std::streamsize>(nbyte));
+  } else {
+    std::cerr << "Error: invalid format - " << format << std::endl;
+    return 1;
+  }
+  return out ? 0 : 1;
+}
+
+int WriteDescriptor(const std::string& path, const std::string& name,
+                    const std::string& src, size_t nbyte) {
+  std::ofstream out(path, std::ios::trunc);
+  out << "name: " << name << "\n"
+      << "tags:\n  - bench\n"
+      << "src: \"" << src << "\"\n"
+      << "offset: 0\n"
+      << "nbyte: " << nbyte << "\n";
+  return out ? 0 : 1;
+}
+
+// High-water mark of the whole run so far, not of one (backend, size, op):
+// it only grows, so a line reflects every backend measured before it
+long ProcessPeakRssKb() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;  // KiB on Linux
+}
+
+double Percentile(std::vector<double> sorted, double p) {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+  std::sort(sorted.begin(), sorted.end());
+  // Nearest-rank
+  size_t rank = static_cast<size_t>(p * sorted.size() + 0.999999);
+  return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+struct Result {
+  std::string backend;
+  std::string op;
+  size_t size = 0;
+  size_t ops = 0;
+  size_t failed = 0;
+  uint64_t bytes = 0;
+  std::vector<double> latencies;  // seconds
+  double seconds = 0.0;
+};
+
+void Report(std::ostream& out, const Result& r, const std::string& format) {
+  double p50 = Percentile(r.latencies, 0.50);
+  double p99 = Percentile(r.latencies, 0.99);
+  double mbps = r.seconds > 0 ? r.bytes / r.seconds / 1e6 : 0.0;
+  double ops_per_sec = r.seconds > 0 ? r.ops / r.seconds : 0.0;
+  std::ostringstream line;
+  line.precision(6);
+  line << std::fixed << "{\"backend\": \"" << r.backend << "\", \"op\": \""
+       << r.op << "\", \"format\": \"" << format << "\", \"size\": " << r.size
+       << ", \"ops\": " << r.ops << ", \"failed\": " << r.failed
+       << ", \"bytes\": " << r.bytes << ", \"seconds\": " << r.seconds
+       << ", \"ops_per_sec\": " << ops_per_sec << ", \"mb_per_sec\": " << mbps
+       << ", \"p50_us\": " << p50 * 1e6 << ", \"p99_us\": " << p99 * 1e6
+       << ", \"process_peak_rss_kb\": " << ProcessPeakRssKb() << "}";
+  out << line.str() << std::endl;
+}
+
+// Time fn once per item; fn returns the bytes it moved, or -1 on failure.
+// check, if given, confirms an item's effect outside the timed region.
+Result Measure(const std::string& backend, const std::string& op, size_t size,
+               size_t count, const std::function<long long(size_t)>& fn,
+               const std::function<bool(size_t)>& check = nullptr) {
+  using Clock = std::chrono::steady_clock;
+  Result r;
+  r.backend = backend;
+  r.op = op;
+  r.size = size;
+  r.latencies.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    auto start = Clock::now();
+    long long moved = fn(i);
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    if (moved < 0 || (check && !check(i))) {
+      ++r.failed;
+      continue;
+    }
+    ++r.ops;
+    r.bytes += static_cast<uint64_t>(moved);
+    r.seconds += elapsed;
+    r.latencies.push_back(elapsed);
+  }
+  return r;
+}
+
+bool Wants(const BenchConfig& config, const std::string& op) {
+  return std::find(config.ops.begin(), config.ops.end(), op) !=
+         config.ops.end();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  BenchConfig config;
+  for (int i = 1; i < argc; ++i) {
+    std::string opt = argv[i];
+    bool has_value = i + 1 < argc;
+    if (opt == "--sizes" && has_value) {
+      config.sizes.clear();
+      for (const std::string& text : Split(argv[++i])) {
+        uint64_t size = 0;
+        if (!cae::ParseByteSize(text, size) || size == 0) {
+          std::cerr << "Error: invalid size - " << text << std::endl;
+          return 1;
+        }
+        config.sizes.push_back(size);
+      }
+    } else if (opt == "--count" && has_value) {
+      config.count = std::strtoull(argv[++i], nullptr, 10);
+    } else if (opt == "--format" && has_value) {
+      config.format = argv[++i];
+    } else if (opt == "--backends" && has_value) {
+      std::string list = argv[++i];
+      config.backends = list == "all" ? std::vector<std::string>()
+                                      : Split(list);
+    } else if (opt == "--ops" && has_value) {
+      config.ops = Split(argv[++i]);
+    } else if (opt == "--dir" && has_value) {
+      config.dir = argv[++i];
+    } else if (opt == "--out" && has_value) {
+      config.out = argv[++i];
+    } else if (opt == "--keep") {
+      config.keep = true;
+    } else {
+      return Usage(argv[0]);
+    }
+  }
+  if (config.count == 0 || config.sizes.empty()) {
+    return Usage(argv[0]);
+  }
+  if (config.backends.empty()) {
+    config.backends = cae::OMNI::Backends();
+  }
+
+  // Results are written relative to the caller's directory
+  std::ofstream out_file;
+  if (config.out != "-") {
+    out_file.open(config.out, std::ios::trunc);
+    if (!out_file) {
+      std::cerr << "Error: cannot open '" << config.out << "'" << std::endl;
+      return 1;
+    }
+  }
+  std::ostream& out = config.out == "-" ? std::cout : out_file;
+
+  // OMNI keeps buffers and its catalog in the working directory
+  fs::path scratch = config.dir.empty()
+                         ? fs::temp_directory_path() /
+                               ("wrp_bench_" + std::to_string(getpid()))
+                         : fs::path(config.dir);
+  fs::path cwd = fs::current_path();
+  bool own_scratch = !fs::exists(scratch);  // never delete a caller's dir
+  fs::create_directories(scratch);
+  scratch = fs::absolute(scratch);
+  fs::current_path(scratch);
+#ifdef USE_SHM_ARENA
+  // A private arena unless the caller picked one
+  std::string arena_name = "/wrp_bench_" + std::to_string(getpid());
+  bool own_arena = std::getenv("OMNI_ARENA") == nullptr;
+  if (own_arena) {
+    setenv("OMNI_ARENA", arena_name.c_str(), 1);
+  }
+#endif
+
+  int rc = 0;
+  for (size_t size : config.sizes) {
+    std::string src = (scratch / ("src_" + std::to_string(size) + "." +
+                                  config.format))
+                          .string();
+    if (WriteSource(src, config.format, size) != 0) {
+      rc = 1;
+      break;
+    }
+
+    for (const std::string& backend : config.backends) {
+      cae::OMNI omni;
+      omni.SetQuiet(true);
+      if (omni.SetBackend(backend) != 0) {
+        rc = 1;
+        continue;
+      }
+
+      // Descriptors are written before timing starts
+      std::vector<std::string> names(config.count);
+      std::vector<std::string> yamls(config.count);
+      for (size_t i = 0; i < config.count; ++i) {
+        names[i] = "b_" + backend + "_" + std::to_string(size) + "_" +
+                   std::to_string(i);
+        yamls[i] = names[i] + ".yml";
+        WriteDescriptor(yamls[i], names[i], src, size);
+      }
+
+      if (Wants(config, "put")) {
+        // A put counts only if the whole buffer can be read back
+        std::vector<unsigned char> stored;
+        Report(out, Measure(backend, "put", size, config.count,
+                            [&](size_t i) -> long long {
+                              return omni.Put(yamls[i]) == 0 ? size : -1;
+                            },
+                            [&](size_t i) {
+                              return omni.GetData(names[i], stored) == 0 &&
+                                     stored.size() == size;
+                            }),
+               config.format);
+      }
+      if (Wants(config, "get")) {
+        Report(out, Measure(backend, "get", size, config.count,
+                            [&](size_t i) -> long long {
+                              return omni.Get(names[i]) == 0 ? 0 : -1;
+                            }),
+               config.format);
+      }
+      if (Wants(config, "data")) {
+        std::vector<unsigned char> data;
+        Report(out, Measure(backend, "data", size, config.count,
+                            [&](size_t i) -> long long {
+                              if (omni.GetData(names[i], data) != 0 ||
+                                  data.size() != size) {
+                                return -1;
+                              }
+                              return static_cast<long long>(data.size());
+                            }),
+               config.format);
+      }
+      if (Wants(config, "ls")) {
+        Report(out, Measure(backend, "ls", size, config.count,
+                            [&](size_t) -> long long {
+                              return omni.List() == 0 ? 0 : -1;
+                            }),
+               config.format);
+      }
+    }
+  }
+
+  fs::current_path(cwd);
+#ifdef USE_SHM_ARENA
+  if (own_arena && !config.keep) {
+    cae::ShmArena::Destroy(arena_name);
+  }
+#endif
+  if (own_scratch && !config.keep) {
+    std::error_code ec;
+    fs::remove_all(scratch, ec);
+  }
+  return rc;
+}
@@ -1,51 +1,82 @@
 #include "format/binary_file_omni.h"
-#include "format/progress_bar.h"
+#include "format/format_factory.h"
+#include "format/lines_file_omni.h"
+#include "format/mpi_progress.h"
+#include "format/mpi_worker_pool.h"
+#include "format/mpiio_file_omni.h"
+#include "merkle.h"
+#include "partition.h"
+#include "scale_model.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <memory>
 #include <mpi.h>
+#include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace cae {
 
 void PrintUsage(const char *program_name) {
   std::cerr << "Usage: " << program_name
-            << " <filename> <offset> <size> [description] [hash]" << std::endl;
+            << " <filename> [offset] [size] [description] [hash]" << std::endl;
   std::cerr << "Parameters:" << std::endl;
   std::cerr << "  filename    - Path to the file to process (required)"
             << std::endl;
-  std::cerr << "  offset      - Starting offset in bytes (required)"
+  std::cerr << "  offset      - Starting offset in bytes (default 0)"
             << std::endl;
-  std::cerr << "  size        - Number of bytes to process (required)"
+  std::cerr << "  size        - Number of bytes to process (0: to end of file)"
             << std::endl;
   std::cerr << "  description - Optional description string" << std::endl;
   std::cerr << "  hash        - Optional hash value for verification"
             << std::endl;
+  std::cerr << "Options:" << std::endl;
+  std::cerr << "  --block <bytes|auto>  Align rank boundaries to this block"
+            << " size (default auto:" << std::endl;
+  std::cerr << "                        Lustre stripe size or st_blksize; 0"
+            << " splits bytes)" << std::endl;
+  std::cerr << "  --hash [merkle:<hex>] Merkle root of the range, checked if"
+            << " given" << std::endl;
+  std::cerr << "  --mpiio [--cb-nodes <n>] [--cb-buffer-size <bytes>]"
+            << " [--striping-unit <bytes>] [--chunk <bytes>]" << std::endl;
+  std::cerr << "                        Collective MPI-IO reads with ROMIO"
+            << " hints" << std::endl;
+  std::cerr << "  --records [--header] [--quote]" << std::endl;
+  std::cerr << "                        Move each rank's range to whole"
+            << " CSV/line records" << std::endl;
+  std::cerr << "                        and count them; --header skips the"
+            << " first line," << std::endl;
+  std::cerr << "                        --quote keeps newlines in \"quoted\""
+            << " fields" << std::endl;
+  std::cerr << "  --detect              Pick the reader from the file's magic"
+            << " bytes: CSV and" << std::endl;
+  std::cerr << "                        line files are read as --records"
+            << " (CSV with --header --quote)" << std::endl;
+  std::cerr << "Started by MPI_Comm_spawn (wrp job), it reads the work items"
+            << " the job sends instead." << std::endl;
 }
 
-class BinaryFileOmniWithProgress : public BinaryFileOmni {
+// Reports a format client's chunks to the aggregate progress of all ranks
+template <typename Base> class WithProgress : public Base {
 public:
-  BinaryFileOmniWithProgress(const std::string &filename, size_t total_size,
-                             int rank)
-      : progress_(std::make_unique<ProgressBar>(
-            std::filesystem::path(filename).filename().string(), total_size,
-            rank)),
-        total_size_(total_size) {}
+  template <typename... Args>
+  WithProgress(MpiProgress &progress, Args &&...args)
+      : Base(std::forward<Args>(args)...), progress_(progress) {}
 
 protected:
   virtual void OnChunkProcessed(size_t bytes_processed) override {
-    progress_->Update(bytes_processed);
-    if (bytes_processed == total_size_) {
-      progress_->Finish();
-      std::cout << std::endl; // Move to next line after completion
-    }
+    progress_.Update(bytes_processed);
   }
 
 private:
-  std::unique_ptr<ProgressBar> progress_;
-  size_t total_size_;
+  MpiProgress &progress_;
 };
 
 } // namespace cae
@@ -58,61 +89,248 @@ int main(int argc, char *argv[]) {
   MPI_Comm_rank(MPI_COMM_WORLD, &rank);
   MPI_Comm_size(MPI_COMM_WORLD, &size);
 
+  // Spawned by a job's worker pool: serve its work items until told to stop
+  MPI_Comm parent;
+  MPI_Comm_get_parent(&parent);
+  if (parent != MPI_COMM_NULL) {
+    int served = cae::ServeWorkItems(parent);
+    MPI_Comm_disconnect(&parent);
+    MPI_Finalize();
+    return served;
+  }
+
   // Check command line arguments
-  if (argc < 2) {
+  std::vector<std::string> positional;  // filename offset size desc hash
+  std::string block_text = "auto";
+  bool hash = false;
+  std::string expected;  // "merkle:<hex>" to verify against
+  bool mpiio = false;
+  bool records = false;
+  bool detect = false;
+  cae::RecordOptions record_options;
+  bool hinted = false;
+  cae::MpiioHints hints;
+  size_t chunk_size = cae::MpiioFileOmni::kDefaultChunkSize;
+  bool usage = false;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--hash") {
+      hash = true;
+      if (has_value && cae::IsMerkleHash(argv[i + 1])) {
+        expected = argv[++i];
+      }
+    } else if (arg == "--mpiio") {
+      mpiio = true;
+    } else if (arg == "--records") {
+      records = true;
+    } else if (arg == "--header") {
+      record_options.header = true;
+    } else if (arg == "--quote") {
+      record_options.quote = '"';
+    } else if (arg == "--detect") {
+      detect = true;
+    } else if (arg == "--cb-nodes" && has_value) {
+      hints.cb_nodes = argv[++i];
+      hinted = true;
+    } else if (arg == "--cb-buffer-size" && has_value) {
+      hints.cb_buffer_size = argv[++i];
+      hinted = true;
+    } else if (arg == "--striping-unit" && has_value) {
+      hints.striping_unit = argv[++i];
+      hinted = true;
+    } else if (arg == "--chunk" && has_value) {
+      chunk_size = std::strtoull(argv[++i], nullptr, 10);
+      hinted = true;
+    } else if (arg == "--block" && has_value) {
+      block_text = argv[++i];
+    } else if (positional.size() < 5 && !arg.empty() && arg[0] != '-') {
+      positional.push_back(arg);
+    } else {
+      usage = true;
+    }
+  }
+  uint64_t range_offset = 0;
+  uint64_t range_size = 0;
+  uint64_t block = 0;
+  if (positional.size() > 1 && !cae::ParseByteSize(positional[1], range_offset)) {
+    usage = true;
+  }
+  if (positional.size() > 2 && !cae::ParseByteSize(positional[2], range_size)) {
+    usage = true;
+  }
+  if (block_text != "auto" && !cae::ParseByteSize(block_text, block)) {
+    usage = true;
+  }
+  if (positional.empty() || usage || (hinted && !mpiio) ||
+      (mpiio && (records || detect)) || (records && detect) ||
+      ((record_options.header || record_options.quote) && !records) ||
+      chunk_size == 0 ||
+      chunk_size > INT_MAX) {
     if (rank == 0) {
-      std::cerr << "Usage: " << argv[0] << " <binary_file>" << std::endl;
+      cae::PrintUsage(argv[0]);
     }
     MPI_Finalize();
     return 1;
   }
+  std::string filename = positional[0];
+  std::string description = positional.size() > 3 ? positional[3] : "";
+  std::string given_hash = positional.size() > 4 ? positional[4] : "";
+  if (cae::IsMerkleHash(given_hash)) {
+    hash = true;
+    if (expected.empty()) {
+      expected = given_hash;
+    }
+  }
 
-  try {
-    std::string filename = argv[1];
-    size_t file_size = 0;
+  int result = 0;
 
-    // Get file size (only rank 0 needs to do this)
+  try {
+    // Rank 0 clips the range to the file, picks the block size and, with
+    // --detect, the reader
+    uint64_t layout[4] = {0, 0, block, 0};  // offset, size, block, format
     if (rank == 0) {
       std::ifstream file(filename, std::ios::binary | std::ios::ate);
       if (!file) {
         throw std::runtime_error("Could not open file: " + filename);
       }
-      file_size = file.tellg();
+      uint64_t file_size = static_cast<uint64_t>(file.tellg());
+      layout[0] = std::min(range_offset, file_size);
+      layout[1] = file_size - layout[0];
+      if (range_size != 0 && range_size < layout[1]) {
+        layout[1] = range_size;
+      }
+      if (block_text == "auto") {
+        layout[2] = cae::DetectBlockSize(filename);
+      }
+      cae::Format format = cae::Format::kBinary;
+      if (detect && !cae::FormatFactory::DetectFormat(filename, format)) {
+        throw std::runtime_error("Could not read file: " + filename);
+      }
+      layout[3] = static_cast<uint64_t>(format);
     }
-
-    // Broadcast file size to all ranks
-    MPI_Bcast(&file_size, 1, MPI_UNSIGNED_LONG_LONG, 0, MPI_COMM_WORLD);
-
-    // Calculate per-process work distribution
-    size_t bytes_per_process = file_size / size;
-    size_t remaining_bytes = file_size % size;
-
-    // Calculate this process's portion
-    size_t process_offset = rank * bytes_per_process;
-    size_t process_size = bytes_per_process;
-
-    // Distribute remaining bytes to the first few processes
-    if (rank < remaining_bytes) {
-      process_offset += rank;
-      process_size += 1;
-    } else {
-      process_offset += remaining_bytes;
+    MPI_Bcast(layout, 4, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+    range_offset = layout[0];
+    range_size = layout[1];
+    block = layout[2];
+    cae::Format format = static_cast<cae::Format>(layout[3]);
+    if (detect) {
+      records = format == cae::Format::kCsv || format == cae::Format::kLines;
+      record_options.header = format == cae::Format::kCsv;
+      record_options.quote = format == cae::Format::kCsv ? '"' : '\0';
+      if (rank == 0) {
+        std::cout << "format: " << cae::FormatFactory::Name(format)
+                  << (records ? " (records)" : " (bytes)") << std::endl;
+      }
     }
 
-    // Create format client with progress bar
-    cae::BinaryFileOmniWithProgress format(filename, process_size, rank);
+    // Whole blocks per rank, so no two ranks read the same stripe or page
+    cae::Slice slice =
+        cae::PartitionAligned(range_offset, range_size, block, rank, size);
+    size_t process_size = slice.nbyte;
+    if (rank == 0) {
+      std::cout << "partition: " << range_size << " bytes at " << range_offset
+                << " in " << (block > 1 ? block : 1) << "-byte blocks over "
+                << size << " ranks" << std::endl;
+    }
 
     // Create context for this process's portion
     cae::FormatContext ctx;
     ctx.filename_ = filename;
-    ctx.offset_ = process_offset;
+    ctx.offset_ = slice.offset;
     ctx.size_ = process_size;
+    ctx.description_ = description;
+    ctx.hash_ = given_hash;
 
-    // Process the data
-    format.Import(ctx);
-
-    // Wait for all ranks to complete
+    // Process the data with stdio or collective MPI-IO reads; the slowest
+    // rank sets the aggregate bandwidth
     MPI_Barrier(MPI_COMM_WORLD);
+    double start = MPI_Wtime();
+    size_t record_count = 0;
+    bool complete = true;
+    cae::MpiProgress progress(
+        std::filesystem::path(filename).filename().string(), range_size,
+        MPI_COMM_WORLD);
+    if (records) {
+      // Each rank extends its range to the next record start on its own;
+      // neighbours agree on the shared edge, so no communication is needed
+      cae::RecordRange whole;
+      if (cae::AlignToRecords(filename, slice.offset, slice.nbyte,
+                              record_options, whole) != 0) {
+        throw std::runtime_error("Could not split records of " + filename);
+      }
+      ctx.offset_ = whole.offset;
+      ctx.size_ = whole.nbyte;
+      cae::WithProgress<cae::LinesFileOmni> format(progress, record_options,
+                                                   true);
+      format.Import(ctx);
+      record_count = format.Records();
+    } else if (mpiio) {
+      cae::WithProgress<cae::MpiioFileOmni> format(progress, MPI_COMM_WORLD,
+                                                   hints, chunk_size);
+      format.Import(ctx);
+      complete = format.BytesRead() == ctx.size_;
+    } else {
+      cae::WithProgress<cae::BinaryFileOmni> format(progress);
+      format.Import(ctx);
+    }
+    progress.Finish();
+
+    // Wait for all ranks to complete; a rank that could not read its whole
+    // range fails the run on every rank
+    int local_complete = complete ? 1 : 0;
+    int all_complete = 0;
+    MPI_Allreduce(&local_complete, &all_complete, 1, MPI_INT, MPI_MIN,
+                  MPI_COMM_WORLD);
+    double seconds = MPI_Wtime() - start;
+    if (!all_complete) {
+      if (rank == 0) {
+        std::cerr << "Error: not every rank read its range of " << filename
+                  << std::endl;
+      }
+      result = 1;
+    }
+    if (records) {
+      unsigned long long local = record_count;
+      unsigned long long total = 0;
+      MPI_Reduce(&local, &total, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0,
+                 MPI_COMM_WORLD);
+      if (rank == 0) {
+        std::cout << "records: " << total << " on " << size << " ranks"
+                  << std::endl;
+      }
+    }
+    if (rank == 0) {
+      std::ostringstream line;
+      line << std::fixed << std::setprecision(3) << (mpiio ? "mpiio" : "stdio")
+           << ": read " << range_size << " bytes on " << size << " ranks in "
+           << seconds << " s ("
+           << (seconds > 0 ? range_size / seconds / 1e6 : 0.0) << " MB/s)";
+      std::cout << line.str() << std::endl;
+      // Past reads teach wrp job how far files like this one scale
+      cae::ScaleModel::Record(filename, range_size, size, 1, seconds);
+    }
+
+    if (hash) {
+      // Every rank hashes its share of 1 MiB leaves; rank 0 builds the root
+      std::string root = cae::MerkleRootMpi(filename, range_offset,
+                                            range_size, MPI_COMM_WORLD);
+      if (root.empty()) {
+        if (rank == 0) {
+          std::cerr << "Error: hashing '" << filename << "' failed"
+                    << std::endl;
+        }
+        result = 1;
+      } else if (!expected.empty() && root != expected) {
+        if (rank == 0) {
+          std::cerr << "Error: hash '" << expected
+                    << "' is not same as actual '" << root << "'" << std::endl;
+        }
+        result = 1;
+      } else if (rank == 0) {
+        std::cout << "merkle root: " << root << std::endl;
+      }
+    }
 
   } catch (const std::exception &e) {
     std::cerr << "Rank " << rank << " error: " << e.what() << std::endl;
@@ -120,5 +338,5 @@ int main(int argc, char *argv[]) {
   }
 
   MPI_Finalize();
-  return 0;
+  return result;
 }
\ No newline at end of file